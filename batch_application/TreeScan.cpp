@@ -12,6 +12,7 @@
 #include "ParametersValidate.h"
 #include "ParameterProgramOptions.h"
 #include "ParametersPrint.h"
+#include "SimulationDataFile.h"
 
 #include <boost/program_options.hpp>
 namespace po = boost::program_options;
@@ -71,6 +72,8 @@ int main(int argc, char* argv[]) {
             ("verify-parameters,c", po::bool_switch(&verifyParameters), "verify parameters only")
             ("print-parameters,p", po::bool_switch(&printParameters), "print parameters only")
             ("write-parameters,w", po::value<std::string>(), "write parameters to file")
+            ("convert-simulation-data", po::value<std::vector<std::string> >()->multitoken(),
+             "convert text simulation data file to binary: <text file> <binary file> <nodes> <values per node> [integer|real]")
             ("help,h", "Help");
 
         // try to determine if user has specified parameter options version
@@ -127,6 +130,17 @@ int main(int argc, char* argv[]) {
         if (vm.count("help")) {usage_message(argv[0], application, parameterOptions, opt_descriptions, false, console); return 0;}
         if (vm.count("version")) {console.Printf("TreeScan %s.%s.%s %s.\n", BasePrint::P_STDOUT, VERSION_MAJOR, VERSION_MINOR, VERSION_RELEASE, VERSION_PHASE); return 0;}
         if (vm.count("display-parameters")) {usage_message(argv[0], application, parameterOptions, opt_descriptions, true, console); return 0;}
+        if (vm.count("convert-simulation-data")) {
+            // values per node are 1 for tree-only scans, the days of the data time range for tree-time scans and the sample sites (real) for signed rank scans
+            const std::vector<std::string>& args = vm["convert-simulation-data"].as<std::vector<std::string> >();
+            unsigned int nodes, values;
+            if (args.size() < 4 || args.size() > 5 || sscanf(args[2].c_str(), "%u", &nodes) != 1 || sscanf(args[3].c_str(), "%u", &values) != 1 ||
+                (args.size() == 5 && args[4] != "integer" && args[4] != "real"))
+                throw resolvable_error("Invalid 'convert-simulation-data' arguments, expecting <text file> <binary file> <nodes> <values per node> [integer|real].");
+            size_t simulations = SimulationDataFile::convert(args[0], args[1], nodes, values, args.size() == 5 && args[4] == "real" ? SimulationDataFile::REAL : SimulationDataFile::INTEGER);
+            console.Printf("Converted %u simulations to binary simulation data file '%s'.\n", BasePrint::P_STDOUT, simulations, args[1].c_str());
+            return 0;
+        }
         // read parameter file
         if (vm.count("parameter-file")) {
             if (!ParameterAccessCoordinator(parameters).read(vm["parameter-file"].as<std::string>().c_str(), console))
@@ -466,6 +466,8 @@ void IniParameterFileAccess::WriteAdvancedAnalysisInferenceSettings(IniFile& Wri
         WriteIniParameter(WriteFile, Parameters::MINIMUM_CASES_NODE, GetParameterString(Parameters::MINIMUM_CASES_NODE, s).c_str(), GetParameterComment(Parameters::MINIMUM_CASES_NODE));
         WriteIniParameter(WriteFile, Parameters::PVALUE_REPORT_TYPE, GetParameterString(Parameters::PVALUE_REPORT_TYPE, s).c_str(), GetParameterComment(Parameters::PVALUE_REPORT_TYPE));
         WriteIniParameter(WriteFile, Parameters::EARLY_TERM_THRESHOLD, GetParameterString(Parameters::EARLY_TERM_THRESHOLD, s).c_str(), GetParameterComment(Parameters::EARLY_TERM_THRESHOLD));
+        WriteIniParameter(WriteFile, Parameters::RANDOM_NUMBER_GENERATOR, GetParameterString(Parameters::RANDOM_NUMBER_GENERATOR, s).c_str(), GetParameterComment(Parameters::RANDOM_NUMBER_GENERATOR));
+        WriteIniParameter(WriteFile, Parameters::SAMPLER_TYPE, GetParameterString(Parameters::SAMPLER_TYPE, s).c_str(), GetParameterComment(Parameters::SAMPLER_TYPE));
     } catch (prg_exception& x) {
         x.addTrace("WriteAdvancedAnalysisInferenceSettings()","IniParameterFileAccess");
         throw;
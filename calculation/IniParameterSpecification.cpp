@@ -296,8 +296,10 @@ void IniParameterSpecification::Build_2_4_x_ParameterList() {
     _parameter_info[Parameters::OUTPUT_CLUSTERWINDOW_GRAPH] = ParamInfo(Parameters::OUTPUT_CLUSTERWINDOW_GRAPH, "output-clusterwindow-graph-html", 5, _temporal_output_section);
     _parameter_info[Parameters::RPT_DATA_AS_PERCENTAGE] = ParamInfo(Parameters::RPT_DATA_AS_PERCENTAGE, "trend-data-as-percentage", 5, _additional_output_section);
     _parameter_info[Parameters::RESULTS_TITLE] = ParamInfo(Parameters::RESULTS_TITLE, "report-title", 6, _additional_output_section);
+    _parameter_info[Parameters::RANDOM_NUMBER_GENERATOR] = ParamInfo(Parameters::RANDOM_NUMBER_GENERATOR, "random-number-generator", 11, _inference_section);
+    _parameter_info[Parameters::SAMPLER_TYPE] = ParamInfo(Parameters::SAMPLER_TYPE, "sampler-type", 12, _inference_section);
 
-    assert(_parameter_info.size() == 87);
+    assert(_parameter_info.size() == 89);
 }
 
 
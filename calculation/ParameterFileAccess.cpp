@@ -105,6 +105,8 @@ const char * AbtractParameterFileAccess::GetParameterComment(Parameters::Paramet
             case Parameters::MINIMUM_CASES_NODE      : return "minimum number of cases in a node (integer)";
             case Parameters::PVALUE_REPORT_TYPE      : return "p-value reporting type (STANDARD_PVALUE=0, TERMINATION_PVALUE)";
             case Parameters::EARLY_TERM_THRESHOLD    : return "early termination threshold (> 0)";
+            case Parameters::RANDOM_NUMBER_GENERATOR : return "random number generator (LEHMER_RNG=0, PHILOX_RNG=1)";
+            case Parameters::SAMPLER_TYPE            : return "Poisson, binomial and temporal case placement sampler (LEGACY_SAMPLER=0, REJECTION_SAMPLER=1)";
                 /* Output */
             case Parameters::RESULTS_FILE            : return "results filename";
             case Parameters::RESULTS_HTML            : return "create HTML results (y/n)";
@@ -218,6 +220,8 @@ std::string & AbtractParameterFileAccess::GetParameterString(Parameters::Paramet
             case Parameters::MINIMUM_CASES_NODE       : return AsString(s, _parameters.getMinimumHighRateNodeCases());
             case Parameters::PVALUE_REPORT_TYPE       : return AsString(s, _parameters.getPValueReportingType());
             case Parameters::EARLY_TERM_THRESHOLD     : return AsString(s, _parameters.getEarlyTermThreshold());
+            case Parameters::RANDOM_NUMBER_GENERATOR  : return AsString(s, _parameters.getRandomNumberGeneratorType());
+            case Parameters::SAMPLER_TYPE             : return AsString(s, _parameters.getSamplerType());
             /* Output */
             case Parameters::RESULTS_FILE             : s = _parameters.getOutputFileName(); return s;
             case Parameters::RESULTS_HTML             : return AsString(s, _parameters.isGeneratingHtmlResults());
@@ -449,6 +453,10 @@ void AbtractParameterFileAccess::SetParameter(Parameters::ParameterType e, const
             case Parameters::PVALUE_REPORT_TYPE       : iValue = ReadEnumeration(ReadInt(value, e), e, Parameters::STANDARD_PVALUE, Parameters::TERMINATION_PVALUE);
                                                         _parameters.setPValueReportingType((Parameters::PValueReportingType)iValue); break;
             case Parameters::EARLY_TERM_THRESHOLD     : _parameters.setEarlyTermThreshold(ReadUnsignedInt(value, e)); break;
+            case Parameters::RANDOM_NUMBER_GENERATOR  : iValue = ReadEnumeration(ReadInt(value, e), e, Parameters::LEHMER_RNG, Parameters::PHILOX_RNG);
+                                                        _parameters.setRandomNumberGeneratorType((Parameters::RandomNumberGeneratorType)iValue); break;
+            case Parameters::SAMPLER_TYPE             : iValue = ReadEnumeration(ReadInt(value, e), e, Parameters::LEGACY_SAMPLER, Parameters::REJECTION_SAMPLER);
+                                                        _parameters.setSamplerType((Parameters::SamplerType)iValue); break;
             /* Output */
             case Parameters::RESULTS_FILE             : _parameters.setOutputFileName(value.c_str(), true); break;
             case Parameters::RESULTS_HTML             : _parameters.setGeneratingHtmlResults(ReadBoolean(value, e)); break;
@@ -10,7 +10,7 @@
 #include <boost/property_tree/ini_parser.hpp>
 #include <boost/property_tree/json_parser.hpp>
 
-const int Parameters::giNumParameters = 87;
+const int Parameters::giNumParameters = 89;
 
 Parameters::cut_maps_t Parameters::getCutTypeMap() {
    cut_map_t cut_type_map_abbr = {{"S", Parameters::SIMPLE}, {"P", Parameters::PAIRS}, {"T", Parameters::TRIPLETS}, {"O", Parameters::ORDINAL}};
@@ -132,6 +132,8 @@ bool  Parameters::operator==(const Parameters& rhs) const {
   if (_include_identical_parent_cuts != rhs._include_identical_parent_cuts) return false;
   if (_pvalue_reporting_type != rhs._pvalue_reporting_type) return false;
   if (_early_term_threshold != rhs._early_term_threshold) return false;
+  if (_random_number_generator_type != rhs._random_number_generator_type) return false;
+  if (_sampler_type != rhs._sampler_type) return false;
   if (_report_data_as_percentage != rhs._report_data_as_percentage) return false;
   if (_results_title != rhs._results_title) return false;
 
@@ -287,6 +289,8 @@ void Parameters::copy(const Parameters &rhs) {
     _include_identical_parent_cuts = rhs._include_identical_parent_cuts;
     _pvalue_reporting_type = rhs._pvalue_reporting_type;
     _early_term_threshold = rhs._early_term_threshold;
+    _random_number_generator_type = rhs._random_number_generator_type;
+    _sampler_type = rhs._sampler_type;
     _report_data_as_percentage = rhs._report_data_as_percentage;
     _results_title = rhs._results_title;
 }
@@ -550,6 +554,8 @@ void Parameters::setAsDefaulted() {
 
     _pvalue_reporting_type = STANDARD_PVALUE;
     _early_term_threshold = 50;
+    _random_number_generator_type = LEHMER_RNG;
+    _sampler_type = LEGACY_SAMPLER;
 }
 
 /** Sets output data file name.
@@ -586,6 +592,20 @@ void Parameters::setPValueReportingType(PValueReportingType e) {
     _pvalue_reporting_type = e;
 }
 
+/** Sets random number generator type. Throws exception if out of range. */
+void Parameters::setRandomNumberGeneratorType(RandomNumberGeneratorType e) {
+    if (e < LEHMER_RNG || e > PHILOX_RNG)
+        throw prg_error("Enumeration %d out of range [%d,%d].", "setRandomNumberGeneratorType()", e, LEHMER_RNG, PHILOX_RNG);
+    _random_number_generator_type = e;
+}
+
+/** Sets Poisson and binomial variate sampler type. Throws exception if out of range. */
+void Parameters::setSamplerType(SamplerType e) {
+    if (e < LEGACY_SAMPLER || e > REJECTION_SAMPLER)
+        throw prg_error("Enumeration %d out of range [%d,%d].", "setSamplerType()", e, LEGACY_SAMPLER, REJECTION_SAMPLER);
+    _sampler_type = e;
+}
+
 /** Sets filename of file used to load parameters. */
 void Parameters::setSourceFileName(const char * sParametersSourceFileName) {
   // Use FileName class to ensure that a relative path is expanded to absolute path.
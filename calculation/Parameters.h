@@ -66,6 +66,8 @@ class Parameters {
                         MINIMUM_CASES_NODE,
                         PVALUE_REPORT_TYPE, /* p-value reporting type (enumeration) */
                         EARLY_TERM_THRESHOLD, /* early termination threshold (integer) */
+                        RANDOM_NUMBER_GENERATOR, /* random number generator engine (enumeration) */
+                        SAMPLER_TYPE, /* Poisson, binomial and multinomial variate and case permutation sampler (enumeration) */
                         /* Output */
                         RESULTS_FILE,
                         RESULTS_HTML,
@@ -147,6 +149,8 @@ class Parameters {
     enum MaximumWindowType {PERCENTAGE_WINDOW=0, FIXED_LENGTH};    
     enum ScanRateType { HIGHRATE=0, LOWRATE, HIGHORLOWRATE };
     enum PValueReportingType { STANDARD_PVALUE=0, TERMINATION_PVALUE };
+    enum RandomNumberGeneratorType { LEHMER_RNG=0, PHILOX_RNG };
+    enum SamplerType { LEGACY_SAMPLER=0, REJECTION_SAMPLER };
     typedef std::map<std::string,Parameters::CutType> cut_map_t;
     typedef std::pair<cut_map_t, cut_map_t> cut_maps_t;
     typedef std::vector<std::string> FileNameContainer_t;
@@ -329,6 +333,8 @@ class Parameters {
 
     PValueReportingType                 _pvalue_reporting_type;
     unsigned int                        _early_term_threshold;
+    RandomNumberGeneratorType           _random_number_generator_type;
+    SamplerType                         _sampler_type;
 
     void                                assignMissingPath(std::string & sInputFilename, bool bCheckWritable=false);
     void                                copy(const Parameters &rhs);
@@ -356,6 +362,10 @@ class Parameters {
     unsigned int                        getEarlyTermThreshold() const { return _early_term_threshold; }
     void                                setEarlyTermThreshold(unsigned int i) { _early_term_threshold = i; }
     unsigned int                        getExecuteEarlyTermThreshold() const;
+    RandomNumberGeneratorType           getRandomNumberGeneratorType() const { return _random_number_generator_type; }
+    void                                setRandomNumberGeneratorType(RandomNumberGeneratorType e);
+    SamplerType                         getSamplerType() const { return _sampler_type; }
+    void                                setSamplerType(SamplerType e);
     bool                                getTerminateSimulationsEarly() const;
     bool                                getDataOnlyOnLeaves() const { return _data_only_on_leaves; }
     void                                setDataOnlyOnLeaves(bool b) { _data_only_on_leaves = b; }
@@ -528,6 +528,10 @@ ParametersPrint::SettingContainer_t & ParametersPrint::getRunOptionsParameters(S
         printString(buffer, "%ld\n", _parameters.getRandomizationSeed());
         settings.emplace_back("Randomization Seed",buffer);
     }
+    if (_parameters.getRandomNumberGeneratorType() == Parameters::PHILOX_RNG)
+        settings.emplace_back("Random Number Generator", "Counter-Based (Philox)");
+    if (_parameters.getSamplerType() == Parameters::REJECTION_SAMPLER)
+        settings.emplace_back("Poisson/Binomial Sampler", "Transformed Rejection (PTRS/BTRD)");
     return settings;
 }
 
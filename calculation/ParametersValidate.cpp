@@ -758,6 +758,8 @@ bool ParametersValidate::ValidateRandomizationSeed(BasePrint& PrintDirection) co
                             BasePrint::P_PARAMERROR, RandomNumberGenerator::glM - 1);
       return false;
   }
+  // the counter-based generator is keyed on the seed and replication index, the seed is not incremented per replication
+  if (_parameters.getRandomNumberGeneratorType() == Parameters::PHILOX_RNG) return true;
   // validate that generated seeds during randomization will not exceed defined range
   double dMaxRandomizationSeed = (double)_parameters.getRandomizationSeed() + (double)_parameters.getNumReplicationsRequested();
   if (dMaxRandomizationSeed >= static_cast<double>(RandomNumberGenerator::glM)) {
@@ -3,16 +3,20 @@
 #define __CRITICAL_VALUES_H
 //**********************************************************************************
 #include "TreeScan.h"
+#include "TopValues.h"
 
-/** Maintains ordered list of significant log likelihood ratios as calculated during simulation process. */
+/** Maintains the most significant log likelihood ratios as calculated during simulation process. */
 class CriticalValues {
     public:
-        typedef std::vector<double> container_t;
+        typedef TopValues<double> container_t;
         typedef std::pair<bool,double> alpha_t;
 
+    private:
         container_t _ratios;
         unsigned int _numReplications;
 
+        alpha_t getAlpha(double alpha) const;
+
     public:
         CriticalValues(unsigned int iNumReplications);
 
@@ -3,9 +3,28 @@
 //******************************************************************************
 #include "Loglikelihood.h"
 #include "ScanRunner.h"
+#include "boost/thread/mutex.hpp"
 
 double AbstractLoglikelihood::UNSET_LOGLIKELIHOOD = -std::numeric_limits<double>::max();
 
+/** Constructor - tabulates c*log(c) for 0..C, reusing the table of another object with the same C if one exists. */
+CLogCTable::CLogCTable(int C) : _values(0), _size(0) {
+    if (C < 0 || C > MAXIMUM_TABULATED) return;
+    static boost::mutex tables_mutex;
+    static std::map<int, std::weak_ptr<const std::vector<double>>> tables;
+    boost::mutex::scoped_lock lock(tables_mutex);
+    _table = tables[C].lock();
+    if (!_table) {
+        std::shared_ptr<std::vector<double>> table(new std::vector<double>(static_cast<size_t>(C) + 1, 0.0));
+        for (int c=1; c <= C; ++c)
+            (*table)[c] = c * log(static_cast<double>(c));
+        _table = table;
+        tables[C] = _table;
+    }
+    _values = _table->data();
+    _size = _table->size();
+}
+
 AbstractLoglikelihood* AbstractLoglikelihood::getNewLoglikelihood(const ScanRunner& scanrunner) {
     return AbstractLoglikelihood::getNewLoglikelihood(
         scanrunner.getParameters(), scanrunner.getTotalC(), scanrunner.getTotalN(), 
@@ -92,6 +111,20 @@ double SignedRankLoglikelihood::LogLikelihoodRatio(const SampleSiteDifferencePro
         _ranker[t].first = diff = ssData.nextDifference();
         _ranker[t].second = std::abs(diff);
     }
+    return rankedLogLikelihoodRatio();
+}
+
+/** Returns the signed rank statistic of the 'size' sample site differences -- without the virtual proxy, for the simulation scans. */
+double SignedRankLoglikelihood::LogLikelihoodRatio(const double * differences, size_t size) const {
+    for (size_t t=0; t < size; ++t) {
+        _ranker[t].first = differences[t];
+        _ranker[t].second = std::abs(differences[t]);
+    }
+    return rankedLogLikelihoodRatio();
+}
+
+/** Ranks the differences in _ranker by absolute value, returning the sum of the signed ranks. */
+double SignedRankLoglikelihood::rankedLogLikelihoodRatio() const {
     std::sort(_ranker.begin(), _ranker.end(), [](const std::pair<double, double>& a, const std::pair<double, double>& b) {
         return a.second < b.second;
     });
@@ -9,6 +9,24 @@
 class ScanRunner;
 class SampleSiteDifferenceProxy;
 
+/** Values of c*log(c) for the case counts 0..C, tabulated once per run and shared read only by the log likelihood objects of all threads.
+    Counts outside the table, including those of runs too large to tabulate, are calculated as needed. */
+class CLogCTable {
+private:
+    std::shared_ptr<const std::vector<double>> _table;
+    const double * _values;
+    size_t _size;
+
+public:
+    static const int MAXIMUM_TABULATED = 1 << 24;
+
+    CLogCTable(int C);
+
+    double operator()(int c) const {
+        return static_cast<size_t>(c) < _size ? _values[c] : c * log(static_cast<double>(c));
+    }
+};
+
 /** Abstract base log likelihood class. */
 class AbstractLoglikelihood {
 public:
@@ -22,6 +40,44 @@ protected:
     const unsigned int _minimum_highrate_nodes_cases;
     const unsigned int _minimum_lowrate_nodes_cases;
 
+    /* Calculates the log likelihoods of count pairs with 'calculate', testing each pair against the rate of interest for totals C and N.
+       The rate test is resolved once for all pairs, so neither the test nor 'calculate' is an indirect call. */
+    template <typename Calculate>
+    void calculateLogLikelihoods(const int * c, const double * n, size_t n_stride, size_t count, double * loglikelihoods, int C, double N, Calculate calculate) const {
+        switch (_scan_rate) {
+            case Parameters::LOWRATE:
+                for (size_t i=0; i < count; ++i)
+                    loglikelihoods[i] = LowRate(c[i], n[i * n_stride], C, N) ? calculate(c[i], n[i * n_stride]) : UNSET_LOGLIKELIHOOD;
+                break;
+            case Parameters::HIGHORLOWRATE:
+                for (size_t i=0; i < count; ++i)
+                    loglikelihoods[i] = HighOrLowRate(c[i], n[i * n_stride], C, N) ? calculate(c[i], n[i * n_stride]) : UNSET_LOGLIKELIHOOD;
+                break;
+            case Parameters::HIGHRATE:
+            default:
+                for (size_t i=0; i < count; ++i)
+                    loglikelihoods[i] = HighRate(c[i], n[i * n_stride], C, N) ? calculate(c[i], n[i * n_stride]) : UNSET_LOGLIKELIHOOD;
+        }
+    }
+    /* Calculates the log likelihoods of count pairs with 'calculate', testing each pair against the unconditioned rate of interest. */
+    template <typename Calculate>
+    void calculateUnconditionedLogLikelihoods(const int * c, const double * n, size_t n_stride, size_t count, double * loglikelihoods, Calculate calculate) const {
+        switch (_scan_rate) {
+            case Parameters::LOWRATE:
+                for (size_t i=0; i < count; ++i)
+                    loglikelihoods[i] = LowRateUnconditioned(c[i], n[i * n_stride]) ? calculate(c[i], n[i * n_stride]) : UNSET_LOGLIKELIHOOD;
+                break;
+            case Parameters::HIGHORLOWRATE:
+                for (size_t i=0; i < count; ++i)
+                    loglikelihoods[i] = HighOrLowRateUnconditioned(c[i], n[i * n_stride]) ? calculate(c[i], n[i * n_stride]) : UNSET_LOGLIKELIHOOD;
+                break;
+            case Parameters::HIGHRATE:
+            default:
+                for (size_t i=0; i < count; ++i)
+                    loglikelihoods[i] = HighRateUnconditioned(c[i], n[i * n_stride]) ? calculate(c[i], n[i * n_stride]) : UNSET_LOGLIKELIHOOD;
+        }
+    }
+
 public:
     AbstractLoglikelihood(const Parameters& parameters)
         :_scan_rate(parameters.getScanRateType()),
@@ -35,9 +91,21 @@ public:
     virtual double LogLikelihood(int c, double n, int bc, double bn) const {
         throw prg_error("LogLikelihood(int,double,int,double) not implemented.", "LogLikelihood()");
     }    
+    /** Calculates the log likelihoods of the count pairs (c[i], n[i * n_stride]) for i < count, as LogLikelihood(int,double) would -- a stride
+        of zero pairs every count with the same n. Derived classes override this with a loop free of virtual and member pointer calls. */
+    virtual void LogLikelihoods(const int * c, const double * n, size_t n_stride, size_t count, double * loglikelihoods) const {
+        for (size_t i=0; i < count; ++i)
+            loglikelihoods[i] = LogLikelihood(c[i], n[i * n_stride]);
+    }
 	virtual double LogLikelihood(int c, double n, size_t windowLength) const {
         throw prg_error("LogLikelihood(int,int,size_t) not implemented.", "LogLikelihood()");
     }
+    /** Calculates the log likelihoods of the windows (c[i], windowLengths[i]) for i < count, each of the same total n, as LogLikelihood(int,double,size_t)
+        would. Derived classes override this with a loop free of virtual calls. */
+    virtual void WindowLogLikelihoods(const int * c, double n, const size_t * windowLengths, size_t count, double * loglikelihoods) const {
+        for (size_t i=0; i < count; ++i)
+            loglikelihoods[i] = LogLikelihood(c[i], n, windowLengths[i]);
+    }
     virtual double LogLikelihoodRatio(const SampleSiteDifferenceProxy& ssData) const {
         throw prg_error("LogLikelihoodRatio(const SampleSiteMap_t& ssData) not implemented.", "LogLikelihood()");
     }
@@ -121,17 +189,19 @@ public:
 
 class SampleSiteVectorDifferenceProxy : public SampleSiteDifferenceProxy {
 private:
-    const std::vector<double>& _ssData;
+    const double * _ssData;
+    size_t _size;
     mutable size_t _current;
 
 public:
-    SampleSiteVectorDifferenceProxy(const std::vector<double>& ssData) : _ssData(ssData), _current(0) {}
+    SampleSiteVectorDifferenceProxy(const std::vector<double>& ssData) : _ssData(ssData.data()), _size(ssData.size()), _current(0) {}
+    SampleSiteVectorDifferenceProxy(const double * ssData, size_t size) : _ssData(ssData), _size(size), _current(0) {}
     virtual double nextDifference() const {
         double diff = _ssData[_current];
         ++_current;
         return diff;
     }
-    virtual size_t size() const { return _ssData.size(); }
+    virtual size_t size() const { return _size; }
 };
 
 /** Log likelihood class for the signed rank model. */
@@ -139,11 +209,14 @@ class SignedRankLoglikelihood : public AbstractLoglikelihood {
 private:
     mutable std::vector<std::pair<double,double>> _ranker;
 
+    double rankedLogLikelihoodRatio() const;
+
 public:
     SignedRankLoglikelihood(const Parameters& parameters, unsigned int num_sample_sites);
     virtual ~SignedRankLoglikelihood() {}
 
     virtual double LogLikelihoodRatio(const SampleSiteDifferenceProxy& ssData) const;
+    double LogLikelihoodRatio(const double * differences, size_t size) const;
 
     virtual double  LogLikelihoodRatio(double logLikelihood) const {
         if (logLikelihood == UNSET_LOGLIKELIHOOD) return 0.0;
@@ -156,9 +229,10 @@ class PoissonLoglikelihood : public AbstractLoglikelihood {
 protected:
     const int       _totalC;
     const double    _totalN;
+    const CLogCTable _c_log_c;
 
 public:
-    PoissonLoglikelihood(int totalC, double totalN, const Parameters& parameters) : AbstractLoglikelihood(parameters), _totalC(totalC), _totalN(totalN) {
+    PoissonLoglikelihood(int totalC, double totalN, const Parameters& parameters) : AbstractLoglikelihood(parameters), _totalC(totalC), _totalN(totalN), _c_log_c(totalC) {
         switch (parameters.getScanRateType()) {
             case Parameters::LOWRATE: _of_interest = &AbstractLoglikelihood::LowRate; break;
             case Parameters::HIGHORLOWRATE: _of_interest = &AbstractLoglikelihood::HighOrLowRate; break;
@@ -168,12 +242,23 @@ public:
     }
     virtual ~PoissonLoglikelihood(){}
 
+    /** Calculates the conditional Poisson log likelihood, without testing the rate of interest, given log(n) and log(N - n). */
+    double calculate(int c, double log_n, double log_remaining_n) const {
+        if (c == _totalC) return _c_log_c(c) - c * log_n;
+        if (c == 0) return _c_log_c(_totalC) - _totalC * log_remaining_n;
+        return _c_log_c(c) - c * log_n + _c_log_c(_totalC - c) - (_totalC - c) * log_remaining_n;
+    }
     /** Calculates the conditional Poisson log likelihood. */
     virtual double LogLikelihood(int c, double n) const {
         if (!(this->*_of_interest)(c, n, _totalC, _totalN)) return UNSET_LOGLIKELIHOOD;
-        if (c == _totalC) return c * log(c/n);
-        if (c == 0) return _totalC * log(_totalC / (_totalN - n));
-        return c * log(c/n) + (_totalC - c) * log((_totalC - c)/(_totalN - n));
+        return calculate(c, log(n), log(_totalN - n));
+    }
+    virtual void LogLikelihoods(const int * c, const double * n, size_t n_stride, size_t count, double * loglikelihoods) const {
+        if (n_stride == 0) { // the logarithms of n are the same for every count
+            const double log_n = log(*n), log_remaining_n = log(_totalN - *n);
+            calculateLogLikelihoods(c, n, n_stride, count, loglikelihoods, _totalC, _totalN, [this, log_n, log_remaining_n](int c, double) { return calculate(c, log_n, log_remaining_n); });
+        } else
+            calculateLogLikelihoods(c, n, n_stride, count, loglikelihoods, _totalC, _totalN, [this](int c, double n) { return calculate(c, log(n), log(_totalN - n)); });
     }
     virtual double  LogLikelihoodRatio(double logLikelihood) const {
         if (logLikelihood == UNSET_LOGLIKELIHOOD) return 0.0;
@@ -224,10 +309,17 @@ public:
     }
     virtual ~UnconditionalPoissonLoglikelihood(){}
 
+    /** Calculates the unconditional Poisson log likelihood, without testing the rate of interest. */
+    static double calculate(int c, double n) {
+        return (n - c) + c * log(c/n);
+    }
     /** Calculates the unconditional Poisson log likelihood. */
     virtual double  LogLikelihood(int c, double n) const {
         if (!(this->*_uncond_of_interest)(c, n)) return UNSET_LOGLIKELIHOOD;
-        return (n - c) + c * log(c/n);
+        return calculate(c, n);
+    }
+    virtual void LogLikelihoods(const int * c, const double * n, size_t n_stride, size_t count, double * loglikelihoods) const {
+        calculateUnconditionedLogLikelihoods(c, n, n_stride, count, loglikelihoods, &UnconditionalPoissonLoglikelihood::calculate);
     }
     virtual double  LogLikelihoodRatio(double logLikelihood) const {
         if (logLikelihood == UNSET_LOGLIKELIHOOD) return 0.0;
@@ -240,9 +332,10 @@ class BernoulliLoglikelihood : public AbstractLoglikelihood {
 protected:
     const int       _totalC;
     const double    _totalN;
+    const CLogCTable _c_log_c;
 
 public:
-    BernoulliLoglikelihood(int totalC, double totalN, const Parameters& parameters) : AbstractLoglikelihood(parameters), _totalC(totalC), _totalN(totalN)  {
+    BernoulliLoglikelihood(int totalC, double totalN, const Parameters& parameters) : AbstractLoglikelihood(parameters), _totalC(totalC), _totalN(totalN), _c_log_c(totalC)  {
         switch (parameters.getScanRateType()) {
             case Parameters::LOWRATE: _of_interest = &AbstractLoglikelihood::LowRate; break;
             case Parameters::HIGHORLOWRATE: _of_interest = &AbstractLoglikelihood::HighOrLowRate; break;
@@ -255,13 +348,24 @@ public:
     /** Calculates the conditional Bernoulli log likelihood. */
     virtual double  LogLikelihood(int c, double n) const {
         if (!(this->*_of_interest)(c, n, _totalC, _totalN)) return UNSET_LOGLIKELIHOOD;
+        return calculate(c, n, log(n), log(_totalN - n));
+    }
+    virtual void LogLikelihoods(const int * c, const double * n, size_t n_stride, size_t count, double * loglikelihoods) const {
+        if (n_stride == 0) { // the logarithms of n are the same for every count
+            const double log_n = log(*n), log_remaining_n = log(_totalN - *n);
+            calculateLogLikelihoods(c, n, n_stride, count, loglikelihoods, _totalC, _totalN, [this, log_n, log_remaining_n](int c, double n) { return calculate(c, n, log_n, log_remaining_n); });
+        } else
+            calculateLogLikelihoods(c, n, n_stride, count, loglikelihoods, _totalC, _totalN, [this](int c, double n) { return calculate(c, n, log(n), log(_totalN - n)); });
+    }
+    /** Calculates the conditional Bernoulli log likelihood, without testing the rate of interest, given log(n) and log(N - n). */
+    double calculate(int c, double n, double log_n, double log_remaining_n) const {
         double nLL_A = 0.0, nLL_B = 0.0, nLL_C = 0.0, nLL_D = 0.0;
         if (c != 0)
-            nLL_A = c*log(c/n);
+            nLL_A = _c_log_c(c) - c*log_n;
         if (c != n)
             nLL_B = (n-c)*log(1-(c/n));
         if (_totalC-c != 0)
-            nLL_C = (_totalC-c)*log((_totalC-c)/(_totalN-n));
+            nLL_C = _c_log_c(_totalC-c) - (_totalC-c)*log_remaining_n;
         if (_totalC-c != _totalN-n)
             nLL_D = ((_totalN-n)-(_totalC-c))*log(1-((_totalC-c)/(_totalN-n)));
         return nLL_A + nLL_B + nLL_C + nLL_D;
@@ -380,7 +484,7 @@ public:
     virtual ~TemporalLoglikelihood(){}
 
     /** Calculates the conditional temporal log likelihood. */
-    virtual double  LogLikelihood(int c, double n, size_t windowLength) const {
+    double calculate(int c, double n, size_t windowLength) const {
         // c = cases in the window for the branch under consideration, c>=0
         // n = total cases for the branch under consideration, inside and outside the window, n>=c
         double r = static_cast<double>(windowLength) / static_cast<double>(_totalDaysInRange);
@@ -395,6 +499,11 @@ public:
         // we're calculating the full loglikelihood ratio here
         return loglikelihood - static_cast<double>(c) * _log1[windowLength] - (n - static_cast<double>(c)) * _log2[windowLength];
     }
+    virtual double  LogLikelihood(int c, double n, size_t windowLength) const { return calculate(c, n, windowLength); }
+    virtual void WindowLogLikelihoods(const int * c, double n, const size_t * windowLengths, size_t count, double * loglikelihoods) const {
+        for (size_t i=0; i < count; ++i)
+            loglikelihoods[i] = calculate(c[i], n, windowLengths[i]);
+    }
     virtual double  LogLikelihoodRatio(double logLikelihood) const {
         if (logLikelihood == UNSET_LOGLIKELIHOOD) return 0.0;
         // The full log likelihood ratio is calculated in LogLikelihood() call.
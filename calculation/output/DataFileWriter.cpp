@@ -214,17 +214,24 @@ std::string& CSVDataFileWriter::encodeForCSV(std::string& sValue, const FieldDef
     return sValue;
 }
 
-/** Writes record buffer to file stream. */
-void CSVDataFileWriter::writeRecord(const RecordBuffer& Record) {
+/** Formats record buffer as a line of comma separated values, without the line end. */
+std::string& CSVDataFileWriter::formatRecord(const RecordBuffer& Record, std::string& line) {
     std::string value;
+    line.clear();
     for (unsigned int j=0; j < Record.GetNumFields(); ++j) {
         value.clear();
         if (!Record.GetFieldIsBlank(j))
             encodeForCSV(value, Record.GetFieldDefinition(j), Record.GetFieldValue(j));
-        _outfile << value;
-        if (j < Record.GetNumFields() - 1) _outfile << ",";
+        line += value;
+        if (j < Record.GetNumFields() - 1) line += ",";
     }
-    _outfile << std::endl;
+    return line;
+}
+
+/** Writes record buffer to file stream. */
+void CSVDataFileWriter::writeRecord(const RecordBuffer& Record) {
+    std::string line;
+    _outfile << formatRecord(Record, line) << std::endl;
 }
 
 
@@ -818,7 +825,7 @@ const char * LoglikelihoodRatioWriter::LLR_HA_FILE_SUFFIX    = "_llr_ha";
 const char * LoglikelihoodRatioWriter::SIMULATION_IDX_FIELD  = "SIMIDX";
 const char * LoglikelihoodRatioWriter::LOG_LIKL_RATIO_FIELD  = "LLR";
 
-LoglikelihoodRatioWriter::LoglikelihoodRatioWriter(const ScanRunner& scanRunner) : _scanner(scanRunner) {
+LoglikelihoodRatioWriter::LoglikelihoodRatioWriter(const ScanRunner& scanRunner) : _scanner(scanRunner), _records(0) {
   unsigned short uwOffset=0;
   std::string buffer;
   try {
@@ -830,7 +837,7 @@ LoglikelihoodRatioWriter::LoglikelihoodRatioWriter(const ScanRunner& scanRunner)
 }
 
 LoglikelihoodRatioWriter::LoglikelihoodRatioWriter(const ScanRunner& scanRunner, bool ispower, bool append, bool includeIdx) : 
-    _scanner(scanRunner), _include_sim_idx(includeIdx){
+    _scanner(scanRunner), _include_sim_idx(includeIdx), _records(0) {
   unsigned short uwOffset=0;
   std::string buffer;
   try {
@@ -844,6 +851,7 @@ LoglikelihoodRatioWriter::LoglikelihoodRatioWriter(const ScanRunner& scanRunner,
     if (!_outfile.is_open())
         throw resolvable_error("Unable to open/create file %s.", buffer.c_str());
     _csvWriter.reset(new CSVDataFileWriter(_outfile, _dataFieldDefinitions, _scanner.getParameters().isPrintColumnHeaders() && !append, append));
+    _record_writer.reset(new AsynchronousOrderedWriter(_outfile, buffer));
   } catch (prg_exception& x) {
     x.addTrace("constructor()","LoglikelihoodRatioWriter");
     throw;
@@ -852,6 +860,7 @@ LoglikelihoodRatioWriter::LoglikelihoodRatioWriter(const ScanRunner& scanRunner,
 
 LoglikelihoodRatioWriter::~LoglikelihoodRatioWriter() {
     try {
+        _record_writer.reset(); // writes records still queued
         _outfile.close();
     } catch (...) { }
 }
@@ -860,6 +869,7 @@ std::string& LoglikelihoodRatioWriter::getFilename(const Parameters& parameters,
   return getDerivedFilename(parameters.getOutputFileName(), ispower ? LoglikelihoodRatioWriter::LLR_HA_FILE_SUFFIX : LoglikelihoodRatioWriter::LLR_FILE_SUFFIX, CSVDataFileWriter::CSV_FILE_EXT, buffer);
 }
 
+/** Queues record of log likelihood ratio, which is written to file by the record writer's thread in the order records are queued. */
 void LoglikelihoodRatioWriter::write(double llr, unsigned int simulation) const {
     std::string  buffer;
     RecordBuffer Record(_dataFieldDefinitions);
@@ -868,7 +878,8 @@ void LoglikelihoodRatioWriter::write(double llr, unsigned int simulation) const
         if (_include_sim_idx)
             Record.GetFieldValue(SIMULATION_IDX_FIELD).AsUnsignedLong() = simulation;
         Record.GetFieldValue(LOG_LIKL_RATIO_FIELD).AsDouble() = llr;
-        _csvWriter->writeRecord(Record);
+        CSVDataFileWriter::formatRecord(Record, buffer) += '\n';
+        _record_writer->write(++_records, std::move(buffer));
     } catch (prg_exception& x) {
         x.addTrace("write()","LoglikelihoodRatioWriter");
         throw;
@@ -890,6 +901,7 @@ SequentialScanLoglikelihoodRatioWriter::SequentialScanLoglikelihoodRatioWriter(c
         _outfile << getSequentialParametersString(scanRunner.getParameters(), buffer).c_str() << std::endl;
 
         _csvWriter.reset(new CSVDataFileWriter(_outfile, _dataFieldDefinitions, true, false));
+        _record_writer.reset(new AsynchronousOrderedWriter(_outfile, getFilename(_scanner.getParameters(), buffer)));
     } catch (prg_exception& x) {
         x.addTrace("constructor()","SequentialScanLoglikelihoodRatioWriter");
         throw;
@@ -6,6 +6,7 @@
 #include "FieldDef.h"
 #include "ptr_vector.h"
 #include "SampleSiteData.h"
+#include "AsynchronousOrderedWriter.h"
 #include <iostream>
 #include <fstream>
 #include "boost/thread/mutex.hpp"
@@ -110,6 +111,7 @@ class CSVDataFileWriter {
 
       static std::string& encodeForCSV(std::string& destString, const std::string& srcString);
       static std::string& encodeForCSV(std::string& sValue, const FieldDef& FieldDef, const FieldValue& fv);
+      static std::string& formatRecord(const RecordBuffer& Record, std::string& line);
       virtual void writeRecord(const RecordBuffer& Record);
 };
 
@@ -175,7 +177,9 @@ class LoglikelihoodRatioWriter : public DataRecordWriter {
         const ScanRunner & _scanner;
         std::ofstream _outfile;
         std::unique_ptr<CSVDataFileWriter> _csvWriter;
+        std::unique_ptr<AsynchronousOrderedWriter> _record_writer;
         bool _include_sim_idx;
+        mutable unsigned int _records;
 
         LoglikelihoodRatioWriter(const ScanRunner& scanRunner);
 
@@ -12,7 +12,7 @@ AlternativeHypothesisRandomizater::AlternativeHypothesisRandomizater(const ScanR
                                                                      int totalC,
                                                                      bool multiparents,
                                                                      long lInitialSeed)
-                                  : AbstractRandomizer(parameters, multiparents, lInitialSeed), _randomizer(randomizer), _alternative_adjustments(adjustments) {
+                                  : AbstractRandomizer(parameters, multiparents, randomizer->_branch_aggregation, lInitialSeed), _randomizer(randomizer), _alternative_adjustments(adjustments) {
     _randomizer->_read_data = false;
     _randomizer->_write_data = false;
     if (_parameters.getModelType() == Parameters::POISSON) {
@@ -77,13 +77,9 @@ int AlternativeHypothesisRandomizater::RandomizeData(unsigned int iSimulation, c
     }
     totalCases = randomize(iSimulation, *_nodes_proxy, treeSimNodes);
     // write simulation data to file if requested
-    if (_write_data) {
-        boost::mutex::scoped_lock lock(mutex);
-        write(_write_filename, treeSimNodes);
-    }
+    if (_write_data) write(iSimulation, treeSimNodes);
     //------------------------ UPDATING THE TREE -----------------------------------
-    for (size_t i=0; i < treeNodes.size(); i++)
-        addSimC_C(i, i, treeSimNodes[i].getIntC_C(), treeSimNodes, treeNodes);
+    addSimC_C(treeSimNodes);
     return totalCases;
 }
 
@@ -92,7 +88,7 @@ int AlternativeHypothesisRandomizater::read(const std::string& filename, unsigne
     return _randomizer->read(filename, simulation, treeNodes, treeSimNodes, mutex);
 }
 
-/** Writes simulation data to file through actual randomizer. */
-void AlternativeHypothesisRandomizater::write(const std::string& filename, const SimNodeContainer_t& treeSimNodes) {
-    _randomizer->write(filename, treeSimNodes);
+/** Formats simulation data for the simulated data file through actual randomizer. */
+void AlternativeHypothesisRandomizater::formatSimulationData(const SimNodeContainer_t& treeSimNodes, std::string& record) const {
+    _randomizer->formatSimulationData(treeSimNodes, record);
 }
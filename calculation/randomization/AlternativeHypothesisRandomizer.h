@@ -15,7 +15,7 @@ class AlternativeHypothesisRandomizater : public AbstractRandomizer {
 
         virtual int randomize(unsigned int iSimulation, const AbstractNodesProxy& treeNodes, SimNodeContainer_t& treeSimNodes);
         virtual int read(const std::string& filename, unsigned int simulation, const ScanRunner::NodeStructureContainer_t& treeNodes, SimNodeContainer_t& treeSimNodes, boost::mutex& mutex);
-        virtual void write(const std::string& filename, const SimNodeContainer_t& treeSimNodes);
+        virtual void formatSimulationData(const SimNodeContainer_t& treeSimNodes, std::string& record) const;
 
     public:
         AlternativeHypothesisRandomizater(const ScanRunner::NodeStructureContainer_t& treeNodes,
@@ -12,7 +12,8 @@ using boost::uniform_01;
 
 /** Constructor */
 UnconditionalBernoulliRandomizer::UnconditionalBernoulliRandomizer(const ScanRunner& scanner, long lInitialSeed)
-                    :AbstractDenominatorDataRandomizer(scanner, lInitialSeed), _total_C(scanner.getTotalC()), _total_Controls(scanner.getTotalControls()) {
+                    :AbstractDenominatorDataRandomizer(scanner, lInitialSeed), _total_C(scanner.getTotalC()), _total_Controls(scanner.getTotalControls()),
+                     _rejection_sampling(scanner.getParameters().getSamplerType() == Parameters::REJECTION_SAMPLER) {
 	sequentialSetup(_scanner);
 }
 
@@ -21,13 +22,19 @@ int UnconditionalBernoulliRandomizer::randomize(unsigned int iSimulation, const
     // reset seed of random number generator
     setSeed(iSimulation);
     // reset simData
-    std::for_each(treeSimNodes.begin(), treeSimNodes.end(), std::mem_fn(&SimulationNode::clear));
+    treeSimNodes.reset();
 
     int TotalSimC=0;
+    if (_rejection_sampling) _binomial_samplers.resize(treeNodes.size());
     for (size_t i=0; i < treeNodes.size(); ++i) {
         treeSimNodes[i].refBrC() = 0; // initializing the branch cases with zero
         if (!treeNodes.randomized(i)) continue; // skip if not randomized
-        int cases = _binomial_generator.GetBinomialDistributedVariable(static_cast<int>(treeNodes.getIntN(i)), static_cast<float>(treeNodes.getProbability(i)), _random_number_generator);
+        _random_number_generator.SetStream(static_cast<unsigned int>(i)); // each node draws from its own stream, if counter-based
+        int cases;
+        if (_rejection_sampling)
+            cases = static_cast<int>(_binomial_samplers[i].sample(static_cast<long>(treeNodes.getIntN(i)), treeNodes.getProbability(i), _random_number_generator));
+        else
+            cases = _binomial_generator.GetBinomialDistributedVariable(static_cast<int>(treeNodes.getIntN(i)), static_cast<float>(treeNodes.getProbability(i)), _random_number_generator);
         treeSimNodes[i].refIntC() = cases;
         TotalSimC += cases;
     } // for i
@@ -45,12 +52,13 @@ int UnconditionalBernoulliVariableProbabilityRandomizer::randomize(unsigned int
     // reset seed of random number generator
     setSeed(iSimulation);
     // reset simData
-    std::for_each(treeSimNodes.begin(), treeSimNodes.end(), std::mem_fn(&SimulationNode::clear));
+    treeSimNodes.reset();
 
     int TotalSimC = 0;
     for (size_t i = 0; i < treeNodes.size(); ++i) {
         treeSimNodes[i].refBrC() = 0; // initializing the branch cases with zero
         if (!treeNodes.randomized(i)) continue; // skip if not randomized
+        _random_number_generator.SetStream(static_cast<unsigned int>(i)); // each node draws from its own stream, if counter-based
         for (auto probability : treeNodes.getMatchSets(i).get()) {
             int cases = _binomial_generator.GetBinomialDistributedVariable(1, static_cast<float>(probability), _random_number_generator);
             treeSimNodes[i].refIntC() += cases;
@@ -64,7 +72,8 @@ int UnconditionalBernoulliVariableProbabilityRandomizer::randomize(unsigned int
 
 /* Constructor */
 AbstractConditionalBernoulliRandomizer::AbstractConditionalBernoulliRandomizer(int TotalC, int TotalControls, const ScanRunner& scanner, long lInitialSeed)
-                    :AbstractDenominatorDataRandomizer(scanner, lInitialSeed), _total_C(TotalC), _total_Controls(TotalControls) {}
+                    :AbstractDenominatorDataRandomizer(scanner, lInitialSeed), _total_C(TotalC), _total_Controls(TotalControls),
+                     _hypergeometric_sampling(scanner.getParameters().getSamplerType() == Parameters::REJECTION_SAMPLER) {}
 
 /** Each of the totalMeasure number of individuals (sum of cases and controls), are randomized to either be a case or a control. The output is an array with
     the indices of the TotalCounts number of cases. For example, if there are 20 cases and 80 controls, the output is an array of the indices between
@@ -87,7 +96,21 @@ void AbstractConditionalBernoulliRandomizer::MakeDataB(int tTotalCounts, double
 /** Distributes cases into simulation case array, where individuals are initially dichotomized into cases and
     controls then each randomly assigned to be a case or a control. */
 int AbstractConditionalBernoulliRandomizer::_randomize(int cases, int controls, const AbstractNodesProxy& treeNodes, SimNodeContainer_t& treeSimNodes) {
-    std::vector<int> randCounts;
+    if (_hypergeometric_sampling) {
+        // Each node's cases are those among its individuals, drawn without replacement from the individuals of the nodes not yet visited.
+        long remaining_cases = cases, remaining_individuals = cases + controls;
+        for (size_t i=0; i < treeNodes.size(); ++i) {
+            treeSimNodes[treeNodes.getID(i)].refBrC() = 0; // initializing the branch cases with zero
+            if (!treeNodes.randomized(i)) continue; // skip if not randomized
+            long individuals = static_cast<long>(treeNodes.getIntN(i));
+            long node_cases = _hypergeometric.sample(remaining_cases, remaining_individuals - remaining_cases, individuals, _random_number_generator);
+            treeSimNodes[treeNodes.getID(i)].refIntC() = static_cast<int>(node_cases);
+            remaining_cases -= node_cases;
+            remaining_individuals -= individuals;
+        }
+        return cases;
+    }
+    std::vector<int>& randCounts = _rand_counts;
     int nCumCounts = cases < controls ? cases : controls;
     MakeDataB(nCumCounts, cases + controls, randCounts);
     int nCumMeasure = cases + controls - 1;
@@ -125,19 +148,34 @@ int BernoulliTimeRandomizer::randomize(unsigned int iSimulation, const AbstractN
 	// reset seed of random number generator
 	setSeed(iSimulation);
 	// reset simData
-	std::for_each(treeSimNodes.begin(), treeSimNodes.end(), std::mem_fn(&SimulationNode::clear));
+	treeSimNodes.reset();
 
 	int TotalSimC = 0;
 	for (size_t i = 0; i < treeNodes.size(); ++i) {
         if (!treeNodes.randomized(i)) continue; // skip if not randomized
 		SimulationNode& simNode = treeSimNodes[treeNodes.getID(i)];
-		std::vector<int> randCounts;
+		std::vector<int>& randCounts = _rand_counts;
 		int node_cases = treeNodes.getIntC(i), node_controls = static_cast<int>(treeNodes.getIntN(i));
 		TotalSimC += node_cases;
+		int intervals = static_cast<int>(simNode.refIntC_C().size());
+		if (_hypergeometric_sampling) {
+			// Each interval's cases are those among its individuals, drawn without replacement from the individuals of the intervals not yet visited.
+			long remaining_cases = node_cases, remaining_individuals = node_cases + node_controls;
+			for (int idx = intervals - 1; idx >= 0 && remaining_cases > 0; --idx) {
+				long individuals = treeNodes.getIntC_C(i)[idx] + static_cast<long>(treeNodes.getIntN_C(i)[idx]);
+				if (idx < intervals - 1)
+					individuals -= treeNodes.getIntC_C(i)[idx + 1] + static_cast<long>(treeNodes.getIntN_C(i)[idx + 1]);
+				long interval_cases = _hypergeometric.sample(remaining_cases, remaining_individuals - remaining_cases, individuals, _random_number_generator);
+				simNode.refIntC_C()[idx] = static_cast<int>(interval_cases);
+				remaining_cases -= interval_cases;
+				remaining_individuals -= individuals;
+			}
+			simNode.setCumulative();
+			continue;
+		}
 		int nCumCounts = node_cases < node_controls ? node_cases : node_controls;
 		MakeDataB(nCumCounts, node_cases + node_controls, randCounts);
 		int nCumMeasure = node_cases + node_controls - 1;
-		int intervals = static_cast<int>(simNode.refIntC_C().size());
 		for (int idx = intervals-1; idx >= 0; --idx) {
 			if (idx == intervals - 1) {
 				nCumMeasure -= treeNodes.getIntC_C(i)[idx] + static_cast<int>(treeNodes.getIntN_C(i)[idx]);
@@ -170,7 +208,7 @@ int ConditionalBernoulliRandomizer::randomize(unsigned int iSimulation, const Ab
     // reset seed of random number generator
     setSeed(iSimulation);
     // reset simData
-    std::for_each(treeSimNodes.begin(), treeSimNodes.end(), std::mem_fn(&SimulationNode::clear));
+    treeSimNodes.reset();
     return _randomize(_total_C, _total_Controls, treeNodes, treeSimNodes);
 }
 
@@ -224,7 +262,7 @@ int ConditionalBernoulliAlternativeHypothesisRandomizer::randomize(unsigned int
     // reset seed of random number generator
     setSeed(iSimulation);
     // reset simData
-    std::for_each(treeSimNodes.begin(), treeSimNodes.end(), std::mem_fn(&SimulationNode::clear));
+    treeSimNodes.reset();
 
     mt19937 generator(iSimulation);
     Probabilities_t::iterator itr=std::lower_bound(_A.begin(), _A.end(), uniform_01<mt19937>(generator)());
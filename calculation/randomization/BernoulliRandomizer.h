@@ -3,6 +3,7 @@
 #define __BernoulliRandomizer_H
 //******************************************************************************
 #include "DenominatorDataRandomizer.h"
+#include "RandomSampler.h"
 #include <boost/cast.hpp>
 
 /** Data randomizer for unconditioned Bernoulli tree scan. */
@@ -10,6 +11,8 @@ class UnconditionalBernoulliRandomizer : public AbstractDenominatorDataRandomize
     protected:
         int                 _total_C;
         int                 _total_Controls;
+        bool                _rejection_sampling;                // whether sampling with the transformed rejection sampler
+        std::vector<BinomialSampler> _binomial_samplers;        // per node samplers, retaining constants across simulations
 
         virtual int randomize(unsigned int iSimulation, const AbstractNodesProxy& treeNodes, SimNodeContainer_t& treeSimNodes);
 
@@ -40,6 +43,9 @@ class AbstractConditionalBernoulliRandomizer : public AbstractDenominatorDataRan
     protected:
         int             _total_C;
         int             _total_Controls;
+        bool            _hypergeometric_sampling;           // whether drawing each node's cases from a hypergeometric rather than individual by individual
+        HypergeometricSampler _hypergeometric;
+        std::vector<int> _rand_counts;                      // indices of the randomized cases, retained across simulations
 
         void MakeDataB(int tTotalCounts, double tTotalMeasure, std::vector<int>& RandCounts);
 
@@ -9,75 +9,27 @@
 
 ////////////////////////////////////////////////// OrderedSimulationDataWriter /////////////////////////////////////////
 
-OrderedSimulationDataWriter::OrderedSimulationDataWriter(const std::string& filename, unsigned int num_simulations) : _sim_position(1), _num_simulations(num_simulations){
-    _sim_stream.reset(new std::ofstream());
-    _sim_stream->open(filename.c_str(), std::ios::ate | std::ios::app);
-}
-
-/** Writes simulation data to text file for given simulation while ensuring that simulations written are ordered by ordinal. */
+/** Writes simulation data to text file for given simulation -- simulations are written in ordinal sequence by the writer's thread. */
 void OrderedSimulationDataWriter::write(unsigned int simulation, const SimNodeContainer_t& treeSimNodes) {
-    if (_sim_position == simulation) { // If simulation position equals this simulation, write it now.
-        for (auto& node : treeSimNodes)
-            *_sim_stream << node.getIntC() << " ";
-        *_sim_stream << std::endl;
-        ++_sim_position;
-    } else { // Otherwise write this simulation data to cache.
-        CacheStream_t _cache_stream(new std::stringstream());
-        for (auto& node : treeSimNodes)
-            *_cache_stream << node.getIntC() << " ";
-        *_cache_stream << std::endl;
-        _sim_stream_cache.push_back(std::make_pair(simulation, _cache_stream));
-        std::sort(_sim_stream_cache.begin(), _sim_stream_cache.end()); // Sort by simulation number ascending.
-    }
-    // Now write any cached stream(s) which are next in the write sequence.
-    size_t numWritten = 0;
-    for (auto& cacheStream: _sim_stream_cache) {
-        if (_sim_position != cacheStream.first) break;
-        *_sim_stream << cacheStream.second->str();
-        ++_sim_position;
-        ++numWritten;
-    }
-    if (numWritten) _sim_stream_cache.erase(_sim_stream_cache.begin(), _sim_stream_cache.begin() + numWritten);
-    if (_sim_position > _num_simulations)
-        _sim_stream->close();
+    std::string record;
+    for (auto& node : treeSimNodes)
+        AsynchronousOrderedWriter::append(record, node.getIntC()) += ' ';
+    record += '\n';
+    _writer.write(simulation, std::move(record));
 }
 
-/** Writes sequential simulation data to text file for given simulation while ensuring that simulations written are ordered by ordinal. */
+/** Writes sequential simulation data to text file for given simulation -- simulations are written in ordinal sequence by the writer's thread. */
 void OrderedSimulationDataWriter::writeSequenceData(unsigned int simulation, const SimNodeContainer_t& treeSimNodes, const boost::dynamic_bitset<>& _restricted_levels, const boost::dynamic_bitset<>& writeNodes) {
-    if (_sim_position == simulation) { // If simulation position equals this simulation, write it now.
-        for (size_t t = 0; t < treeSimNodes.size(); ++t) {
-            const auto& node = treeSimNodes[t];
-            // skip writing data from nodes that are not evaluated or had zero expected cases
-            if (_restricted_levels.test(node.getLevel()) || !writeNodes.test(t))
-                continue;
-            *_sim_stream << node.getBrC() << " ";
-        }
-        *_sim_stream << std::endl;
-        ++_sim_position;
-    } else { // Otherwise write this simulation data to cache.
-        CacheStream_t _cache_stream(new std::stringstream());
-        for (size_t t = 0; t < treeSimNodes.size(); ++t) {
-            const auto& node = treeSimNodes[t];
-            // skip writing data from nodes that are not evaluated or had zero expected cases
-            if (_restricted_levels.test(node.getLevel()) || !writeNodes.test(t))
-                continue;
-            *_cache_stream << node.getBrC() << " ";
-        }
-        *_cache_stream << std::endl;
-        _sim_stream_cache.push_back(std::make_pair(simulation, _cache_stream));
-        std::sort(_sim_stream_cache.begin(), _sim_stream_cache.end()); // Sort by simulation number ascending.
-    }
-    // Now write any cached stream(s) which are next in the write sequence.
-    size_t numWritten = 0;
-    for (auto& cacheStream : _sim_stream_cache) {
-        if (_sim_position != cacheStream.first) break;
-        *_sim_stream << cacheStream.second->str();
-        ++_sim_position;
-        ++numWritten;
+    std::string record;
+    for (size_t t = 0; t < treeSimNodes.size(); ++t) {
+        const auto& node = treeSimNodes[t];
+        // skip writing data from nodes that are not evaluated or had zero expected cases
+        if (_restricted_levels.test(node.getLevel()) || !writeNodes.test(t))
+            continue;
+        AsynchronousOrderedWriter::append(record, node.getBrC()) += ' ';
     }
-    if (numWritten) _sim_stream_cache.erase(_sim_stream_cache.begin(), _sim_stream_cache.begin() + numWritten);
-    if (_sim_position > _num_simulations)
-        _sim_stream->close();
+    record += '\n';
+    _writer.write(simulation, std::move(record));
 }
 
 FileStreamReadManager::SharedStream_t FileStreamReadManager::getStream(const AbstractRandomizer * r, boost::mutex& mutex) {
@@ -94,7 +46,7 @@ FileStreamReadManager::SharedStream_t FileStreamReadManager::getStream(const Abs
 ////////////////////////////////////////////////// AbstractDenominatorDataRandomizer ///////////////////////////////////
 
 AbstractDenominatorDataRandomizer::AbstractDenominatorDataRandomizer(const ScanRunner& scanner, long lInitialSeed) :
-    AbstractRandomizer(scanner.getParameters(), scanner.getMultiParentNodesExist(), lInitialSeed), _scanner(scanner), _sim_position(1) {
+    AbstractRandomizer(scanner.getParameters(), scanner.getMultiParentNodesExist(), scanner.getBranchAggregation(), lInitialSeed), _scanner(scanner), _sim_position(1) {
     // Store the un-evaluated levels in tree for in bitset for tree sequential analyses.
     if (_parameters.isSequentialScanTreeOnly()) {
         _restricted_levels.resize(scanner.getTreeStatistics()._nodes_per_level.size() + 1);
@@ -107,17 +59,11 @@ AbstractDenominatorDataRandomizer::AbstractDenominatorDataRandomizer(const ScanR
 
 int AbstractDenominatorDataRandomizer::RandomizeData(unsigned int iSimulation, const ScanRunner::NodeStructureContainer_t& treeNodes, boost::mutex& mutex, SimNodeContainer_t& treeSimNodes) {
     int totalSimC = 0;
-    auto updateTree = [&treeNodes, &treeSimNodes, this]() { // update tree structure by adding counts up the tree
-        for (size_t i = 0; i < treeNodes.size(); i++)
-            addSimC_C(i, i, treeSimNodes[i].getIntC_C(), treeSimNodes, treeNodes);
-    };
-    auto standardWrite = [&treeSimNodes, &mutex, this]() { // standard simulation data write
-        boost::mutex::scoped_lock lock(mutex);
-        write(_write_filename, treeSimNodes);
-    };
+    auto updateTree = [&treeSimNodes, this]() { addSimC_C(treeSimNodes); }; // update tree structure by adding counts up the tree
+    auto standardWrite = [&treeSimNodes, iSimulation, this]() { write(iSimulation, treeSimNodes); }; // standard simulation data write
     if (_read_data) {
-        std::for_each(treeSimNodes.begin(), treeSimNodes.end(), std::mem_fn(&SimulationNode::clear));
-        boost::mutex::scoped_lock lock(mutex);
+        treeSimNodes.reset();
+        // each randomizer reads its own text stream, or the shared memory mapped binary file, so reading takes no lock
         totalSimC = read(_read_filename, iSimulation, treeNodes, treeSimNodes, mutex);
         if (_write_data) standardWrite(); // write simulation data to file if requested
         updateTree();
@@ -128,7 +74,6 @@ int AbstractDenominatorDataRandomizer::RandomizeData(unsigned int iSimulation, c
         updateTree();
         if (_read_filename.size()) // add cumulated simulation data from previous look(s)
             totalSimC += readSequentialData(_read_filename, iSimulation, treeNodes, treeSimNodes, mutex);
-        boost::mutex::scoped_lock writelock(mutex);
         _sim_stream_writer->writeSequenceData(iSimulation, treeSimNodes, _restricted_levels, _scanner.getSequentialTreeNodesToWrite());
     } else { // else standard randomization
         totalSimC = randomize(iSimulation, NodesProxy(treeNodes, _parameters.getDataOnlyOnLeaves(), _parameters.getProbability()), treeSimNodes);
@@ -140,6 +85,8 @@ int AbstractDenominatorDataRandomizer::RandomizeData(unsigned int iSimulation, c
 
 /** Reads simulation data from file. */
 int AbstractDenominatorDataRandomizer::read(const std::string& filename, unsigned int simulation, const ScanRunner::NodeStructureContainer_t& treeNodes, SimNodeContainer_t& treeSimNodes, boost::mutex& mutex) {
+    if (_sim_data_reader) return readBinary(simulation, treeSimNodes);
+    if (!_sim_stream_reader) _sim_stream_reader.reset(new FileStreamReadManager(filename)); // only sequential scans create the reader up front
     FileStreamReadManager::SharedStream_t _sim_stream = _sim_stream_reader->getStream(this, mutex);
     // seek line offset from current simulation row to this simulation
     while (_sim_position < simulation) {
@@ -159,6 +106,19 @@ int AbstractDenominatorDataRandomizer::read(const std::string& filename, unsigne
     return total_sim;
 }
 
+/** Reads simulation data from the memory mapped binary simulation data file. */
+int AbstractDenominatorDataRandomizer::readBinary(unsigned int simulation, SimNodeContainer_t& treeSimNodes) const {
+    const std::int32_t * record = _sim_data_reader->getIntegers(simulation, treeSimNodes.size(), 1);
+    int total_sim = 0;
+    for (size_t i=0; i < treeSimNodes.size(); ++i) {
+        auto& node = treeSimNodes[i];
+        node.refIntC() += record[i];
+        node.refBrC() = 0;
+        total_sim += record[i];
+    }
+    return total_sim;
+}
+
 /** Reads sequential simulation data from file. */
 int AbstractDenominatorDataRandomizer::readSequentialData(const std::string& filename, unsigned int simulation, const ScanRunner::NodeStructureContainer_t& treeNodes, SimNodeContainer_t& treeSimNodes, boost::mutex& mutex) {
     FileStreamReadManager::SharedStream_t _sim_stream = _sim_stream_reader->getStream(this, mutex);
@@ -194,21 +154,21 @@ void AbstractDenominatorDataRandomizer::sequentialSetup(const ScanRunner& scanne
         }
 		_write_filename = scanner.getSequentialStatistic().getWriteSimulationDataFilename();
 		// Create new OrderedSimulationDataWriter in explicit constructor. Since it's a shared pointer, clones will share this class.
-		_sim_stream_writer.reset(new OrderedSimulationDataWriter(_write_filename, scanner.getParameters().getNumReplicationsRequested()));
+		_sim_stream_writer.reset(new OrderedSimulationDataWriter(_write_filename));
 		// Create new FileStreamReadManager in explicit constructor. Since it's a shared pointer, clones will share this class.
 		_sim_stream_reader.reset(new FileStreamReadManager(_read_filename));
 	}
 }
 
-/** Writes simulation data to file. */
-void AbstractDenominatorDataRandomizer::write(const std::string& filename, const SimNodeContainer_t& treeSimNodes) {
-    std::ofstream stream;
-
-    //open output file
-    stream.open(filename.c_str(), std::ios::ate|std::ios::app);
-    if (!stream) throw resolvable_error("Error: Could not open the simulated data output file '%s'.\n", filename.c_str());
+/** Formats simulation data for the simulated data file -- a line per simulation. */
+void AbstractDenominatorDataRandomizer::formatSimulationData(const SimNodeContainer_t& treeSimNodes, std::string& record) const {
     for (auto& node: treeSimNodes)
-        stream << node.getIntC() << " ";
-    stream << std::endl;
-    stream.close();
+        AsynchronousOrderedWriter::append(record, node.getIntC()) += ' ';
+    record += '\n';
+}
+
+/** Writes any simulation data still queued, including the sequential scan data, throwing if writing failed. */
+void AbstractDenominatorDataRandomizer::closeWriting() {
+    AbstractRandomizer::closeWriting();
+    if (_sim_stream_writer) _sim_stream_writer->close();
 }
@@ -4,24 +4,18 @@
 //******************************************************************************
 #include "Randomization.h"
 
-/** Class which ensures that simulation data is written to file in ordinal sequence (sim 1, sim 2, sim 3, etc.). 
-    Class objects which are stream derivatives are allocated with shared pointers to facilitate randomizer clone. */
+/** Class which ensures that simulation data is written to file in ordinal sequence (sim 1, sim 2, sim 3, etc.).
+    Allocated with a shared pointer to facilitate randomizer clone, so that clones share the file's writer. */
 class OrderedSimulationDataWriter {
     protected:
-        typedef std::shared_ptr<std::stringstream> CacheStream_t;
-        typedef std::pair<unsigned int, CacheStream_t> CacheStreamPair_t;
-        typedef std::vector<CacheStreamPair_t> CacheStreamContainer_t;
-
-        unsigned int _sim_position;
-        unsigned int _num_simulations;
-        std::shared_ptr<std::ofstream> _sim_stream;
-        CacheStreamContainer_t _sim_stream_cache;
+        AsynchronousOrderedWriter _writer;
 
     public:
-        OrderedSimulationDataWriter(const std::string& filename, unsigned int num_simulations);
+        OrderedSimulationDataWriter(const std::string& filename) : _writer(filename, std::ios::ate | std::ios::app) {}
 
         void write(unsigned int simulation, const SimNodeContainer_t& treeSimNodes);
         void writeSequenceData(unsigned int simulation, const SimNodeContainer_t& treeSimNodes, const boost::dynamic_bitset<>& _restricted_levels, const boost::dynamic_bitset<>& writeNodes);
+        void close() { _writer.close(); }
 };
 
 /** Class which manages a std::ifstream associated with a randomizer object. This object can be shared by randomizer objects. */
@@ -60,15 +54,17 @@ class AbstractDenominatorDataRandomizer : public AbstractRandomizer {
         boost::dynamic_bitset<> _restricted_levels;
 
         virtual int read(const std::string& filename, unsigned int simulation, const ScanRunner::NodeStructureContainer_t& treeNodes, SimNodeContainer_t& treeSimNodes, boost::mutex& mutex);
+        int readBinary(unsigned int simulation, SimNodeContainer_t& treeSimNodes) const;
         int readSequentialData(const std::string& filename, unsigned int simulation, const ScanRunner::NodeStructureContainer_t& treeNodes, SimNodeContainer_t& treeSimNodes, boost::mutex& mutex);
 	    void sequentialSetup(const ScanRunner& scanner);
-        virtual void write(const std::string& filename, const SimNodeContainer_t& treeSimNodes);
+        virtual void formatSimulationData(const SimNodeContainer_t& treeSimNodes, std::string& record) const;
 
     public:
         AbstractDenominatorDataRandomizer(const ScanRunner& scanner, long lInitialSeed = RandomNumberGenerator::glDefaultSeed);
         virtual ~AbstractDenominatorDataRandomizer() {}
 
         virtual int RandomizeData(unsigned int iSimulation, const ScanRunner::NodeStructureContainer_t& treeNodes, boost::mutex& mutex, SimNodeContainer_t& treeSimNodes);
+        virtual void closeWriting();
 };
 //******************************************************************************
 #endif
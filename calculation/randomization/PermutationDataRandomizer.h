@@ -128,5 +128,71 @@ void AbstractPermutedDataRandomizer<S, P>::SortPermutedAttribute(RandomNumberGen
         std::sort(itr->begin(), itr->end(), ComparePermutedAttribute<P>());
     }
 }
+
+// ******************************************************************************************************
+
+/** Stationary and permuted attributes of a permuted randomization held in compact parallel arrays, grouped (e.g. by week day) such
+    that permuted attributes are only exchanged within a group. A replica permutes in place, without allocation, from the original
+    order: in linear time by Fisher-Yates shuffle or, in seed compatible mode, by sorting on a random float per attribute -- drawing
+    the same random numbers and producing the same permutation as AbstractPermutedDataRandomizer::SortPermutedAttribute(). */
+template <class S, class P>
+class PermutedDataArrays {
+    public:
+        typedef std::pair<float, P> KeyedAttribute_t;
+
+    protected:
+        bool                            _seed_compatible;
+        std::vector<S>                  _stationary;
+        std::vector<P>                  _original;          // permuted attributes in original order
+        std::vector<P>                  _permuted;
+        std::vector<size_t>             _group_ends;        // end offset of each group
+        std::vector<KeyedAttribute_t>   _keyed;             // seed compatible mode -- attributes of a group keyed by random float
+
+    public:
+        PermutedDataArrays(bool seed_compatible) : _seed_compatible(seed_compatible) {}
+
+        /** Adds stationary/permuted pair to the current group. */
+        void add(const S& stationary, const P& permuted) {
+            _stationary.push_back(stationary);
+            _original.push_back(permuted);
+        }
+        /** Closes the current group; pairs added afterwards belong to the next group. */
+        void endGroup() {
+            _group_ends.push_back(_original.size());
+            _permuted.resize(_original.size());
+            size_t group_size = _group_ends.back() - (_group_ends.size() > 1 ? _group_ends[_group_ends.size() - 2] : 0);
+            if (_seed_compatible && _keyed.size() < group_size) _keyed.resize(group_size);
+        }
+
+        size_t size() const {return _stationary.size();}
+        const S * getStationary() const {return _stationary.data();}
+        const P * getPermuted() const {return _permuted.data();}
+
+        void permute(RandomNumberGenerator& rng);
+};
+
+/** Permutes the permuted attributes within each group, starting from the original order so that the permutation depends only on
+    the state of 'rng' -- as needed for consistent output when running in parallel. */
+template <class S, class P>
+void PermutedDataArrays<S, P>::permute(RandomNumberGenerator& rng) {
+    size_t begin = 0;
+    for (size_t end : _group_ends) {
+        if (_seed_compatible) {
+            for (size_t i=begin; i < end; ++i)
+                _keyed[i - begin] = KeyedAttribute_t(rng.GetRandomFloat(), _original[i]);
+            // compare on keys only -- std::sort then orders as it does the PermutedAttribute objects
+            std::sort(_keyed.begin(), _keyed.begin() + (end - begin), [](const KeyedAttribute_t& lhs, const KeyedAttribute_t& rhs) { return lhs.first < rhs.first; });
+            for (size_t i=begin; i < end; ++i)
+                _permuted[i] = _keyed[i - begin].second;
+        } else {
+            std::copy(_original.begin() + begin, _original.begin() + end, _permuted.begin() + begin);
+            for (size_t i=end - begin; i > 1; --i) {
+                size_t j = std::min(static_cast<size_t>(static_cast<double>(i) * rng.GetRandomDouble()), i - 1);
+                std::swap(_permuted[begin + i - 1], _permuted[begin + j]);
+            }
+        }
+        begin = end;
+    }
+}
 //******************************************************************************
 #endif
@@ -7,7 +7,8 @@
 /** Constructor */
 PoissonRandomizer::PoissonRandomizer(bool conditional, const ScanRunner& scanner, long lInitialSeed)
                   : AbstractDenominatorDataRandomizer(scanner, lInitialSeed), 
-	               _conditional(conditional), _total_C(scanner.getTotalC()), _total_N(scanner.getTotalN()) {
+	               _conditional(conditional), _total_C(scanner.getTotalC()), _total_N(scanner.getTotalN()),
+                   _rejection_sampling(scanner.getParameters().getSamplerType() == Parameters::REJECTION_SAMPLER) {
 	sequentialSetup(_scanner);
 }
 
@@ -17,12 +18,16 @@ int PoissonRandomizer::randomize(unsigned int iSimulation, const AbstractNodesPr
     // reset seed of random number generator
     setSeed(iSimulation);
     // reset simData
-    std::for_each(treeSimNodes.begin(), treeSimNodes.end(), std::mem_fn(&SimulationNode::clear));
+    treeSimNodes.reset();
 
     //-------------------- GENERATING THE RANDOM DATA ------------------------------
     int cases, CasesLeft, TotalSimC;
     double  ExpectedLeft;
 
+    if (_rejection_sampling) {
+        _poisson_samplers.resize(treeNodes.size());
+        _binomial_samplers.resize(treeNodes.size());
+    }
     if (_conditional) {
         TotalSimC = _parameters.isSequentialScanPoisson() ? _scanner.getTotalsFromLook().first : _total_C;
         CasesLeft = TotalSimC;
@@ -30,7 +35,11 @@ int PoissonRandomizer::randomize(unsigned int iSimulation, const AbstractNodesPr
         for (size_t i=0; i < treeNodes.size(); i++) {
             treeSimNodes[i].refBrC() = 0; // initializing the branch cases with zero
             if (!treeNodes.randomized(i)) continue; // skip if not randomized
-            cases = BinomialGenerator(CasesLeft, treeNodes.getIntN(i) / ExpectedLeft);
+            _random_number_generator.SetStream(static_cast<unsigned int>(i)); // each node draws from its own stream, if counter-based
+            if (_rejection_sampling)
+                cases = static_cast<int>(_binomial_samplers[i].sample(CasesLeft, treeNodes.getIntN(i) / ExpectedLeft, _random_number_generator));
+            else
+                cases = BinomialGenerator(CasesLeft, treeNodes.getIntN(i) / ExpectedLeft);
             treeSimNodes[i].refIntC() = cases; // treeNodes.at(i)->_SimIntC = cases;
             CasesLeft -= cases;
             ExpectedLeft -= treeNodes.getIntN(i);
@@ -40,7 +49,11 @@ int PoissonRandomizer::randomize(unsigned int iSimulation, const AbstractNodesPr
         for(size_t i=0; i < treeNodes.size(); i++) {
             treeSimNodes[i].refBrC() = 0; // initializing the branch cases with zero
             if (!treeNodes.randomized(i)) continue; // skip if not randomized
-            cases = PoissonGenerator(treeNodes.getIntN(i));
+            _random_number_generator.SetStream(static_cast<unsigned int>(i)); // each node draws from its own stream, if counter-based
+            if (_rejection_sampling)
+                cases = static_cast<int>(_poisson_samplers[i].sample(treeNodes.getIntN(i), _random_number_generator));
+            else
+                cases = PoissonGenerator(treeNodes.getIntN(i));
             treeSimNodes[i].refIntC() = cases; // treeNodes.at(i)->_SimIntC=cases;
             TotalSimC += cases;
         }
@@ -3,6 +3,7 @@
 #define __PoissonRandomizer_H
 //******************************************************************************
 #include "DenominatorDataRandomizer.h"
+#include "RandomSampler.h"
 #include <boost/cast.hpp>
 
 /** Data randomizer for conditional and unconditional tree scan. */
@@ -11,6 +12,9 @@ class PoissonRandomizer : public AbstractDenominatorDataRandomizer {
         bool            _conditional;
         int             _total_C;
         double          _total_N;
+        bool            _rejection_sampling;                // whether sampling with the transformed rejection samplers
+        std::vector<PoissonSampler>  _poisson_samplers;     // per node samplers, retaining constants across simulations
+        std::vector<BinomialSampler> _binomial_samplers;
 
         int             BinomialGenerator(int n, double p);
         int             PoissonGenerator(double lambda);
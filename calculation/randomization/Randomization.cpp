@@ -8,6 +8,245 @@
 #include "TemporalRandomizer.h"
 #include "SignedRankRandomizer.h"
 
+/** Constructs store with a node for each tree node, allocating the data for all nodes at once. Tree nodes with fewer than 'sparse_limit'
+    branch cases are stored as sparse series, sized by their case counts in the real data. */
+SimulationNodeStore::SimulationNodeStore(const ScanRunner::NodeStructureContainer_t& treeNodes, size_t intervals, unsigned int sample_sites, Layout layout, NodeStructure::count_t sparse_limit)
+    : _layout(layout), _intervals(intervals), _sample_sites(sample_sites), _rows(0) {
+    _nodes.reserve(treeNodes.size());
+    for (auto node : treeNodes) {
+        if (node->getBrC() < sparse_limit) {
+            SparseSeries series;
+            series._int_begin = _IntC_T.size();
+            series._int_capacity = static_cast<size_t>(node->getIntC());
+            series._br_begin = _BrC_T.size();
+            series._br_capacity = static_cast<size_t>(node->getBrC());
+            series._int_size = series._br_size = 0;
+            _IntC_T.resize(_IntC_T.size() + series._int_capacity);
+            _BrC_T.resize(_BrC_T.size() + series._br_capacity);
+            _nodes.push_back(SimulationNode(*this, _nodes.size(), node->getLevel(), true, _sparse_series.size()));
+            _sparse_series.push_back(series);
+        } else
+            _nodes.push_back(SimulationNode(*this, _nodes.size(), node->getLevel(), false, _rows++));
+    }
+    _IntC_C.resize(_rows * _intervals, 0);
+    _BrC_C.resize(_rows * _intervals, 0);
+    if (!_sparse_series.empty()) _sparse_counts.resize(_intervals, 0);
+    _sample_site_differences.resize(treeNodes.size() * _sample_sites, 0.0);
+    _Br_sample_site_differences.resize(treeNodes.size() * _sample_sites, 0.0);
+}
+
+SimulationNodeStore::SimulationNodeStore(const SimulationNodeStore& other)
+    : _layout(other._layout), _intervals(other._intervals), _sample_sites(other._sample_sites), _rows(other._rows), _IntC_C(other._IntC_C), _BrC_C(other._BrC_C),
+      _sample_site_differences(other._sample_site_differences), _Br_sample_site_differences(other._Br_sample_site_differences), _nodes(other._nodes),
+      _sparse_series(other._sparse_series), _IntC_T(other._IntC_T), _BrC_T(other._BrC_T), _sparse_counts(other._sparse_counts) {
+    rebind();
+}
+
+SimulationNodeStore::SimulationNodeStore(SimulationNodeStore&& other)
+    : _layout(other._layout), _intervals(other._intervals), _sample_sites(other._sample_sites), _rows(other._rows), _IntC_C(std::move(other._IntC_C)), _BrC_C(std::move(other._BrC_C)),
+      _sample_site_differences(std::move(other._sample_site_differences)), _Br_sample_site_differences(std::move(other._Br_sample_site_differences)), _nodes(std::move(other._nodes)),
+      _sparse_series(std::move(other._sparse_series)), _IntC_T(std::move(other._IntC_T)), _BrC_T(std::move(other._BrC_T)), _sparse_counts(std::move(other._sparse_counts)) {
+    rebind();
+}
+
+SimulationNodeStore & SimulationNodeStore::operator=(const SimulationNodeStore& other) {
+    if (this != &other) {
+        _layout = other._layout;
+        _intervals = other._intervals;
+        _sample_sites = other._sample_sites;
+        _rows = other._rows;
+        _IntC_C = other._IntC_C;
+        _BrC_C = other._BrC_C;
+        _sample_site_differences = other._sample_site_differences;
+        _Br_sample_site_differences = other._Br_sample_site_differences;
+        _nodes = other._nodes;
+        _sparse_series = other._sparse_series;
+        _IntC_T = other._IntC_T;
+        _BrC_T = other._BrC_T;
+        _sparse_counts = other._sparse_counts;
+        rebind();
+    }
+    return *this;
+}
+
+SimulationNodeStore & SimulationNodeStore::operator=(SimulationNodeStore&& other) {
+    if (this != &other) {
+        _layout = other._layout;
+        _intervals = other._intervals;
+        _sample_sites = other._sample_sites;
+        _rows = other._rows;
+        _IntC_C = std::move(other._IntC_C);
+        _BrC_C = std::move(other._BrC_C);
+        _sample_site_differences = std::move(other._sample_site_differences);
+        _Br_sample_site_differences = std::move(other._Br_sample_site_differences);
+        _nodes = std::move(other._nodes);
+        _sparse_series = std::move(other._sparse_series);
+        _IntC_T = std::move(other._IntC_T);
+        _BrC_T = std::move(other._BrC_T);
+        _sparse_counts = std::move(other._sparse_counts);
+        rebind();
+    }
+    return *this;
+}
+
+/** Appends a dense node to the store. All nodes in a store share the same number of time intervals and sample sites. Appending
+    to a time-major store re-arranges the existing data, so prefer constructing the store from the tree nodes. */
+void SimulationNodeStore::emplace_back(size_t intervals, unsigned int level, unsigned int sample_sites) {
+    if (_nodes.empty()) {
+        _intervals = intervals;
+        _sample_sites = sample_sites;
+    } else if (intervals != _intervals || sample_sites != _sample_sites)
+        throw prg_error("Simulation node dimensions (%u, %u) do not match store dimensions (%u, %u).", "SimulationNodeStore::emplace_back()", intervals, sample_sites, _intervals, _sample_sites);
+    if (_layout == NODE_MAJOR) {
+        _IntC_C.resize(_IntC_C.size() + _intervals, 0);
+        _BrC_C.resize(_BrC_C.size() + _intervals, 0);
+    } else {
+        size_t nodes = _rows;
+        NodeStructure::CountContainer_t intC(_IntC_C.size() + _intervals, 0), brC(_BrC_C.size() + _intervals, 0);
+        for (size_t t=0; t < _intervals; ++t) {
+            std::copy(_IntC_C.begin() + t * nodes, _IntC_C.begin() + (t + 1) * nodes, intC.begin() + t * (nodes + 1));
+            std::copy(_BrC_C.begin() + t * nodes, _BrC_C.begin() + (t + 1) * nodes, brC.begin() + t * (nodes + 1));
+        }
+        _IntC_C.swap(intC);
+        _BrC_C.swap(brC);
+    }
+    _sample_site_differences.resize(_sample_site_differences.size() + _sample_sites, 0.0);
+    _Br_sample_site_differences.resize(_Br_sample_site_differences.size() + _sample_sites, 0.0);
+    _nodes.push_back(SimulationNode(*this, _nodes.size(), level, false, _rows++));
+}
+
+/** Reserves storage for the specified number of nodes, given the dimensions of nodes already in store. */
+void SimulationNodeStore::reserve(size_t nodes) {
+    _IntC_C.reserve(nodes * _intervals);
+    _BrC_C.reserve(nodes * _intervals);
+    _sample_site_differences.reserve(nodes * _sample_sites);
+    _Br_sample_site_differences.reserve(nodes * _sample_sites);
+    _nodes.reserve(nodes);
+}
+
+/** Zeros the simulated data of all nodes. */
+void SimulationNodeStore::reset() {
+    std::fill(_IntC_C.begin(), _IntC_C.end(), 0);
+    std::fill(_BrC_C.begin(), _BrC_C.end(), 0);
+    std::fill(_sample_site_differences.begin(), _sample_site_differences.end(), 0.0);
+    std::fill(_Br_sample_site_differences.begin(), _Br_sample_site_differences.end(), 0.0);
+    for (auto& series : _sparse_series)
+        series._int_size = series._br_size = 0;
+}
+
+/** Converts the count data of all nodes to cumulative, from the last time interval backward. The case times of sparse nodes are sorted. */
+void SimulationNodeStore::setCumulative() {
+    cumulative(_IntC_C);
+    cumulative(_BrC_C);
+    for (auto& node : _nodes)
+        if (node._sparse) node.setCumulative();
+}
+
+/** Sums node data into branch totals, as AbstractRandomizer::aggregate(), for a store holding sparse nodes. A sparse node collects the
+    case times of its sources; sparse sources of a dense node are counted by time interval then added cumulatively. */
+void SimulationNodeStore::aggregateSparse(const BranchAggregation& aggregation) {
+    const BranchAggregation::Indexes_t& sources = aggregation.getSources();
+    for (const auto& step: aggregation.getSteps()) {
+        SimulationNode& node = _nodes[step._node];
+        if (node._sparse) {
+            SparseSeries& series = _sparse_series[node._row];
+            CaseTimes_t::iterator begin = _BrC_T.begin() + series._br_begin, destination = begin, end = begin + series._br_capacity;
+            if (step._from_children) { // node's own cases plus the branch cases of its children
+                appendCases(node, false, destination, end);
+                for (size_t s=step._begin; s < step._end; ++s)
+                    appendCases(_nodes[sources[s]], true, destination, end);
+            } else { // node cases of each distinct descendant, node itself included
+                for (size_t s=step._begin; s < step._end; ++s)
+                    appendCases(_nodes[sources[s]], false, destination, end);
+            }
+            series._br_size = static_cast<size_t>(destination - begin);
+            std::sort(begin, destination);
+            continue;
+        }
+        SimulationNode::Counts_t target(node.refBrC_C());
+        bool sparse_sources = false;
+        if (step._from_children) {
+            SimulationNode::ConstCounts_t own(node.getIntC_C());
+            for (size_t t=0; t < target.size(); ++t) target[t] = own[t];
+            for (size_t s=step._begin; s < step._end; ++s) {
+                const SimulationNode& child = _nodes[sources[s]];
+                if (child._sparse) {
+                    addSparseCases(child, true);
+                    sparse_sources = true;
+                } else {
+                    SimulationNode::ConstCounts_t counts(child.getBrC_C());
+                    for (size_t t=0; t < target.size(); ++t) target[t] += counts[t];
+                }
+            }
+        } else {
+            std::fill(target.begin(), target.end(), 0);
+            for (size_t s=step._begin; s < step._end; ++s) {
+                const SimulationNode& descendant = _nodes[sources[s]];
+                if (descendant._sparse) {
+                    addSparseCases(descendant, false);
+                    sparse_sources = true;
+                } else {
+                    SimulationNode::ConstCounts_t counts(descendant.getIntC_C());
+                    for (size_t t=0; t < target.size(); ++t) target[t] += counts[t];
+                }
+            }
+        }
+        if (sparse_sources) {
+            TreeScan::cumulative_backward(_sparse_counts);
+            for (size_t t=0; t < target.size(); ++t) target[t] += _sparse_counts[t];
+            std::fill(_sparse_counts.begin(), _sparse_counts.end(), 0);
+        }
+    }
+}
+
+/* Copies the case times of node, either its own or its branch cases, to destination -- expanding the cumulative counts of a dense node. */
+void SimulationNodeStore::appendCases(const SimulationNode& node, bool branch, CaseTimes_t::iterator& destination, CaseTimes_t::iterator end) const {
+    size_t available = static_cast<size_t>(end - destination);
+    if (node._sparse) {
+        const SparseSeries& series = _sparse_series[node._row];
+        CaseTimes_t::const_iterator begin = branch ? _BrC_T.begin() + series._br_begin : _IntC_T.begin() + series._int_begin;
+        size_t count = branch ? series._br_size : series._int_size;
+        if (count > available)
+            throw prg_error("Sparse simulation node exceeds its cases, adding %u cases of node %u.", "SimulationNodeStore::appendCases()", count, node._index);
+        destination = std::copy(begin, begin + count, destination);
+        return;
+    }
+    SimulationNode::ConstCounts_t counts(branch ? node.getBrC_C() : node.getIntC_C());
+    if (static_cast<size_t>(counts[0]) > available)
+        throw prg_error("Sparse simulation node exceeds its cases, adding %u cases of node %u.", "SimulationNodeStore::appendCases()", counts[0], node._index);
+    for (size_t t=0; t < counts.size(); ++t) {
+        NodeStructure::count_t cases = counts[t] - (t + 1 < counts.size() ? counts[t + 1] : 0);
+        destination = std::fill_n(destination, cases, static_cast<unsigned int>(t));
+    }
+}
+
+/* Counts the case times of sparse node, either its own or its branch cases, by time interval in the scratch counts. */
+void SimulationNodeStore::addSparseCases(const SimulationNode& node, bool branch) {
+    const SparseSeries& series = _sparse_series[node._row];
+    CaseTimes_t::const_iterator itr = branch ? _BrC_T.begin() + series._br_begin : _IntC_T.begin() + series._int_begin;
+    CaseTimes_t::const_iterator itr_end = itr + (branch ? series._br_size : series._int_size);
+    for (; itr != itr_end; ++itr)
+        ++_sparse_counts[*itr];
+}
+
+void SimulationNodeStore::cumulative(NodeStructure::CountContainer_t& counts) {
+    if (_intervals < 2) return;
+    if (_layout == NODE_MAJOR) {
+        for (size_t offset=0; offset < counts.size(); offset += _intervals) {
+            for (size_t t=_intervals - 1; t > 0; --t)
+                counts[offset + t - 1] += counts[offset + t];
+        }
+    } else {
+        // sweep the rows of the matrix, each row adding the row of the following time interval
+        size_t nodes = _rows;
+        for (size_t t=_intervals - 1; t > 0; --t) {
+            NodeStructure::count_t * row = counts.data() + (t - 1) * nodes, * next = counts.data() + t * nodes;
+            for (size_t n=0; n < nodes; ++n)
+                row[n] += next[n];
+        }
+    }
+}
+
 /** Returns new randomizer object given parameter settings. */
 AbstractRandomizer * AbstractRandomizer::getNewRandomizer(const ScanRunner& scanner) {
     const Parameters& parameters = scanner.getParameters();
@@ -64,33 +303,60 @@ AbstractRandomizer * AbstractRandomizer::getNewRandomizer(const ScanRunner& scan
     }
 }
 
-/** Adds simulated cases up the tree from node/leaf to all its parents, and so on, for a node without anforlust. */
-void AbstractRandomizer::addSimC_C(size_t source_id, size_t target_id, const NodeStructure::CountContainer_t& c, SimNodeContainer_t& treeSimNodes, const ScanRunner::NodeStructureContainer_t& treeNodes) {
-    if (_multiparents)
-        _addSimC_C_ancestor_list(source_id, c, treeSimNodes, treeNodes);
-    else
-        _addSimC_C_recursive(target_id, c, treeNodes, treeSimNodes);
+/** Adds simulated cases of each node up the tree into the branch totals of the node and all its ancestors. */
+void AbstractRandomizer::addSimC_C(SimNodeContainer_t& treeSimNodes) const {
+    if (treeSimNodes.hasSparseNodes()) {
+        treeSimNodes.aggregateSparse(_branch_aggregation);
+        return;
+    }
+    aggregate(treeSimNodes, [](SimulationNode& node) { return node.getIntC_C(); }, [](SimulationNode& node) { return node.refBrC_C(); });
 }
 
-/** Adds simulated cases up the tree from node/leaf to all its parents, and so on, for a node without anforlust. */
-void AbstractRandomizer::_addSimC_C_ancestor_list(size_t source_id, const NodeStructure::CountContainer_t& c, SimNodeContainer_t& treeSimNodes, const ScanRunner::NodeStructureContainer_t& treeNodes) {
-    const NodeStructure * node = treeNodes[source_id];
-    for (NodeStructure::Ancestors_t::const_iterator itr=node->getAncestors().begin(); itr != node->getAncestors().end(); ++itr) {
-        // add source node's data to destination nodes branch totals
-        std::transform(c.begin(), c.end(), treeSimNodes.at(*itr).refBrC_C().begin(), treeSimNodes.at(*itr).refBrC_C().begin(), std::plus<int>());
-    }
+/** Sets randomizer to read simulation data from file. A binary simulation data file is memory mapped once here and shared by the clones
+    of this randomizer, which then read its records without locking. */
+void AbstractRandomizer::setReading(const std::string& s) {
+    _read_filename = s;
+    _read_data = true;
+    _sim_data_reader.reset(SimulationDataFile::isBinary(s) ? new SimulationDataFileReader(s) : 0);
+}
+
+/** Sets randomizer to write simulation data to file. The file is written by one writer, shared by the clones of this randomizer,
+    which writes simulations in order on its own thread. */
+void AbstractRandomizer::setWriting(const std::string& s) {
+    _write_filename = s;
+    _write_data = true;
+    _sim_data_writer.reset(new AsynchronousOrderedWriter(s, std::ios::ate|std::ios::app));
 }
 
-/** Adds simulated cases up the tree from node/leaf to all its parents, and so on, for a node without anforlust. */
-void AbstractRandomizer::_addSimC_C_recursive(size_t id, const NodeStructure::CountContainer_t& c, const ScanRunner::NodeStructureContainer_t& treeNodes, SimNodeContainer_t& treeSimNodes) {
-    std::transform(c.begin(), c.end(), treeSimNodes[id].refBrC_C().begin(), treeSimNodes[id].refBrC_C().begin(), std::plus<int>());
-    for(size_t j=0; j < treeNodes[id]->getParents().size(); ++j) 
-        _addSimC_C_recursive(treeNodes[id]->getParents()[j].first->getID(), c, treeNodes, treeSimNodes);
+/** Writes any simulation data still queued, throwing if writing failed. */
+void AbstractRandomizer::closeWriting() {
+    if (_sim_data_writer) _sim_data_writer->close();
+}
+
+/** Queues simulation data of 'simulation' for writing -- formatted by this thread, written to file by the writer's thread. */
+void AbstractRandomizer::write(unsigned int simulation, const SimNodeContainer_t& treeSimNodes) {
+    std::string record;
+    formatSimulationData(treeSimNodes, record);
+    _sim_data_writer->write(simulation, std::move(record));
+}
+
+/** Returns the random number generator engine selected in parameters. */
+RandomNumberGenerator::EngineType AbstractRandomizer::getEngineType(const Parameters& parameters) {
+    switch (parameters.getRandomNumberGeneratorType()) {
+        case Parameters::LEHMER_RNG: return RandomNumberGenerator::LEHMER;
+        case Parameters::PHILOX_RNG: return RandomNumberGenerator::PHILOX;
+        default: throw prg_error("Unknown random number generator type (%d).", "getEngineType()", parameters.getRandomNumberGeneratorType());
+    }
 }
 
 /** Reset seed of randomizer for particular simulation index. */
 void AbstractRandomizer::setSeed(unsigned int iSimulationIndex) {
     try {
+        if (_random_number_generator.IsCounterBased()) {
+            // counter-based generator is keyed on the initial seed and simulation index -- there is no limit to check
+            _random_number_generator.SetSeedOffset(iSimulationIndex);
+            return;
+        }
         // calculate seed as unsigned long
         unsigned long ulSeed = _random_number_generator.GetInitialSeed() + iSimulationIndex;
         // compare to max seed (declared as positive signed long)
@@ -6,55 +6,287 @@
 #include "RandomDistribution.h"
 #include "ScanRunner.h"
 #include "RelativeRiskAdjustment.h"
+#include "SimulationDataFile.h"
+#include "AsynchronousOrderedWriter.h"
 #include "PrjException.h"
 #include "boost/thread/mutex.hpp"
+#include <boost/iterator/iterator_facade.hpp>
+#include <initializer_list>
+#include <algorithm>
 
-/** A class to contain simulated data for a node. */
+/** A strided view over one node's portion of the simulation data held in a SimulationNodeStore.
+    The view does not own its data and is invalidated when the store it references is resized. */
+template <typename T> class SimulationDataSlice {
+    public:
+        typedef typename std::remove_const<T>::type value_type;
+
+        /** Random access iterator which steps through the slice with the stride of the store layout. */
+        class iterator : public boost::iterator_facade<iterator, T, boost::random_access_traversal_tag> {
+            friend class boost::iterator_core_access;
+
+            private:
+                T * _base;
+                std::ptrdiff_t _position;
+                std::ptrdiff_t _stride;
+
+                T & dereference() const { return _base[_position * _stride]; }
+                bool equal(const iterator& other) const { return _position == other._position; }
+                void increment() { ++_position; }
+                void decrement() { --_position; }
+                void advance(std::ptrdiff_t n) { _position += n; }
+                std::ptrdiff_t distance_to(const iterator& other) const { return other._position - _position; }
+
+            public:
+                iterator() : _base(0), _position(0), _stride(1) {}
+                iterator(T * base, std::ptrdiff_t position, std::ptrdiff_t stride) : _base(base), _position(position), _stride(stride) {}
+        };
+        typedef iterator const_iterator;
+        typedef std::reverse_iterator<iterator> reverse_iterator;
+
+    private:
+        T * _data;
+        size_t _size;
+        size_t _stride;
+
+    public:
+        SimulationDataSlice(T * data, size_t size, size_t stride=1) : _data(data), _size(size), _stride(stride) {}
+        SimulationDataSlice(const std::vector<value_type>& v) : _data(v.data()), _size(v.size()), _stride(1) {}
+        template <typename U> SimulationDataSlice(const SimulationDataSlice<U>& other, typename std::enable_if<std::is_convertible<U*, T*>::value>::type* = 0)
+            : _data(other.data()), _size(other.size()), _stride(other.stride()) {}
+
+        /* Copies values into the viewed elements -- the number of values must match the size of the slice. */
+        SimulationDataSlice & operator=(const std::vector<value_type>& values) { assign(values.begin(), values.end(), values.size()); return *this; }
+        SimulationDataSlice & operator=(std::initializer_list<value_type> values) { assign(values.begin(), values.end(), values.size()); return *this; }
+        template <typename Itr> void assign(Itr first, Itr last, size_t count) {
+            if (count != _size)
+                throw prg_error("Unable to assign %u values to simulation data of size %u.", "SimulationDataSlice::assign()", count, _size);
+            std::copy(first, last, begin());
+        }
+
+        T                 * data() const { return _data; }
+        size_t              size() const { return _size; }
+        size_t              stride() const { return _stride; }
+        bool                empty() const { return _size == 0; }
+        T                 & operator[](size_t i) const { return _data[i * _stride]; }
+        T                 & front() const { return _data[0]; }
+        T                 & back() const { return _data[(_size - 1) * _stride]; }
+        iterator            begin() const { return iterator(_data, 0, static_cast<std::ptrdiff_t>(_stride)); }
+        iterator            end() const { return iterator(_data, static_cast<std::ptrdiff_t>(_size), static_cast<std::ptrdiff_t>(_stride)); }
+        reverse_iterator    rbegin() const { return reverse_iterator(end()); }
+        reverse_iterator    rend() const { return reverse_iterator(begin()); }
+};
+
+class SimulationNodeStore;
+
+/** A class to access the simulated data of a node. The data itself is held in contiguous arrays of the owning SimulationNodeStore.
+    A sparse node holds its cases as sorted time indexes rather than as cumulative counts -- the count slices of getIntC_C(),
+    getBrC_C(), refIntC_C() and refBrC_C() are only available for dense nodes, while addIntC(), getBrC_Window() and the totals
+    work with either representation. */
 class SimulationNode {
+    friend class SimulationNodeStore;
+
     public:
         typedef std::vector<double> SampleSiteDiff_t;
+        typedef SimulationDataSlice<NodeStructure::count_t> Counts_t;
+        typedef SimulationDataSlice<const NodeStructure::count_t> ConstCounts_t;
+        typedef SimulationDataSlice<double> Differences_t;
+        typedef SimulationDataSlice<const double> ConstDifferences_t;
+
     private:
+        SimulationNodeStore * _store;
+        size_t _index;
+        unsigned int _level;
+        bool _sparse;
+        size_t _row;    // row of node in the dense count matrices or, for a sparse node, index of its sparse series
+
+        SimulationNode(SimulationNodeStore& store, size_t index, unsigned int level, bool sparse, size_t row)
+            : _store(&store), _index(index), _level(level), _sparse(sparse), _row(row) {}
+
+    public:
+        inline void clear();
+        inline void setCumulative();
+        inline void addIntC(size_t interval);
+        inline void addIntC(size_t interval, NodeStructure::count_t cases);
+
+        unsigned int                               getLevel() const { return _level; }
+        bool                                       isSparse() const { return _sparse; }
+        inline NodeStructure::count_t              getIntC() const;
+        inline ConstCounts_t                       getIntC_C() const;
+        inline NodeStructure::count_t              getBrC() const;
+        inline ConstCounts_t                       getBrC_C() const;
+        inline NodeStructure::count_t              getBrC_Window(size_t start, size_t end) const;
+        inline void                                copyBrC_C(NodeStructure::count_t * cumulative) const;
+        inline ConstDifferences_t                  getSampleSiteDifferences() const;
+        inline ConstDifferences_t                  getSampleSiteDifferencesBr() const;
+
+        inline NodeStructure::count_t            & refIntC();
+        inline Counts_t                            refIntC_C();
+        inline NodeStructure::count_t            & refBrC();
+        inline Counts_t                            refBrC_C();
+        inline Differences_t                       refSampleSiteDifferences();
+        inline Differences_t                       refSampleSiteDifferencesBr();
+};
+
+/** Contiguous store of the simulated data for all nodes of the tree. Each field is kept in a single flat matrix, either
+    node-major (a node's time intervals are adjacent) or time-major (a time interval's nodes are adjacent), so that clearing
+    the data between replications is a single fill and scanning the data streams linearly through memory. Sample-site
+    differences are always stored node-major. Each thread owns its own store.
+
+    Since a dense node takes the full length of the data time range, the store can instead hold nodes with few cases as sparse
+    series: the sorted time indexes of the node's cases and of its branch cases, with room reserved for the number of cases the
+    node has in the real data. This suits randomizations that condition on the node, where simulated counts equal real counts. */
+class SimulationNodeStore {
+    friend class SimulationNode;
+
+    public:
+        enum Layout { NODE_MAJOR=0, TIME_MAJOR };
+        typedef std::vector<SimulationNode>::iterator iterator;
+        typedef std::vector<SimulationNode>::const_iterator const_iterator;
+
+    private:
+        typedef std::vector<unsigned int> CaseTimes_t;
+        struct SparseSeries {
+            size_t _int_begin, _int_capacity, _int_size;
+            size_t _br_begin, _br_capacity, _br_size;
+        };
+
+        Layout _layout;
+        size_t _intervals;
+        size_t _sample_sites;
+        size_t _rows;
         NodeStructure::CountContainer_t _IntC_C;
         NodeStructure::CountContainer_t _BrC_C;
-        SampleSiteDiff_t _sample_site_differences;
-        SampleSiteDiff_t _Br_sample_site_differences;
-        unsigned int _level;
+        SimulationNode::SampleSiteDiff_t _sample_site_differences;
+        SimulationNode::SampleSiteDiff_t _Br_sample_site_differences;
+        std::vector<SimulationNode> _nodes;
+        std::vector<SparseSeries> _sparse_series;
+        CaseTimes_t _IntC_T;
+        CaseTimes_t _BrC_T;
+        NodeStructure::CountContainer_t _sparse_counts; // scratch counts used to add sparse series into dense nodes
+
+        void rebind() { for (auto& node : _nodes) node._store = this; }
+        size_t countOffset(size_t row) const { return _layout == NODE_MAJOR ? row * _intervals : row; }
+        size_t countStride() const { return _layout == NODE_MAJOR ? 1 : _rows; }
+        void cumulative(NodeStructure::CountContainer_t& counts);
+        void appendCases(const SimulationNode& node, bool branch, CaseTimes_t::iterator& destination, CaseTimes_t::iterator end) const;
+        void addSparseCases(const SimulationNode& node, bool branch);
 
     public:
-        SimulationNode(size_t container_size, unsigned int level, unsigned int sample_sites) : _level(level) {
-            _IntC_C.resize(container_size, 0);
-            _BrC_C.resize(container_size, 0);
-            if (sample_sites) _sample_site_differences.resize(sample_sites, 0.0);
-            if (sample_sites) _Br_sample_site_differences.resize(sample_sites, 0.0);
-        }
+        SimulationNodeStore(Layout layout=NODE_MAJOR) : _layout(layout), _intervals(0), _sample_sites(0), _rows(0) {}
+        SimulationNodeStore(const ScanRunner::NodeStructureContainer_t& treeNodes, size_t intervals, unsigned int sample_sites, Layout layout=NODE_MAJOR, NodeStructure::count_t sparse_limit=0);
+        SimulationNodeStore(const SimulationNodeStore& other);
+        SimulationNodeStore(SimulationNodeStore&& other);
+        SimulationNodeStore & operator=(const SimulationNodeStore& other);
+        SimulationNodeStore & operator=(SimulationNodeStore&& other);
 
-        void clear() {
-            std::fill(_IntC_C.begin(), _IntC_C.end(), 0);
-            std::fill(_BrC_C.begin(), _BrC_C.end(), 0);
-            std::fill(_sample_site_differences.begin(), _sample_site_differences.end(), 0.0);
-            std::fill(_Br_sample_site_differences.begin(), _Br_sample_site_differences.end(), 0.0);
-        }
-        void setCumulative() {
-            TreeScan::cumulative_backward(_IntC_C);
-            TreeScan::cumulative_backward(_BrC_C);
-        }
+        void                  emplace_back(size_t intervals, unsigned int level, unsigned int sample_sites);
+        void                  reserve(size_t nodes);
+        void                  reset();
+        void                  setCumulative();
+        void                  aggregateSparse(const BranchAggregation& aggregation);
 
-        unsigned int                               getLevel() const { return _level; }
-        NodeStructure::count_t                     getIntC() const {return _IntC_C.front();}
-        const NodeStructure::CountContainer_t    & getIntC_C() const {return _IntC_C;}
-        NodeStructure::count_t                     getBrC() const {return _BrC_C.front();}
-        const NodeStructure::CountContainer_t    & getBrC_C() const {return _BrC_C;}
-        const SampleSiteDiff_t& getSampleSiteDifferences() const { return _sample_site_differences; }
-        const SampleSiteDiff_t& getSampleSiteDifferencesBr() const { return _Br_sample_site_differences; }
-
-        NodeStructure::count_t                   & refIntC() {return _IntC_C.front();}
-        NodeStructure::CountContainer_t          & refIntC_C() {return _IntC_C;}
-        NodeStructure::count_t                   & refBrC() {return _BrC_C.front();}
-        NodeStructure::CountContainer_t          & refBrC_C() {return _BrC_C;}
-        SampleSiteDiff_t& refSampleSiteDifferences() { return _sample_site_differences; }
-        SampleSiteDiff_t& refSampleSiteDifferencesBr() { return _Br_sample_site_differences; }
+        Layout                getLayout() const { return _layout; }
+        bool                  hasSparseNodes() const { return !_sparse_series.empty(); }
+        size_t                getIntervals() const { return _intervals; }
+        size_t                getSampleSites() const { return _sample_sites; }
+        size_t                size() const { return _nodes.size(); }
+        bool                  empty() const { return _nodes.empty(); }
+        SimulationNode      & operator[](size_t i) { return _nodes[i]; }
+        const SimulationNode& operator[](size_t i) const { return _nodes[i]; }
+        SimulationNode      & at(size_t i) { return _nodes.at(i); }
+        const SimulationNode& at(size_t i) const { return _nodes.at(i); }
+        iterator              begin() { return _nodes.begin(); }
+        iterator              end() { return _nodes.end(); }
+        const_iterator        begin() const { return _nodes.begin(); }
+        const_iterator        end() const { return _nodes.end(); }
 };
 
+typedef SimulationNodeStore SimNodeContainer_t;
+
+inline void SimulationNode::clear() {
+    if (_sparse) {
+        _store->_sparse_series[_row]._int_size = _store->_sparse_series[_row]._br_size = 0;
+    } else {
+        std::fill(refIntC_C().begin(), refIntC_C().end(), 0);
+        std::fill(refBrC_C().begin(), refBrC_C().end(), 0);
+    }
+    std::fill(refSampleSiteDifferences().begin(), refSampleSiteDifferences().end(), 0.0);
+    std::fill(refSampleSiteDifferencesBr().begin(), refSampleSiteDifferencesBr().end(), 0.0);
+}
+inline void SimulationNode::setCumulative() {
+    if (_sparse) {
+        const SimulationNodeStore::SparseSeries& series = _store->_sparse_series[_row];
+        std::sort(_store->_IntC_T.begin() + series._int_begin, _store->_IntC_T.begin() + series._int_begin + series._int_size);
+        std::sort(_store->_BrC_T.begin() + series._br_begin, _store->_BrC_T.begin() + series._br_begin + series._br_size);
+        return;
+    }
+    Counts_t intC(refIntC_C()), brC(refBrC_C());
+    TreeScan::cumulative_backward(intC);
+    TreeScan::cumulative_backward(brC);
+}
+/* Adds a case to the node in the specified time interval -- prior to the data being made cumulative. */
+inline void SimulationNode::addIntC(size_t interval) {
+    if (!_sparse) {
+        ++(refIntC_C()[interval]);
+        return;
+    }
+    SimulationNodeStore::SparseSeries& series = _store->_sparse_series[_row];
+    if (series._int_size == series._int_capacity)
+        throw prg_error("Sparse simulation node %u exceeds its %u cases.", "SimulationNode::addIntC()", _index, series._int_capacity);
+    _store->_IntC_T[series._int_begin + series._int_size++] = static_cast<unsigned int>(interval);
+}
+inline void SimulationNode::addIntC(size_t interval, NodeStructure::count_t cases) {
+    if (!_sparse) {
+        refIntC_C()[interval] += cases;
+        return;
+    }
+    for (NodeStructure::count_t c=0; c < cases; ++c) addIntC(interval);
+}
+inline NodeStructure::count_t SimulationNode::getIntC() const {
+    return _sparse ? static_cast<NodeStructure::count_t>(_store->_sparse_series[_row]._int_size) : _store->_IntC_C[_store->countOffset(_row)];
+}
+inline SimulationNode::ConstCounts_t SimulationNode::getIntC_C() const { return ConstCounts_t(_store->_IntC_C.data() + _store->countOffset(_row), _store->_intervals, _store->countStride()); }
+inline NodeStructure::count_t SimulationNode::getBrC() const {
+    return _sparse ? static_cast<NodeStructure::count_t>(_store->_sparse_series[_row]._br_size) : _store->_BrC_C[_store->countOffset(_row)];
+}
+inline SimulationNode::ConstCounts_t SimulationNode::getBrC_C() const { return ConstCounts_t(_store->_BrC_C.data() + _store->countOffset(_row), _store->_intervals, _store->countStride()); }
+/* Copies the cumulative branch counts, one per time interval, to 'cumulative' -- expanding the case times of a sparse node. */
+inline void SimulationNode::copyBrC_C(NodeStructure::count_t * cumulative) const {
+    if (!_sparse) {
+        ConstCounts_t counts(getBrC_C());
+        std::copy(counts.begin(), counts.end(), cumulative);
+        return;
+    }
+    size_t intervals = _store->_intervals;
+    const SimulationNodeStore::SparseSeries& series = _store->_sparse_series[_row];
+    std::fill(cumulative, cumulative + intervals, 0);
+    for (size_t c=0; c < series._br_size; ++c)
+        ++cumulative[_store->_BrC_T[series._br_begin + c]];
+    for (size_t t=intervals; t > 1; --t)
+        cumulative[t - 2] += cumulative[t - 1];
+}
+/* Returns the number of branch cases in time intervals [start, end], once the data is cumulative. The interval following 'end' must
+   be within the data time range, as with reading the cumulative counts directly. */
+inline NodeStructure::count_t SimulationNode::getBrC_Window(size_t start, size_t end) const {
+    if (!_sparse) {
+        const NodeStructure::count_t * counts = _store->_BrC_C.data() + _store->countOffset(_row);
+        size_t stride = _store->countStride();
+        return counts[start * stride] - counts[(end + 1) * stride];
+    }
+    const SimulationNodeStore::SparseSeries& series = _store->_sparse_series[_row];
+    SimulationNodeStore::CaseTimes_t::const_iterator begin = _store->_BrC_T.begin() + series._br_begin, last = begin + series._br_size;
+    begin = std::lower_bound(begin, last, static_cast<unsigned int>(start));
+    return static_cast<NodeStructure::count_t>(std::upper_bound(begin, last, static_cast<unsigned int>(end)) - begin);
+}
+inline SimulationNode::ConstDifferences_t SimulationNode::getSampleSiteDifferences() const { return ConstDifferences_t(_store->_sample_site_differences.data() + _index * _store->_sample_sites, _store->_sample_sites); }
+inline SimulationNode::ConstDifferences_t SimulationNode::getSampleSiteDifferencesBr() const { return ConstDifferences_t(_store->_Br_sample_site_differences.data() + _index * _store->_sample_sites, _store->_sample_sites); }
+inline NodeStructure::count_t & SimulationNode::refIntC() { return _store->_IntC_C[_store->countOffset(_row)]; }
+inline SimulationNode::Counts_t SimulationNode::refIntC_C() { return Counts_t(_store->_IntC_C.data() + _store->countOffset(_row), _store->_intervals, _store->countStride()); }
+inline NodeStructure::count_t & SimulationNode::refBrC() { return _store->_BrC_C[_store->countOffset(_row)]; }
+inline SimulationNode::Counts_t SimulationNode::refBrC_C() { return Counts_t(_store->_BrC_C.data() + _store->countOffset(_row), _store->_intervals, _store->countStride()); }
+inline SimulationNode::Differences_t SimulationNode::refSampleSiteDifferences() { return Differences_t(_store->_sample_site_differences.data() + _index * _store->_sample_sites, _store->_sample_sites); }
+inline SimulationNode::Differences_t SimulationNode::refSampleSiteDifferencesBr() { return Differences_t(_store->_Br_sample_site_differences.data() + _index * _store->_sample_sites, _store->_sample_sites); }
+
 /** An abtract base class to define api used to access tree nodes during randomization. */
 class AbstractNodesProxy {
     protected:
@@ -165,16 +397,10 @@ class AlternativeProbabilityNodesProxy : public NodesProxy {
         virtual int getID(size_t i) const {throw prg_error("AlternativeProbabilityNodesProxy::getID(size_t) not implemented.","getID(size_t)");}
 };
 
-typedef std::vector<SimulationNode> SimNodeContainer_t;
-
 /* Abstract data randomizer base class. */
 class AbstractRandomizer {
     friend class AlternativeHypothesisRandomizater;
 
-    private:
-        void _addSimC_C_ancestor_list(size_t source_id, const NodeStructure::CountContainer_t& c, SimNodeContainer_t& treeSimNodes, const ScanRunner::NodeStructureContainer_t& treeNodes);
-        void _addSimC_C_recursive(size_t id, const NodeStructure::CountContainer_t& c, const ScanRunner::NodeStructureContainer_t& treeNodes, SimNodeContainer_t& treeSimNodes);
-
     protected:
         RandomNumberGenerator _random_number_generator;  // generates random numbers
         const Parameters& _parameters;
@@ -183,23 +409,58 @@ class AbstractRandomizer {
         bool _write_data;
         std::string _write_filename;
         bool _multiparents;
+        const BranchAggregation& _branch_aggregation;
+        std::shared_ptr<const SimulationDataFileReader> _sim_data_reader; // set when reading a binary simulation data file, shared by clones
+        std::shared_ptr<AsynchronousOrderedWriter> _sim_data_writer; // set when writing simulation data, shared by clones
 
-        void addSimC_C(size_t source_id, size_t target_id, const NodeStructure::CountContainer_t& c, SimNodeContainer_t& treeSimNodes, const ScanRunner::NodeStructureContainer_t& treeNodes);
+        template <typename Internal, typename Branch>
+        void aggregate(SimNodeContainer_t& treeSimNodes, Internal internal, Branch branch) const;
+        void addSimC_C(SimNodeContainer_t& treeSimNodes) const;
         void setSeed(unsigned int iSimulationIndex);
         virtual int randomize(unsigned int iSimulation, const AbstractNodesProxy& treeNodes, SimNodeContainer_t& treeSimNodes) = 0;
         virtual int read(const std::string& filename, unsigned int simulation, const ScanRunner::NodeStructureContainer_t& treeNodes, SimNodeContainer_t& treeSimNodes, boost::mutex& mutex) = 0;
-        virtual void write(const std::string& filename, const SimNodeContainer_t& treeSimNodes) = 0;
+        virtual void formatSimulationData(const SimNodeContainer_t& treeSimNodes, std::string& record) const = 0;
+        void write(unsigned int simulation, const SimNodeContainer_t& treeSimNodes);
 
     public:
-        AbstractRandomizer(const Parameters& parameters, bool multiparents, long lInitialSeed=RandomNumberGenerator::glDefaultSeed) 
-            : _random_number_generator(lInitialSeed), _parameters(parameters), _read_data(false), _write_data(false), _multiparents(multiparents) {}
+        AbstractRandomizer(const Parameters& parameters, bool multiparents, const BranchAggregation& aggregation, long lInitialSeed=RandomNumberGenerator::glDefaultSeed) 
+            : _random_number_generator(lInitialSeed, getEngineType(parameters)), _parameters(parameters), _read_data(false), _write_data(false), _multiparents(multiparents), _branch_aggregation(aggregation) {}
         virtual ~AbstractRandomizer() {}
 
         virtual AbstractRandomizer * clone() const = 0;
         static AbstractRandomizer * getNewRandomizer(const ScanRunner& scanner);
+        static RandomNumberGenerator::EngineType getEngineType(const Parameters& parameters);
         virtual int RandomizeData(unsigned int iSimulation, const ScanRunner::NodeStructureContainer_t& treeNodes, boost::mutex& mutex, SimNodeContainer_t& treeSimNodes) = 0;
-        void setReading(const std::string& s) {_read_filename = s; _read_data = true;}
-        void setWriting(const std::string& s) {_write_filename = s; _write_data = true;}
+        void setReading(const std::string& s);
+        bool isReading() const { return _read_data; }
+        void setWriting(const std::string& s);
+        virtual void closeWriting();
+        /* Returns whether randomized data can be held by sparse simulation nodes -- that is, each node's simulated cases never exceed its real cases. */
+        virtual bool supportsSparseNodes() const { return false; }
 };
+
+/** Sums node data into branch totals in one pass over the tree's precomputed bottom-up order. The 'internal' and 'branch' functors
+    return the node's own data and its branch data, respectively, as SimulationDataSlice objects. */
+template <typename Internal, typename Branch>
+void AbstractRandomizer::aggregate(SimNodeContainer_t& treeSimNodes, Internal internal, Branch branch) const {
+    const BranchAggregation::Indexes_t& sources = _branch_aggregation.getSources();
+    for (const auto& step: _branch_aggregation.getSteps()) {
+        auto target = branch(treeSimNodes[step._node]);
+        if (step._from_children) { // node's own data plus the branch totals of its children
+            auto own = internal(treeSimNodes[step._node]);
+            for (size_t t=0; t < target.size(); ++t) target[t] = own[t];
+            for (size_t s=step._begin; s < step._end; ++s) {
+                auto child = branch(treeSimNodes[sources[s]]);
+                for (size_t t=0; t < target.size(); ++t) target[t] += child[t];
+            }
+        } else { // node data of each distinct descendant, node itself included
+            std::fill(target.begin(), target.end(), typename decltype(target)::value_type());
+            for (size_t s=step._begin; s < step._end; ++s) {
+                auto descendant = internal(treeSimNodes[sources[s]]);
+                for (size_t t=0; t < target.size(); ++t) target[t] += descendant[t];
+            }
+        }
+    }
+}
 //******************************************************************************
 #endif
@@ -6,51 +6,48 @@
 
 /** Constructor */
 SignedRankRandomizer::SignedRankRandomizer(const ScanRunner& scanner, long lInitialSeed)
-    :AbstractRandomizer(scanner.getParameters(), scanner.getMultiParentNodesExist(), lInitialSeed), _scanner(scanner){
+    :AbstractRandomizer(scanner.getParameters(), scanner.getMultiParentNodesExist(), scanner.getBranchAggregation(), lInitialSeed), _scanner(scanner){
     _sample_site_flips.resize(scanner.getSampleSiteIdentifiers().size());
 }
 
-/** Internal method to perform the randomization. */
-int SignedRankRandomizer::randomize(unsigned int iSimulation, const AbstractNodesProxy& treeNodes, SimNodeContainer_t& treeSimNodes) {
-    int TotalSimC = 0;
+/** Flips coins for each sample site, seeding the random number generator with 'iSimulation'. */
+void SignedRankRandomizer::setSampleSiteFlips(unsigned int iSimulation) {
     setSeed(iSimulation);
-    // First flip coins for each sample site.
     for (size_t i = 0; i < _sample_site_flips.size(); ++i)
         _sample_site_flips.set(i, Bernoulli(0.5, _random_number_generator));
-    // Now assign the randomized differences to each leaf node.
+}
+
+/** Assigns the differences of each randomized node, negating the differences of the sample sites in 'flips'. */
+void SignedRankRandomizer::assignDifferences(const boost::dynamic_bitset<>& flips, const AbstractNodesProxy& treeNodes, SimNodeContainer_t& treeSimNodes) const {
     for (size_t n=0; n < treeNodes.size(); ++n) {
         if (!treeNodes.randomized(n)) continue; // skip if not randomized
         SimulationNode& simNode(treeSimNodes[n]);
         size_t d = 0;
         for (auto& ss: treeNodes.getSampleSiteMap(n)) {
             simNode.refSampleSiteDifferences()[d] = ss.second.difference();
-            if (_sample_site_flips.test(d))
+            if (flips.test(d))
                 simNode.refSampleSiteDifferences()[d] *= -1;
             ++d;
         }
     }
-    return TotalSimC;
 }
 
-/** Adds simulated cases up the tree from node/leaf to all its parents, and so on, for a node without anforlust. */
-void SignedRankRandomizer::addSim(size_t source_id, size_t target_id, const SimulationNode::SampleSiteDiff_t& diffs, SimNodeContainer_t& treeSimNodes, const ScanRunner::NodeStructureContainer_t& treeNodes) {
-    if (_multiparents)
-        addSimDiffs_ancestor_list(source_id, diffs, treeSimNodes, treeNodes);
-    else
-        addSimDiffs_recursive(target_id, diffs, treeSimNodes, treeNodes);
+/** Internal method to perform the randomization. */
+int SignedRankRandomizer::randomize(unsigned int iSimulation, const AbstractNodesProxy& treeNodes, SimNodeContainer_t& treeSimNodes) {
+    int TotalSimC = 0;
+    // First flip coins for each sample site, then assign the randomized differences to each leaf node.
+    setSampleSiteFlips(iSimulation);
+    assignDifferences(_sample_site_flips, treeNodes, treeSimNodes);
+    return TotalSimC;
 }
 
-/** Adds simulated cases up the tree from node/leaf to all its parents, and so on, for a node without anforlust. */
-void SignedRankRandomizer::addSimDiffs_ancestor_list(size_t source_id, const SimulationNode::SampleSiteDiff_t& diffs, SimNodeContainer_t& treeSimNodes, const ScanRunner::NodeStructureContainer_t& treeNodes) {
-    const NodeStructure* node = treeNodes[source_id];
-    for (NodeStructure::Ancestors_t::const_iterator itr = node->getAncestors().begin(); itr != node->getAncestors().end(); ++itr) {
-        for (size_t t = 0; t < diffs.size(); ++t)
-            treeSimNodes[*itr].refSampleSiteDifferencesBr()[t] += diffs[t];
-    }
+/** Adds simulated differences of each node up the tree into the branch differences of the node and all its ancestors. */
+void SignedRankRandomizer::addSimDiffs(SimNodeContainer_t& treeSimNodes) const {
+    aggregate(treeSimNodes, [](SimulationNode& node) { return node.getSampleSiteDifferences(); }, [](SimulationNode& node) { return node.refSampleSiteDifferencesBr(); });
 }
 
 /** Adds simulated differenced up the tree from node/leaf to all its parents, and so on. */
-void SignedRankRandomizer::addSimDiffs_recursive(size_t target_id, const SimulationNode::SampleSiteDiff_t& diffs, SimNodeContainer_t& treeSimNodes, const ScanRunner::NodeStructureContainer_t& treeNodes) {
+void SignedRankRandomizer::addSimDiffs_recursive(size_t target_id, SimulationNode::ConstDifferences_t diffs, SimNodeContainer_t& treeSimNodes, const ScanRunner::NodeStructureContainer_t& treeNodes) {
     for (size_t t = 0; t < diffs.size(); ++t)
         treeSimNodes[target_id].refSampleSiteDifferencesBr()[t] += diffs[t];
     for (size_t j = 0; j < treeNodes[target_id]->getParents().size(); ++j)
@@ -61,31 +58,51 @@ void SignedRankRandomizer::addSimDiffs_recursive(size_t target_id, const Simulat
     Random number generator seed initialized based upon 'iSimulation' index. */
 int SignedRankRandomizer::RandomizeData(unsigned int iSimulation, const ScanRunner::NodeStructureContainer_t& treeNodes, boost::mutex& mutex, SimNodeContainer_t& treeSimNodes) {
     // clear simulation data
-    std::for_each(treeSimNodes.begin(), treeSimNodes.end(), std::mem_fn(&SimulationNode::clear));
+    treeSimNodes.reset();
 
     int TotalSimC = 0;
     if (_read_data) {
-        boost::mutex::scoped_lock lock(mutex);
+        boost::mutex::scoped_lock lock(mutex, boost::defer_lock);
+        if (!_sim_data_reader) lock.lock(); // binary simulation data is read without the lock
         TotalSimC = read(_read_filename, iSimulation, treeNodes, treeSimNodes, mutex);
     } else { // else standard randomization
         TotalSimC = randomize(iSimulation, NodesProxy(treeNodes, _parameters.getDataOnlyOnLeaves()), treeSimNodes);
     }
     // write simulation data to file if requested
-    if (_write_data) {
-        boost::mutex::scoped_lock lock(mutex);
-        write(_write_filename, treeSimNodes);
-    }
+    if (_write_data) write(iSimulation, treeSimNodes);
     //------------------------ UPDATING THE TREE -----------------------------------
-    for (size_t i = 0; i < treeNodes.size(); i++)
-        addSim(i, i, treeSimNodes[i].getSampleSiteDifferences(), treeSimNodes, treeNodes);
+    addSimDiffs(treeSimNodes);
     //checkSewerShedDataConsistency(treeSimNodes, false);
     return TotalSimC;
 }
 
+/** Randomizes only the sample site flips of simulation 'iSimulation', for scans which evaluate the flips against the ranks of the
+    observed differences (see SignedRankCutScan). The simulated differences are created only when written to the simulated data file. */
+const boost::dynamic_bitset<> & SignedRankRandomizer::RandomizeSampleSiteFlips(unsigned int iSimulation, const ScanRunner::NodeStructureContainer_t& treeNodes, SimNodeContainer_t& treeSimNodes) {
+    setSampleSiteFlips(iSimulation);
+    if (_write_data) {
+        treeSimNodes.reset();
+        assignDifferences(_sample_site_flips, NodesProxy(treeNodes, _parameters.getDataOnlyOnLeaves()), treeSimNodes);
+        write(iSimulation, treeSimNodes);
+    }
+    return _sample_site_flips;
+}
+
+/** Sets the simulation nodes to the data of a replica without flipped sample sites -- the differences every replica negates sites of. */
+void SignedRankRandomizer::getObservedDifferences(const ScanRunner::NodeStructureContainer_t& treeNodes, SimNodeContainer_t& treeSimNodes) const {
+    treeSimNodes.reset();
+    assignDifferences(boost::dynamic_bitset<>(_sample_site_flips.size()), NodesProxy(treeNodes, _parameters.getDataOnlyOnLeaves()), treeSimNodes);
+    addSimDiffs(treeSimNodes);
+}
+
 int SignedRankRandomizer::read(
     const std::string& filename, unsigned int simulation, const ScanRunner::NodeStructureContainer_t& treeNodes,
     SimNodeContainer_t& treeSimNodes, boost::mutex& mutex
 ) {
+    if (_sim_data_reader) {
+        readBinary(simulation, treeSimNodes);
+        return 0;
+    }
     std::ifstream stream;
     if (!stream.is_open()) stream.open(filename.c_str());
     if (!stream) throw resolvable_error("Error: Could not open file '%s' to read the simulated data.\n", filename.c_str());
@@ -117,18 +134,20 @@ int SignedRankRandomizer::read(
     return 0;
 }
 
-void SignedRankRandomizer::write(const std::string& filename, const SimNodeContainer_t& treeSimNodes) {
-    std::ofstream stream;
+/** Reads simulation data from the memory mapped binary simulation data file. */
+void SignedRankRandomizer::readBinary(unsigned int simulation, SimNodeContainer_t& treeSimNodes) const {
+    size_t sample_sites = treeSimNodes.size() ? treeSimNodes[0].getSampleSiteDifferences().size() : 0;
+    const double * record = _sim_data_reader->getReals(simulation, treeSimNodes.size(), sample_sites);
+    for (size_t i = 0; i < treeSimNodes.size(); ++i, record += sample_sites)
+        std::copy(record, record + sample_sites, treeSimNodes[i].refSampleSiteDifferences().begin());
+}
 
-    // open output file
-    stream.open(filename.c_str(), std::ios::ate | std::ios::app);
-    if (!stream) throw resolvable_error("Error: Could not open the simulated data output file '%s'.\n", filename.c_str());
+/** Formats simulation data for the simulated data file -- a line per node. */
+void SignedRankRandomizer::formatSimulationData(const SimNodeContainer_t& treeSimNodes, std::string& record) const {
     for (size_t i = 0; i < treeSimNodes.size(); ++i) {
         const SimulationNode& simNode(treeSimNodes[i]);
-        for (auto diff: simNode.getSampleSiteDifferences()) {
-            stream << diff << " ";
-        }
-        stream << std::endl;
+        for (auto diff: simNode.getSampleSiteDifferences())
+            AsynchronousOrderedWriter::append(record, diff) += ' ';
+        record += '\n';
     }
-    stream.close();
 }
\ No newline at end of file
@@ -12,12 +12,12 @@ protected:
     boost::dynamic_bitset<> _sample_site_flips;
 
     virtual int read(const std::string& filename, unsigned int simulation, const ScanRunner::NodeStructureContainer_t& treeNodes, SimNodeContainer_t& treeSimNodes, boost::mutex& mutex);
-    virtual void write(const std::string& filename, const SimNodeContainer_t& treeSimNodes);
-    void addSim(size_t source_id, size_t target_id, const SimulationNode::SampleSiteDiff_t& diffs, SimNodeContainer_t& treeSimNodes, const ScanRunner::NodeStructureContainer_t& treeNodes);
-
-
-    void addSimDiffs_ancestor_list(size_t source_id, const SimulationNode::SampleSiteDiff_t& diffs, SimNodeContainer_t& treeSimNodes, const ScanRunner::NodeStructureContainer_t& treeNodes);
-    void addSimDiffs_recursive(size_t target_id, const SimulationNode::SampleSiteDiff_t& diffs, SimNodeContainer_t& treeSimNodes, const ScanRunner::NodeStructureContainer_t& treeNodes);
+    void readBinary(unsigned int simulation, SimNodeContainer_t& treeSimNodes) const;
+    virtual void formatSimulationData(const SimNodeContainer_t& treeSimNodes, std::string& record) const;
+    void addSimDiffs(SimNodeContainer_t& treeSimNodes) const;
+    void addSimDiffs_recursive(size_t target_id, SimulationNode::ConstDifferences_t diffs, SimNodeContainer_t& treeSimNodes, const ScanRunner::NodeStructureContainer_t& treeNodes);
+    void setSampleSiteFlips(unsigned int iSimulation);
+    void assignDifferences(const boost::dynamic_bitset<>& flips, const AbstractNodesProxy& treeNodes, SimNodeContainer_t& treeSimNodes) const;
     virtual int randomize(unsigned int iSimulation, const AbstractNodesProxy& treeNodes, SimNodeContainer_t& treeSimNodes);
 
 public:
@@ -27,6 +27,8 @@ public:
     virtual SignedRankRandomizer* clone() const { return new SignedRankRandomizer(*this); }
 
     virtual int RandomizeData(unsigned int iSimulation, const ScanRunner::NodeStructureContainer_t& treeNodes, boost::mutex& mutex, SimNodeContainer_t& treeSimNodes);
+    const boost::dynamic_bitset<> & RandomizeSampleSiteFlips(unsigned int iSimulation, const ScanRunner::NodeStructureContainer_t& treeNodes, SimNodeContainer_t& treeSimNodes);
+    void getObservedDifferences(const ScanRunner::NodeStructureContainer_t& treeNodes, SimNodeContainer_t& treeSimNodes) const;
 };
 //******************************************************************************
 #endif
@@ -0,0 +1,93 @@
+//******************************************************************************
+#include "TreeScan.h"
+#pragma hdrstop
+//******************************************************************************
+#include "SimulationDataFile.h"
+#include "PrjException.h"
+#include <cstring>
+#include <vector>
+
+////////////////////////////////////////////////// SimulationDataFile //////////////////////////////////////////////////
+
+const char * SimulationDataFile::SIGNATURE = "TSSIMBIN";
+
+/** Returns whether file starts with the binary simulation data file signature. */
+bool SimulationDataFile::isBinary(const std::string& filename) {
+    std::ifstream stream(filename.c_str(), std::ios::binary);
+    char signature[sizeof(Header::_signature)];
+    return stream.read(signature, sizeof(signature)) && std::memcmp(signature, SIGNATURE, sizeof(signature)) == 0;
+}
+
+/** Converts a whitespace delimited text simulation data file to the binary format, reading 'nodes' x 'valuesPerNode' values per simulation.
+    Returns the number of simulations converted. */
+size_t SimulationDataFile::convert(const std::string& textFilename, const std::string& binaryFilename, size_t nodes, size_t valuesPerNode, DataType type) {
+    std::ifstream stream(textFilename.c_str());
+    if (!stream) throw resolvable_error("Error: Could not open file '%s' to read the simulated data.\n", textFilename.c_str());
+    SimulationDataFileWriter writer(binaryFilename, nodes, valuesPerNode, type);
+    size_t values = nodes * valuesPerNode, simulations = 0;
+    std::vector<std::int32_t> integers(type == INTEGER ? values : 0);
+    std::vector<double> reals(type == REAL ? values : 0);
+    while (true) {
+        size_t v = 0;
+        for (; v < values; ++v) {
+            if (type == INTEGER ? !(stream >> integers[v]) : !(stream >> reals[v])) break;
+        }
+        if (v == 0 && stream.eof()) break;
+        if (v < values) {
+            if (stream.eof())
+                throw resolvable_error("Error: Simulated data file does not contain enough data in simulation %u. Expecting %u datum but could only read %u datum.\n", simulations + 1, values, v);
+            throw resolvable_error("Error: Simulated data file appears to contain invalid data in simulation %u. Datum could not be read as %s for element %u.\n",
+                                   simulations + 1, (type == INTEGER ? "integer" : "numeric value"), v + 1);
+        }
+        writer.write(type == INTEGER ? static_cast<const void*>(integers.data()) : static_cast<const void*>(reals.data()));
+        ++simulations;
+    }
+    writer.close();
+    return simulations;
+}
+
+////////////////////////////////////////////////// SimulationDataFileWriter ////////////////////////////////////////////
+
+SimulationDataFileWriter::SimulationDataFileWriter(const std::string& filename, size_t nodes, size_t valuesPerNode, SimulationDataFile::DataType type)
+    : _record_size(nodes * valuesPerNode * SimulationDataFile::getValueSize(type)) {
+    _stream.open(filename.c_str(), std::ios::binary | std::ios::trunc);
+    if (!_stream) throw resolvable_error("Error: Could not open the simulated data output file '%s'.\n", filename.c_str());
+    SimulationDataFile::Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header._signature, SimulationDataFile::SIGNATURE, sizeof(header._signature));
+    header._version = SimulationDataFile::VERSION;
+    header._byte_order = SimulationDataFile::BYTE_ORDER_MARK;
+    header._data_type = static_cast<std::uint32_t>(type);
+    header._nodes = nodes;
+    header._values_per_node = valuesPerNode;
+    _stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+////////////////////////////////////////////////// SimulationDataFileReader ////////////////////////////////////////////
+
+SimulationDataFileReader::SimulationDataFileReader(const std::string& filename) : _filename(filename), _record_size(0), _simulations(0) {
+    try {
+        _mapping = boost::interprocess::file_mapping(filename.c_str(), boost::interprocess::read_only);
+        _region = boost::interprocess::mapped_region(_mapping, boost::interprocess::read_only);
+    } catch (boost::interprocess::interprocess_exception& x) {
+        throw resolvable_error("Error: Could not open file '%s' to read the simulated data (%s).\n", filename.c_str(), x.what());
+    }
+    if (_region.get_size() < sizeof(_header))
+        throw resolvable_error("Error: Simulated data file '%s' is not a valid binary simulation data file.\n", filename.c_str());
+    std::memcpy(&_header, _region.get_address(), sizeof(_header));
+    if (std::memcmp(_header._signature, SimulationDataFile::SIGNATURE, sizeof(_header._signature)) != 0 || _header._version != SimulationDataFile::VERSION ||
+        _header._byte_order != SimulationDataFile::BYTE_ORDER_MARK || _header._data_type > SimulationDataFile::REAL)
+        throw resolvable_error("Error: Simulated data file '%s' is not a valid binary simulation data file or was written on an incompatible system.\n", filename.c_str());
+    _record_size = static_cast<size_t>(_header._nodes * _header._values_per_node) * SimulationDataFile::getValueSize(static_cast<SimulationDataFile::DataType>(_header._data_type));
+    if (_record_size) _simulations = (_region.get_size() - sizeof(_header)) / _record_size;
+}
+
+/** Returns the record of 'simulation', after checking that the file holds records of the expected dimensions and type. */
+const char * SimulationDataFileReader::getRecord(unsigned int simulation, size_t nodes, size_t valuesPerNode, SimulationDataFile::DataType type) const {
+    if (_header._nodes != nodes || _header._values_per_node != valuesPerNode || _header._data_type != static_cast<std::uint32_t>(type))
+        throw resolvable_error("Error: Simulated data file '%s' holds data for %u nodes with %u datum, expecting %u nodes with %u datum.\n",
+                               _filename.c_str(), static_cast<size_t>(_header._nodes), static_cast<size_t>(_header._values_per_node), nodes, valuesPerNode);
+    if (simulation < 1 || simulation > _simulations)
+        throw resolvable_error("Error: Simulated data file does not contain enough data in simulation %u. The file contains %u simulations.\n", simulation, _simulations);
+    return static_cast<const char*>(_region.get_address()) + sizeof(_header) + static_cast<size_t>(simulation - 1) * _record_size;
+}
@@ -0,0 +1,75 @@
+//******************************************************************************
+#ifndef __SimulationDataFile_H
+#define __SimulationDataFile_H
+//******************************************************************************
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+/** Binary simulation data file format. The file starts with a header giving the number of nodes, the number of values per node
+    and the value type, followed by one fixed-size record per simulation -- so the data of any simulation is found by offset alone.
+    Values of a record are ordered by node, then by value, as in the whitespace delimited text files written by the randomizers. */
+class SimulationDataFile {
+    public:
+        enum DataType {INTEGER=0, REAL};
+
+        struct Header {
+            char            _signature[8];
+            std::uint32_t   _version;
+            std::uint32_t   _byte_order;
+            std::uint32_t   _data_type;
+            std::uint32_t   _reserved;
+            std::uint64_t   _nodes;
+            std::uint64_t   _values_per_node;
+        };
+
+        static const char         * SIGNATURE;
+        static const std::uint32_t  VERSION = 1;
+        static const std::uint32_t  BYTE_ORDER_MARK = 0x01020304;
+
+        static size_t   getValueSize(DataType type) { return type == INTEGER ? sizeof(std::int32_t) : sizeof(double); }
+        static bool     isBinary(const std::string& filename);
+        static size_t   convert(const std::string& textFilename, const std::string& binaryFilename, size_t nodes, size_t valuesPerNode, DataType type);
+};
+
+/** Creates a binary simulation data file, writing its header, then appends simulation records to it. */
+class SimulationDataFileWriter {
+    private:
+        std::ofstream   _stream;
+        size_t          _record_size;
+
+    public:
+        SimulationDataFileWriter(const std::string& filename, size_t nodes, size_t valuesPerNode, SimulationDataFile::DataType type);
+
+        void write(const void * record) { _stream.write(static_cast<const char*>(record), _record_size); }
+        void close() { _stream.close(); }
+};
+
+/** Memory maps a binary simulation data file, giving direct access to the record of any simulation. The file is only read, so one
+    reader is safely shared by all threads performing simulations. */
+class SimulationDataFileReader {
+    private:
+        std::string                             _filename;
+        boost::interprocess::file_mapping       _mapping;
+        boost::interprocess::mapped_region      _region;
+        SimulationDataFile::Header              _header;
+        size_t                                  _record_size;
+        size_t                                  _simulations;
+
+        const char    * getRecord(unsigned int simulation, size_t nodes, size_t valuesPerNode, SimulationDataFile::DataType type) const;
+
+    public:
+        SimulationDataFileReader(const std::string& filename);
+
+        size_t          getNumSimulations() const { return _simulations; }
+        const std::int32_t * getIntegers(unsigned int simulation, size_t nodes, size_t valuesPerNode) const {
+            return reinterpret_cast<const std::int32_t*>(getRecord(simulation, nodes, valuesPerNode, SimulationDataFile::INTEGER));
+        }
+        const double  * getReals(unsigned int simulation, size_t nodes, size_t valuesPerNode) const {
+            return reinterpret_cast<const double*>(getRecord(simulation, nodes, valuesPerNode, SimulationDataFile::REAL));
+        }
+};
+//******************************************************************************
+#endif
@@ -11,12 +11,19 @@ using boost::mt19937;
 
 /** Constructor */
 TemporalRandomizer::TemporalRandomizer(const ScanRunner& scanner, long lInitialSeed)
-:AbstractRandomizer(scanner.getParameters(), scanner.getMultiParentNodesExist(), lInitialSeed),
+:AbstractRandomizer(scanner.getParameters(), scanner.getMultiParentNodesExist(), scanner.getBranchAggregation(), lInitialSeed),
  _total_C(scanner.getTotalC()), _total_N(scanner.getTotalN()), _time_range_sets(scanner.getParameters().getDataTimeRangeSet()),
- _day_of_week_indexes(scanner.getDayOfWeekIndexes()), _window_exclusions(scanner.getWindowExclusions()) {
+ _day_of_week_indexes(scanner.getDayOfWeekIndexes()), _window_exclusions(scanner.getWindowExclusions()),
+ _multinomial_sampling(scanner.getParameters().getSamplerType() == Parameters::REJECTION_SAMPLER) {
     // This will need refactoring if we ever implement multiple data time ranges.
     DataTimeRange min_max = _time_range_sets.getMinMax();
     _zero_translation_additive = (min_max.getStart() <= 0) ? std::abs(min_max.getStart()) : min_max.getStart() * -1;
+    // Cases are placed multinomially over the time intervals which are not excluded.
+    if (_multinomial_sampling && _parameters.isApplyingExclusionTimeRanges()) {
+        const DataTimeRange& range = _time_range_sets.getDataTimeRangeSets().front();
+        for (DataTimeRange::index_t idx=range.getStart() + _zero_translation_additive; idx <= range.getEnd() + _zero_translation_additive; ++idx)
+            if (!_window_exclusions.test(idx)) _included_intervals.push_back(idx);
+    }
     // If data is censored, store censor distibution for each node so randomizations are quicker.
     _censored_data = scanner.isCensoredData();
     if (scanner.isCensoredData()) {
@@ -40,12 +47,26 @@ int TemporalRandomizer::randomize(unsigned int iSimulation, const AbstractNodesP
             if (!treeNodes.randomized(i) || !treeNodes.getIntC(i)) continue; // skip if not randomized or zero node cases
             SimulationNode& simNode(treeSimNodes[i]);
             const NodeStructure::CountContainer_t & counts = treeNodes.getIntC_C(i);
+            if (_multinomial_sampling) {
+                // Place the cases of each day of week together, uniformly among the time indexes of that week day.
+                NodeStructure::count_t weekday_cases[7] = {0, 0, 0, 0, 0, 0, 0};
+                for (size_t idx = 0; idx < counts.size(); ++idx)
+                    weekday_cases[idx % 7] += counts[idx] - (idx + 1 == counts.size() ? 0 : counts[idx + 1]);
+                for (size_t day = 0; day < 7; ++day) {
+                    const ScanRunner::TimeIntervalContainer_t& indexes = _day_of_week_indexes[day];
+                    _multinomial.sampleUniform(weekday_cases[day], indexes.size(), [&simNode, &indexes](size_t k, long cases) {
+                        simNode.addIntC(indexes[k], static_cast<NodeStructure::count_t>(cases));
+                    }, _random_number_generator);
+                    TotalSimC += weekday_cases[day];
+                }
+                continue;
+            }
             for (size_t idx = 0; idx < counts.size(); ++idx) {
                 NodeStructure::count_t cases = counts[idx] - (idx + 1 == counts.size() ? 0 : counts[idx + 1]);
                 for (NodeStructure::count_t c = 0; c < cases; ++c) {
                     // For the associated day of week, by this idx, get the uniformly distributed time index along all of the same week day.
                     DataTimeRange::index_t idxDay = static_cast<DataTimeRange::index_t>(Equilikely(static_cast<long>(1), static_cast<long>(_day_of_week_indexes[idx % 7].size()), _random_number_generator));
-                    ++(simNode.refIntC_C()[_day_of_week_indexes[idx % 7][idxDay - 1]]);
+                    simNode.addIntC(_day_of_week_indexes[idx % 7][idxDay - 1]);
                     ++TotalSimC;
                 }
             }
@@ -56,12 +77,26 @@ int TemporalRandomizer::randomize(unsigned int iSimulation, const AbstractNodesP
             if (!treeNodes.randomized(i) || !nodeC) continue; // skip if not randomized or zero node cases
             const NodeStructure::CensorDist_t& censor_distribution = _node_censors[i];
             SimulationNode& simNode(treeSimNodes[i]);
+            if (_multinomial_sampling) {
+                // Place the cases of each censor time within its censor period, then the cases not censored across the entire data time range.
+                auto assign = [&simNode, &zeroRange](size_t k, long cases) {
+                    simNode.addIntC(static_cast<size_t>(zeroRange.getStart()) + k, static_cast<NodeStructure::count_t>(cases));
+                };
+                NodeStructure::count_t censor_count = 0;
+                for (const auto& censor: censor_distribution) {
+                    _multinomial.sampleUniform(censor.second, static_cast<size_t>(censor.first - zeroRange.getStart() + 1), assign, _random_number_generator);
+                    censor_count += censor.second;
+                }
+                _multinomial.sampleUniform(nodeC - censor_count, static_cast<size_t>(zeroRange.getEnd() - zeroRange.getStart() + 1), assign, _random_number_generator);
+                TotalSimC += nodeC;
+                continue;
+            }
             int censor_count=0;
             for (NodeStructure::CensorDist_t::const_iterator itr=censor_distribution.begin(); itr != censor_distribution.end(); ++itr) {
                 for (NodeStructure::count_t c=0; c < itr->second; ++c) {
                     // Distribute the censored case within the censor period -- data time range start to the censor time, inclusively.
                     DataTimeRange::index_t idx = static_cast<DataTimeRange::index_t>(Equilikely(static_cast<long>(zeroRange.getStart()), static_cast<long>(itr->first), _random_number_generator));
-                    ++(simNode.refIntC_C()[idx]);
+                    simNode.addIntC(idx);
                     ++TotalSimC;
                     ++censor_count;
                 }
@@ -69,7 +104,7 @@ int TemporalRandomizer::randomize(unsigned int iSimulation, const AbstractNodesP
             // Now apply any of the cases that were not censored on this node -- they are distributed across entire data time range.
             for (NodeStructure::count_t c=0; c < nodeC - censor_count; ++c) {
                 DataTimeRange::index_t idx = static_cast<DataTimeRange::index_t>(Equilikely(static_cast<long>(zeroRange.getStart()), static_cast<long>(zeroRange.getEnd()), _random_number_generator));
-                ++(simNode.refIntC_C()[idx]);
+                simNode.addIntC(idx);
                 ++TotalSimC;
             }
         }
@@ -78,12 +113,19 @@ int TemporalRandomizer::randomize(unsigned int iSimulation, const AbstractNodesP
             NodeStructure::count_t nodeC = treeNodes.getIntC(i);
             if (!treeNodes.randomized(i) || !nodeC) continue; // skip if not randomized or zero node cases
             SimulationNode& simNode(treeSimNodes[i]);
+            if (_multinomial_sampling) {
+                _multinomial.sampleUniform(nodeC, _included_intervals.size(), [this, &simNode](size_t k, long cases) {
+                    simNode.addIntC(_included_intervals[k], static_cast<NodeStructure::count_t>(cases));
+                }, _random_number_generator);
+                TotalSimC += nodeC;
+                continue;
+            }
             for (NodeStructure::count_t c = 0; c < nodeC; ++c) {
                 DataTimeRange::index_t idx;
                 do {
                     idx = static_cast<DataTimeRange::index_t>(Equilikely(static_cast<long>(zeroRange.getStart()), static_cast<long>(zeroRange.getEnd()), _random_number_generator));
 				} while (_window_exclusions.test(idx)); // skip trying until index is not in the exclusion set
-                ++(simNode.refIntC_C()[idx]);
+                simNode.addIntC(idx);
                 ++TotalSimC;
             }
         }
@@ -92,9 +134,16 @@ int TemporalRandomizer::randomize(unsigned int iSimulation, const AbstractNodesP
             NodeStructure::count_t nodeC = treeNodes.getIntC(i);
             if (!treeNodes.randomized(i) || !nodeC) continue; // skip if not randomized or zero node cases
             SimulationNode& simNode(treeSimNodes[i]);
+            if (_multinomial_sampling) {
+                _multinomial.sampleUniform(nodeC, static_cast<size_t>(zeroRange.getEnd() - zeroRange.getStart() + 1), [&simNode, &zeroRange](size_t k, long cases) {
+                    simNode.addIntC(static_cast<size_t>(zeroRange.getStart()) + k, static_cast<NodeStructure::count_t>(cases));
+                }, _random_number_generator);
+                TotalSimC += nodeC;
+                continue;
+            }
             for (NodeStructure::count_t c=0; c < nodeC; ++c) {
                 DataTimeRange::index_t idx = static_cast<DataTimeRange::index_t>(Equilikely(static_cast<long>(zeroRange.getStart()), static_cast<long>(zeroRange.getEnd()), _random_number_generator));
-                ++(simNode.refIntC_C()[idx]);
+                simNode.addIntC(idx);
                 ++TotalSimC;
             }
         }
@@ -109,30 +158,28 @@ int TemporalRandomizer::randomize(unsigned int iSimulation, const AbstractNodesP
     Random number generator seed initialized based upon 'iSimulation' index. */
 int TemporalRandomizer::RandomizeData(unsigned int iSimulation, const ScanRunner::NodeStructureContainer_t& treeNodes, boost::mutex& mutex, SimNodeContainer_t& treeSimNodes) {
     // clear simulation data
-    std::for_each(treeSimNodes.begin(), treeSimNodes.end(), std::mem_fn(&SimulationNode::clear));
+    treeSimNodes.reset();
 
     int TotalSimC = 0;
     if (_read_data) {
-        boost::mutex::scoped_lock lock(mutex);
+        boost::mutex::scoped_lock lock(mutex, boost::defer_lock);
+        if (!_sim_data_reader) lock.lock(); // binary simulation data is read without the lock
         TotalSimC = read(_read_filename, iSimulation, treeNodes, treeSimNodes, mutex);
     } else { // else standard randomization
         TotalSimC = randomize(iSimulation, NodesProxy(treeNodes, _parameters.getDataOnlyOnLeaves()), treeSimNodes);
     }
     // write simulation data to file if requested
-    if (_write_data) {
-        boost::mutex::scoped_lock lock(mutex);
-        write(_write_filename, treeSimNodes);
-    }
+    if (_write_data) write(iSimulation, treeSimNodes);
     // now set simulation data structures as cumulative
-    std::for_each(treeSimNodes.begin(), treeSimNodes.end(), std::mem_fn(&SimulationNode::setCumulative));
+    treeSimNodes.setCumulative();
     //------------------------ UPDATING THE TREE -----------------------------------
-    for (size_t i=0; i < treeNodes.size(); i++)
-        addSimC_C(i, i, treeSimNodes[i].getIntC_C(), treeSimNodes, treeNodes);
+    addSimC_C(treeSimNodes);
     return TotalSimC;
 }
 
 /** Reads simulation data from file. */
 int TemporalRandomizer::read(const std::string& filename, unsigned int simulation, const ScanRunner::NodeStructureContainer_t& treeNodes, SimNodeContainer_t& treeSimNodes, boost::mutex& mutex) {
+    if (_sim_data_reader) return readBinary(simulation, treeNodes, treeSimNodes);
     std::ifstream stream;
     if (!stream.is_open()) stream.open(filename.c_str());
     if (!stream) throw resolvable_error("Error: Could not open file '%s' to read the simulated data.\n", filename.c_str());
@@ -161,80 +208,77 @@ int TemporalRandomizer::read(const std::string& filename, unsigned int simulatio
             branch += count;
         }
         total += branch;
-        // check that the total read count equals node branch count?
-        if (branch != treeNodes[i]->getBrC())
-            throw resolvable_error("Error: Simulation count (%d) for node %s in simulated data file does not equal branch count (%d).\n",
-                                   branch, treeNodes[i]->getIdentifier().c_str(), treeNodes[i]->getBrC());
+        // check that the total read count equals node count -- the file holds the data of each node, not its branch
+        if (branch != treeNodes[i]->getIntC())
+            throw resolvable_error("Error: Simulation count (%d) for node %s in simulated data file does not equal node count (%d).\n",
+                                   branch, treeNodes[i]->getIdentifier().c_str(), treeNodes[i]->getIntC());
         treeSimNodes[i].refBrC() = 0;
     }
     stream.close();
     return total;
 }
 
-/** Writes simulation data to file. */
-void TemporalRandomizer::write(const std::string& filename, const SimNodeContainer_t& treeSimNodes) {
-    std::ofstream stream;
+/** Reads simulation data from the memory mapped binary simulation data file. */
+int TemporalRandomizer::readBinary(unsigned int simulation, const ScanRunner::NodeStructureContainer_t& treeNodes, SimNodeContainer_t& treeSimNodes) const {
+    size_t intervals = treeSimNodes.size() ? treeSimNodes[0].getIntC_C().size() : 0;
+    const std::int32_t * record = _sim_data_reader->getIntegers(simulation, treeSimNodes.size(), intervals);
+    int total=0;
+    for (size_t i=0; i < treeSimNodes.size(); ++i, record += intervals) {
+        SimulationNode& simNode(treeSimNodes[i]);
+        int branch = 0;
+        for (size_t s=0; s < intervals; ++s) {
+            simNode.refIntC_C()[s] = record[s];
+            branch += record[s];
+        }
+        total += branch;
+        if (branch != treeNodes[i]->getIntC())
+            throw resolvable_error("Error: Simulation count (%d) for node %s in simulated data file does not equal node count (%d).\n",
+                                   branch, treeNodes[i]->getIdentifier().c_str(), treeNodes[i]->getIntC());
+        treeSimNodes[i].refBrC() = 0;
+    }
+    return total;
+}
 
-    // open output file
-    stream.open(filename.c_str(), std::ios::ate|std::ios::app);
-    if (!stream) throw resolvable_error("Error: Could not open the simulated data output file '%s'.\n", filename.c_str());
+/** Formats simulation data for the simulated data file -- a line per node. */
+void TemporalRandomizer::formatSimulationData(const SimNodeContainer_t& treeSimNodes, std::string& record) const {
     for (size_t i=0; i < treeSimNodes.size(); ++i) {
         const SimulationNode& simNode(treeSimNodes[i]);
-        for (size_t s=0; s < simNode.getIntC_C().size(); ++s) {
-            stream << simNode.getIntC_C()[s] << " ";
-        }
-        stream << std::endl;
+        for (size_t s=0; s < simNode.getIntC_C().size(); ++s)
+            AsynchronousOrderedWriter::append(record, simNode.getIntC_C()[s]) += ' ';
+        record += '\n';
     }
-    stream.close();
 }
 
 //********** ConditionalTemporalRandomizer **********
 
 ConditionalTemporalRandomizer::ConditionalTemporalRandomizer(const ScanRunner& scanner, long lInitialSeed)
-            : TemporalRandomizer(scanner, lInitialSeed), AbstractPermutedDataRandomizer(scanner.getParameters(), lInitialSeed) {
-
-    StationaryContainerCollection_t::iterator stationaryItr;
-    PermutedContainerCollection_t::iterator permutedItr;
-    // determine which collection of attributes to add these patients.
-    if (!_dayOfWeekAdjustment) {
-        stationaryItr = gvStationaryAttributeCollections.begin();
-        permutedItr = gvOriginalPermutedAttributeCollections.begin();
-    }
-    // assign stationary and permuted data from scanner nodes
+            : TemporalRandomizer(scanner, lInitialSeed), _permutation(!_multinomial_sampling) {
+    // With day of week adjustment, time indexes are only permuted among cases on the same week day -- a group per week day.
+    // Cases are added by node then time index within each group, the order in which the sorting permutation expects them.
+    size_t groups = scanner.getParameters().isPerformingDayOfWeekAdjustment() ? 7 : 1;
     const ScanRunner::NodeStructureContainer_t & nodes = scanner.getNodes();
-    ScanRunner::NodeStructureContainer_t::const_iterator itr=nodes.begin(), itr_end=nodes.end();
-    for (;itr != itr_end; ++itr) {
-        const NodeStructure::CountContainer_t& counts = (*itr)->getIntC_C();
-        for (size_t timeIdx=0; timeIdx < counts.size(); ++timeIdx) {
-            if (_dayOfWeekAdjustment) {
-                stationaryItr = gvStationaryAttributeCollections.begin() + static_cast<size_t>(timeIdx % 7);
-                permutedItr = gvOriginalPermutedAttributeCollections.begin() + static_cast<size_t>(timeIdx % 7);
-            }
-            NodeStructure::count_t num_cases = counts[timeIdx] -  (timeIdx + 1 >= counts.size() ? 0 : counts[timeIdx + 1]);
-            for (NodeStructure::count_t c=0; c < num_cases; ++c) {
-                // add stationary values
-                stationaryItr->push_back(ConditionalTemporalStationary_t((*itr)->getID()));
-                // add permutated value
-                permutedItr->push_back(ConditionalTemporalPermuted_t(timeIdx));
+    for (size_t group=0; group < groups; ++group) {
+        for (ScanRunner::NodeStructureContainer_t::const_iterator itr=nodes.begin(); itr != nodes.end(); ++itr) {
+            const NodeStructure::CountContainer_t& counts = (*itr)->getIntC_C();
+            for (size_t timeIdx=group; timeIdx < counts.size(); timeIdx += groups) {
+                NodeStructure::count_t num_cases = counts[timeIdx] -  (timeIdx + 1 >= counts.size() ? 0 : counts[timeIdx + 1]);
+                for (NodeStructure::count_t c=0; c < num_cases; ++c)
+                    _permutation.add((*itr)->getID(), static_cast<DataTimeRange::index_t>(timeIdx));
             }
         }
+        _permutation.endGroup();
     }
 }
 
 /** Assigns randomized case data to tree simulation node data structures. */
 void ConditionalTemporalRandomizer::AssignRandomizedData(const AbstractNodesProxy& treeNodes, SimNodeContainer_t& treeSimNodes) {
     int TotalSimC = 0;
-    StationaryContainerCollection_t::iterator itrSC=gvStationaryAttributeCollections.begin();
-    PermutedContainerCollection_t::iterator itrPC=gvPermutedAttributeCollections.begin();
-    // iterate through each separate collection of stationary/permuted collections
-    for (; itrSC != gvStationaryAttributeCollections.end(); ++itrSC, ++itrPC) {
-        StationaryContainer_t::iterator itrS=itrSC->begin();
-        PermutedContainer_t::iterator itrP=itrPC->begin();
-        // for each stationary/permutation pair, updating the number of cases for node/time
-        for (; itrS != itrSC->end(); ++itrS, ++itrP) {
-            ++(treeSimNodes[itrS->GetStationaryVariable()].refIntC_C()[(*itrP).GetPermutedVariable()]);
-            ++TotalSimC;
-        }
+    const int * nodeIds = _permutation.getStationary();
+    const DataTimeRange::index_t * timeIndexes = _permutation.getPermuted();
+    // for each stationary/permutation pair, updating the number of cases for node/time
+    for (size_t i=0; i < _permutation.size(); ++i) {
+        treeSimNodes[nodeIds[i]].addIntC(static_cast<size_t>(timeIndexes[i]));
+        ++TotalSimC;
     }
     if (TotalSimC != _total_C) // sanity check
         throw prg_error("Number of simulated cases does not equal total cases: %d != %d.", "ConditionalTemporalRandomizer::AssignRandomizedData(...)", TotalSimC, _total_C);
@@ -250,7 +294,7 @@ TemporalAlternativeHypothesisRandomizer::TemporalAlternativeHypothesisRandomizer
 int TemporalAlternativeHypothesisRandomizer::randomize(unsigned int iSimulation, const AbstractNodesProxy& treeNodes, SimNodeContainer_t& treeSimNodes) {
     setSeed(iSimulation);
     // clear simulation data
-    std::for_each(treeSimNodes.begin(), treeSimNodes.end(), std::mem_fn(&SimulationNode::clear));
+    treeSimNodes.reset();
 
     // This will need refactoring if we ever implement multiple data time ranges.
     const DataTimeRange& range = _time_range_sets.getDataTimeRangeSets().front();
@@ -303,6 +347,14 @@ int TemporalAlternativeHypothesisRandomizer::randomize(unsigned int iSimulation,
             SimulationNode& simNode(treeSimNodes[i]);
             // Get adjusted values for this node -- this is the measure array we adjusted from the alternative hypothesis file.
             const NodeStructure::ExpectedContainer_t& measure = treeNodes.getIntN_C(i);
+            if (_multinomial_sampling) {
+                // Place the cases multinomially, interval k drawing in proportion to its measure -- measure[k + 1] - measure[k].
+                _multinomial.sample(nodeC, measure.size() - 1, [&measure](size_t k) { return measure[k]; }, [&simNode](size_t k, long cases) {
+                    simNode.addIntC(k, static_cast<NodeStructure::count_t>(cases));
+                }, _random_number_generator);
+                TotalSimC += nodeC;
+                continue;
+            }
             // Create a distribution from zero to cumulative maximum in elevated risk array -- for current node.
             boost::random::uniform_real_distribution<> distribution(0.0, measure.back());
             // For each case, distribute to other interval - by using the adjusted measure array.
@@ -312,7 +364,7 @@ int TemporalAlternativeHypothesisRandomizer::randomize(unsigned int iSimulation,
                 NodeStructure::ExpectedContainer_t::const_iterator itr = std::upper_bound(measure.begin(), measure.end(), rv);
                 DataTimeRange::index_t idx = static_cast<DataTimeRange::index_t>(std::distance(measure.begin(), itr)) - 1;
                 // Now we can assign this randomized case and update total.
-                ++(simNode.refIntC_C()[idx]);
+                simNode.addIntC(idx);
                 ++TotalSimC;
             }
         }
@@ -322,7 +374,7 @@ int TemporalAlternativeHypothesisRandomizer::randomize(unsigned int iSimulation,
         throw prg_error("Number of simulated cases does not equal total cases: %d != %d.", "TemporalAlternativeHypothesisRandomizer::randomize(...)", TotalSimC, _total_C);
 
     // now set simulation data structures as cumulative
-    std::for_each(treeSimNodes.begin(), treeSimNodes.end(), std::mem_fn(&SimulationNode::setCumulative));
+    treeSimNodes.setCumulative();
 
     return _total_C;
 }
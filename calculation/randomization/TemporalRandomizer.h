@@ -5,6 +5,7 @@
 #include "Randomization.h"
 #include "RandomDistribution.h"
 #include "PermutationDataRandomizer.h"
+#include "RandomSampler.h"
 #include <boost/dynamic_bitset.hpp>
 
 /** Data randomizer for uniform tree-time scan. */
@@ -21,10 +22,14 @@ protected:
     bool                        _censored_data;
     node_censor_container_t     _node_censors;
     const boost::dynamic_bitset<>& _window_exclusions;
+    bool                        _multinomial_sampling;      // whether the cases of a node are placed by a multinomial draw rather than case by case
+    MultinomialSampler          _multinomial;
+    std::vector<DataTimeRange::index_t> _included_intervals; // time intervals of the data time range not excluded, when applying exclusions
 
     virtual int randomize(unsigned int iSimulation, const AbstractNodesProxy& treeNodes, SimNodeContainer_t& treeSimNodes);
     virtual int read(const std::string& filename, unsigned int simulation, const ScanRunner::NodeStructureContainer_t& treeNodes, SimNodeContainer_t& treeSimNodes, boost::mutex& mutex);
-    virtual void write(const std::string& filename, const SimNodeContainer_t& treeSimNodes);
+    int readBinary(unsigned int simulation, const ScanRunner::NodeStructureContainer_t& treeNodes, SimNodeContainer_t& treeSimNodes) const;
+    virtual void formatSimulationData(const SimNodeContainer_t& treeSimNodes, std::string& record) const;
 
 public:
     TemporalRandomizer(const ScanRunner& scanner, long lInitialSeed=RandomNumberGenerator::glDefaultSeed);
@@ -32,19 +37,21 @@ public:
 
     virtual TemporalRandomizer * clone() const {return new TemporalRandomizer(*this);}
     virtual int RandomizeData(unsigned int iSimulation, const ScanRunner::NodeStructureContainer_t& treeNodes, boost::mutex& mutex, SimNodeContainer_t& treeSimNodes);
+    virtual bool supportsSparseNodes() const {return !_read_data && !_write_data;}
 };
 
-typedef StationaryAttribute<int> ConditionalTemporalStationary_t; // node Id
-typedef PermutedAttribute<size_t> ConditionalTemporalPermuted_t;  // time index
+typedef PermutedDataArrays<int, DataTimeRange::index_t> ConditionalTemporalPermutation_t; // node Id, time index
 
 /** Data randomizer for tree-time scan that conditions on the number of cases on each branch and on the total number of cases on each day summed over all the leaves */
-class ConditionalTemporalRandomizer : public TemporalRandomizer, public AbstractPermutedDataRandomizer<ConditionalTemporalStationary_t, ConditionalTemporalPermuted_t> {
+class ConditionalTemporalRandomizer : public TemporalRandomizer {
     protected:
+        ConditionalTemporalPermutation_t _permutation;
+
         virtual void AssignRandomizedData(const AbstractNodesProxy& treeNodes, SimNodeContainer_t& treeSimNodes);
         virtual int randomize(unsigned int iSimulation, const AbstractNodesProxy& treeNodes, SimNodeContainer_t& treeSimNodes) {
             setSeed(iSimulation);
-            // assign random numbers to permuted attribute and sort
-            SortPermutedAttribute(_random_number_generator);
+            // permute the time indexes of cases among the cases
+            _permutation.permute(_random_number_generator);
             // re-assign dataset's simulation data
             AssignRandomizedData(treeNodes, treeSimNodes);
             return _total_C;
@@ -66,6 +73,7 @@ class TemporalAlternativeHypothesisRandomizer : public TemporalRandomizer {
         virtual ~TemporalAlternativeHypothesisRandomizer() {}
 
         virtual TemporalAlternativeHypothesisRandomizer * clone() const {return new TemporalAlternativeHypothesisRandomizer(*this);}
+        virtual bool supportsSparseNodes() const {return false;}
 };
 //******************************************************************************
 #endif
@@ -7,52 +7,70 @@
 #include "UtilityFunctions.h"
 #include "DataFileWriter.h"
 #include <regex>
+#include <filesystem>
 #include <boost/tokenizer.hpp>
 #include <boost/algorithm/string.hpp>
 #include <boost/algorithm/string/replace.hpp>
 
 using namespace boost;
 
-/** Static method which returns newly allocated DataSource object. */
-DataSource * DataSource::getNewDataSourceObject(const std::string& sSourceFilename, const Parameters::InputSource * source) {
+/** Static method which returns newly allocated DataSource object -- which parses the file on 'threads' threads, if more than one. */
+DataSource * DataSource::getNewDataSourceObject(const std::string& sSourceFilename, const Parameters::InputSource * source, unsigned int threads) {
     // if an InputSource is not defined, default to space delimited ascii source
-    if (!source)
-        return new CSVFileDataSource(sSourceFilename, ",", "\"", 0, false);
+    if (!source) {
+        if (threads > 1) return new ChunkedCSVFileDataSource(sSourceFilename, threads, ",", "\"", 0, false);
+        return new MappedCSVFileDataSource(sSourceFilename, ",", "\"", 0, false);
+    }
     // return data source object by input source type
     DataSource * dataSource=0;
     switch (source->getSourceType()) {
-        case CSV : dataSource = new CSVFileDataSource(sSourceFilename, source->getDelimiter(), source->getGroup(), source->getSkip(), source->getFirstRowHeader()); break;
-        default  : dataSource = new CSVFileDataSource(sSourceFilename, ",");
+        case CSV :
+            if (threads > 1)
+                dataSource = new ChunkedCSVFileDataSource(sSourceFilename, threads, source->getDelimiter(), source->getGroup(), source->getSkip(), source->getFirstRowHeader());
+            else
+                dataSource = new MappedCSVFileDataSource(sSourceFilename, source->getDelimiter(), source->getGroup(), source->getSkip(), source->getFirstRowHeader());
+            break;
+        default  : dataSource = new MappedCSVFileDataSource(sSourceFilename, ",");
     }
     dataSource->setFieldsMap(source->getFieldsMap());
     return dataSource;
 }
 
 
-/** Constructor */
-CSVFileDataSource::CSVFileDataSource(const std::string& sSourceFilename, const std::string& delimiter, const std::string& grouper, unsigned long skip, bool firstRowHeaders)
+/** Constructor for derived classes which read the source file themselves. */
+CSVFileDataSource::CSVFileDataSource(const std::string& delimiter, const std::string& grouper, unsigned long skip, bool firstRowHeaders)
                   :DataSource(), _delimiter(delimiter), _grouper(grouper), _grouper_escape(""), _skip(skip), _firstRowHeaders(firstRowHeaders), _readCount(0), _ignore_empty_fields(false){
     // special processing for 'whitespace' delimiter string
     if (_delimiter == "" || _delimiter == " ") {
         _delimiter = "\t\v\f\r\n ";
         _ignore_empty_fields = true;
     }
+    // if first row is header, increment number of rows to skip
+    if (_firstRowHeaders) ++_skip;
+}
+
+/** Constructor */
+CSVFileDataSource::CSVFileDataSource(const std::string& sSourceFilename, const std::string& delimiter, const std::string& grouper, unsigned long skip, bool firstRowHeaders)
+                  :CSVFileDataSource(delimiter, grouper, skip, firstRowHeaders) {
     _sourceFile.open(sSourceFilename.c_str());
     if (!_sourceFile)
         throw resolvable_error("Error: Could not open file:\n'%s'.\n", sSourceFilename.c_str());
     // Get the byte-order mark, if there is one
     unsigned char bom[4];
     _sourceFile.read(reinterpret_cast<char*>(bom), 4);
-    // Since we don't know what the endian was on the machine that created the file we are reading, we'll need to check both ways.
-    if ((bom[0] == 0xef && bom[1] == 0xbb && bom[2] == 0xbf) ||             // utf-8
-        (bom[0] == 0 && bom[1] == 0 && bom[2] == 0xfe && bom[3] == 0xff) || // UTF-32, big-endian
-        (bom[0] == 0xff && bom[1] == 0xfe && bom[2] == 0 && bom[3] == 0) || // UTF-32, little-endian
-        (bom[0] == 0xfe && bom[1] == 0xff) ||                               // UTF-16, big-endian
-        (bom[0] == 0xff && bom[1] == 0xfe))                                 // UTF-16, little-endian
+    if (hasByteOrderMark(bom))
       throwUnicodeException();
     _sourceFile.seekg(0L, std::ios::beg);
-    // if first row is header, increment number of rows to skip
-    if (_firstRowHeaders) ++_skip;
+}
+
+/** Returns whether the first bytes of a file are a Unicode byte-order mark. */
+bool CSVFileDataSource::hasByteOrderMark(const unsigned char bom[4]) {
+    // Since we don't know what the endian was on the machine that created the file we are reading, we'll need to check both ways.
+    return (bom[0] == 0xef && bom[1] == 0xbb && bom[2] == 0xbf) ||             // utf-8
+           (bom[0] == 0 && bom[1] == 0 && bom[2] == 0xfe && bom[3] == 0xff) || // UTF-32, big-endian
+           (bom[0] == 0xff && bom[1] == 0xfe && bom[2] == 0 && bom[3] == 0) || // UTF-32, little-endian
+           (bom[0] == 0xfe && bom[1] == 0xff) ||                               // UTF-16, big-endian
+           (bom[0] == 0xff && bom[1] == 0xfe);                                 // UTF-16, little-endian
 }
 
 /** Re-positions file cursor to beginning of file. */
@@ -162,6 +180,261 @@ void CSVFileDataSource::throwUnicodeException() {
 }
 
 
+//////////////////////////// MappedCSVFileDataSource //////////////////////////////////////////////
+
+/** Constructor */
+ByteSetFinder::ByteSetFinder(const std::string& bytes) {
+    std::memset(_members, 0, sizeof(_members));
+    for (char c: bytes) {
+        if (contains(c)) continue;
+        _members[static_cast<unsigned char>(c)] = true;
+        _patterns.push_back(0x0101010101010101ULL * static_cast<unsigned char>(c));
+    }
+}
+
+/** Constructor */
+MappedCSVFileDataSource::MappedCSVFileDataSource(const std::string& sSourceFilename, const std::string& delimiter, const std::string& grouper, unsigned long skip, bool firstRowHeaders)
+    : CSVFileDataSource(delimiter, grouper, skip, firstRowHeaders), _begin(0), _end(0), _cursor(0), _line_ends("\r\n"),
+      _specials(_delimiter + _grouper + _grouper_escape.substr(0, 1)) {
+    try {
+        _mapping = boost::interprocess::file_mapping(sSourceFilename.c_str(), boost::interprocess::read_only);
+        // an empty file can not be mapped, it simply has no records
+        if (std::filesystem::file_size(sSourceFilename) > 0)
+            _region = boost::interprocess::mapped_region(_mapping, boost::interprocess::read_only);
+    } catch (std::exception&) {
+        throw resolvable_error("Error: Could not open file:\n'%s'.\n", sSourceFilename.c_str());
+    }
+    _begin = _cursor = static_cast<const char*>(_region.get_address());
+    _end = _begin + _region.get_size();
+    // Get the byte-order mark, if there is one
+    unsigned char bom[4] = {0, 0, 0, 0};
+    if (_begin != _end) std::memcpy(bom, _begin, std::min<size_t>(_region.get_size(), sizeof(bom)));
+    if (hasByteOrderMark(bom))
+        throwUnicodeException();
+}
+
+/** Constructor for the lines in [rangeBegin, rangeEnd) of the file mapped by 'source', parsed as 'source' parses lines -- without skipping
+    records or mapping fields. The range must remain mapped by 'source' while this object reads it. */
+MappedCSVFileDataSource::MappedCSVFileDataSource(const MappedCSVFileDataSource& source, const char * rangeBegin, const char * rangeEnd)
+    : CSVFileDataSource(source._delimiter, source._grouper, 0, false), _begin(rangeBegin), _end(rangeEnd), _cursor(rangeBegin),
+      _line_ends(source._line_ends), _specials(source._specials) {
+    _ignore_empty_fields = source._ignore_empty_fields;
+}
+
+/** Re-positions cursor to beginning of file. */
+void MappedCSVFileDataSource::gotoFirstRecord() {
+    _blank_record_flag = false;
+    _readCount = 0;
+    _cursor = _begin;
+    const char * lineBegin, * lineEnd;
+    for (unsigned long i=0; i < _skip; ++i) {
+        nextLine(lineBegin, lineEnd);
+        ++_readCount;
+    }
+}
+
+/** Returns the number of lines in [rangeBegin, rangeEnd), which must start at the beginning of a line. */
+size_t MappedCSVFileDataSource::countLines(const char * rangeBegin, const char * rangeEnd) const {
+    size_t lines = 0;
+    for (const char * p=rangeBegin; p != rangeEnd; ++lines) {
+        p = _line_ends.find(p, rangeEnd);
+        if (p != rangeEnd && *p++ == '\r' && p != rangeEnd && *p == '\n') ++p;
+    }
+    return lines;
+}
+
+/** Sets the range of the next line, ended by a DOS, UNIX or Mac 9 end of line -- as getlinePortable() reads lines. Returns false at end of file. */
+bool MappedCSVFileDataSource::nextLine(const char *& lineBegin, const char *& lineEnd) {
+    if (_cursor == _end) return false;
+    lineBegin = _cursor;
+    lineEnd = _line_ends.find(_cursor, _end);
+    _cursor = lineEnd;
+    if (_cursor != _end && *_cursor++ == '\r' && _cursor != _end && *_cursor == '\n') ++_cursor;
+    return true;
+}
+
+/** Trims the last value read and drops it if empty where empty fields are ignored. */
+void MappedCSVFileDataSource::finishValue() {
+    std::string& value = _read_values.back();
+    size_t last = value.find_last_not_of(" \t\n\v\f\r");
+    if (last == std::string::npos) {
+        value.clear();
+    } else {
+        value.erase(last + 1);
+        value.erase(0, value.find_first_not_of(" \t\n\v\f\r"));
+    }
+    if (value.empty() && _ignore_empty_fields) _read_values.pop_back();
+}
+
+/** Parses the line in place into the values read, as CSVFileDataSource::parse() does -- a doubled grouping character is a literal grouping
+    character, grouping characters toggle whether delimiters separate values, and values are trimmed of whitespace. Lines which hold the escape
+    sequence CSVFileDataSource::parse() substitutes, or which have grouping strings of several characters, are parsed by that method. Returns
+    indication of whether line contains any words. */
+bool MappedCSVFileDataSource::parse(const char * lineBegin, const char * lineEnd) {
+    _read_values.clear();
+    if (_grouper.size() > 1)
+        return CSVFileDataSource::parse(_line.assign(lineBegin, lineEnd), _read_values, _ignore_empty_fields, _delimiter, _grouper);
+    if (lineBegin == lineEnd) return false;
+    char grouper = _grouper.empty() ? 0 : _grouper[0];
+    bool quoted = false;
+    _read_values.emplace_back();
+    for (const char * p=lineBegin; ; ) {
+        const char * special = _specials.find(p, lineEnd);
+        _read_values.back().append(p, special);
+        if (special == lineEnd) break;
+        p = special;
+        if (*p == _grouper_escape[0] && p + 1 < lineEnd && p[1] == _grouper_escape[1])
+            return CSVFileDataSource::parse(_line.assign(lineBegin, lineEnd), _read_values, _ignore_empty_fields, _delimiter, _grouper);
+        if (!_grouper.empty() && *p == grouper && p + 1 < lineEnd && p[1] == grouper) {
+            _read_values.back().push_back(grouper);
+            p += 2;
+        } else if (_delimiter.find(*p) != std::string::npos) {
+            if (quoted) {
+                _read_values.back().push_back(*p);
+            } else {
+                finishValue();
+                _read_values.emplace_back();
+            }
+            ++p;
+        } else if (!_grouper.empty() && *p == grouper) {
+            quoted = !quoted;
+            ++p;
+        } else {
+            _read_values.back().push_back(*p++);
+        }
+    }
+    finishValue();
+    // if all fields are empty string, then treat this as empty record
+    size_t blanks=0;
+    for (std::vector<std::string>::const_iterator itr=_read_values.begin(); itr != _read_values.end(); ++itr)
+        if (itr->empty()) ++blanks;
+    if (blanks == _read_values.size()) _read_values.clear();
+
+    return _read_values.size() > 0;
+}
+
+/** Attempts to read line from mapped file and parse into 'words'. Lines that contain no words are skipped and scanning continues to next
+    line in file. Returns indication of whether record buffer contains 'words'.*/
+bool MappedCSVFileDataSource::readRecord() {
+    bool isBlank = true;
+    const char * lineBegin, * lineEnd;
+
+    // skip records as necessary
+    for (unsigned long i=static_cast<unsigned long>(_readCount); i < _skip; ++i) {
+        nextLine(lineBegin, lineEnd);
+        ++_readCount;
+    }
+    _read_values.clear();
+    while (isBlank && nextLine(lineBegin, lineEnd)) {
+        try {
+            isBlank = !parse(lineBegin, lineEnd);
+        } catch (boost::escaped_list_error& e) {
+            throw resolvable_error("Unable to parse CSV line:\n%s", _line.assign(lineBegin, lineEnd).c_str());
+        }
+        if (isBlank) {
+            tripBlankRecordFlag();
+            ++_readCount;
+        }
+    }
+    ++_readCount;
+    return _read_values.size() > 0;
+}
+
+//////////////////////////// ChunkedCSVFileDataSource //////////////////////////////////////////////
+
+/** Constructor -- chunks are about 'chunkSize' bytes, extended to the end of a line. */
+ChunkedCSVFileDataSource::ChunkedCSVFileDataSource(const std::string& sSourceFilename, unsigned int threads, const std::string& delimiter, const std::string& grouper,
+                                                   unsigned long skip, bool firstRowHeaders, size_t chunkSize)
+    : MappedCSVFileDataSource(sSourceFilename, delimiter, grouper, skip, firstRowHeaders), _threads(std::max(1U, threads)), _chunk_size(std::max<size_t>(1, chunkSize)),
+      _data_begin(0), _next_chunk(0), _record(0), _lines_before(0) {
+    // the skipped lines are not parsed, records are parsed from the first line after them
+    const char * lineBegin, * lineEnd;
+    for (unsigned long i=0; i < _skip; ++i) nextLine(lineBegin, lineEnd);
+    _data_begin = _cursor;
+    gotoFirstRecord();
+}
+
+/** Parses the records of a chunk, along with the number of lines in the chunk. Called on worker threads. */
+ChunkedCSVFileDataSource::Chunk ChunkedCSVFileDataSource::parseChunk(const char * chunkBegin, const char * chunkEnd) const {
+    Chunk chunk;
+    MappedCSVFileDataSource range(*this, chunkBegin, chunkEnd);
+    try {
+        while (range.readRecord()) {
+            Record record;
+            for (size_t v=0; v < range.getNumValues(); ++v)
+                chunk._values.push_back(std::move(range.getValueAt(static_cast<long>(v))));
+            record._values_end = chunk._values.size();
+            record._record_index = range.getCurrentRecordIndex();
+            record._blank_before = range.detectBlankRecordFlag();
+            range.clearBlankRecordFlag();
+            chunk._records.push_back(record);
+        }
+        chunk._blank_after = range.detectBlankRecordFlag();
+    } catch (...) {
+        chunk._exception = std::current_exception();
+    }
+    chunk._lines = countLines(chunkBegin, chunkEnd);
+    return chunk;
+}
+
+/** Starts parsing chunks until twice as many chunks as threads are being parsed ahead of the current chunk. */
+void ChunkedCSVFileDataSource::scheduleChunks() {
+    while (_parsing.size() < 2 * _threads && _next_chunk != _end) {
+        const char * chunkEnd = _end;
+        if (static_cast<size_t>(_end - _next_chunk) > _chunk_size) {
+            // extend the chunk to the end of the line -- a DOS end of line is not divided between chunks
+            chunkEnd = _line_ends.find(_next_chunk + _chunk_size, _end);
+            if (chunkEnd != _end && *chunkEnd++ == '\r' && chunkEnd != _end && *chunkEnd == '\n') ++chunkEnd;
+        }
+        _parsing.push_back(std::async(std::launch::async, &ChunkedCSVFileDataSource::parseChunk, this, _next_chunk, chunkEnd));
+        _next_chunk = chunkEnd;
+    }
+}
+
+/** Re-positions to the first record of the file. */
+void ChunkedCSVFileDataSource::gotoFirstRecord() {
+    _parsing.clear(); // waits for the chunks being parsed
+    _blank_record_flag = false;
+    _readCount = _skip;
+    _chunk = Chunk();
+    _record = 0;
+    _lines_before = 0;
+    _next_chunk = _data_begin;
+    scheduleChunks();
+}
+
+/** Reads the next record from the parsed chunks, in file order. Returns indication of whether record buffer contains 'words'. */
+bool ChunkedCSVFileDataSource::readRecord() {
+    _read_values.clear();
+    while (_record == _chunk._records.size()) {
+        // the current chunk is read -- note its trailing blank lines and any error parsing it, then move to the next chunk
+        if (_chunk._blank_after) tripBlankRecordFlag();
+        if (_chunk._exception) {
+            std::exception_ptr exception = _chunk._exception;
+            _chunk._exception = std::exception_ptr();
+            std::rethrow_exception(exception);
+        }
+        _lines_before += _chunk._lines;
+        if (_parsing.empty()) {
+            _chunk = Chunk();
+            _record = 0;
+            _readCount = _skip + _lines_before + 1;
+            return false;
+        }
+        _chunk = _parsing.front().get();
+        _parsing.pop_front();
+        _record = 0;
+        scheduleChunks();
+    }
+    const Record& record = _chunk._records[_record];
+    std::vector<std::string>::iterator values = _chunk._values.begin();
+    _read_values.assign(std::make_move_iterator(values + (_record ? _chunk._records[_record - 1]._values_end : 0)), std::make_move_iterator(values + record._values_end));
+    if (record._blank_before) tripBlankRecordFlag();
+    _readCount = _skip + _lines_before + record._record_index;
+    ++_record;
+    return true;
+}
+
 //////////////////////////// SequentialFileDataSource //////////////////////////////////////////////
 
 /** Constructor */
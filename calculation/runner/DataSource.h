@@ -7,6 +7,13 @@
 #include <fstream>
 #include "Parameters.h"
 #include <optional>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <future>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
 
 /** Input data source abstraction. */
 class DataSource {
@@ -31,7 +38,7 @@ class DataSource {
         void                               clearBlankRecordFlag() {_blank_record_flag=false;}
         bool                               detectBlankRecordFlag() const {return _blank_record_flag;}
         virtual size_t                     getCurrentRecordIndex() const = 0;
-        static DataSource                * getNewDataSourceObject(const std::string& sSourceFilename, const Parameters::InputSource * source);
+        static DataSource                * getNewDataSourceObject(const std::string& sSourceFilename, const Parameters::InputSource * source, unsigned int threads=1);
         virtual size_t                     getNumValues() = 0;
         virtual std::string              & getValueAt(long iFieldIndex) = 0;
         virtual void                       gotoFirstRecord() = 0;
@@ -54,6 +61,9 @@ class CSVFileDataSource : public DataSource {
         bool _ignore_empty_fields;
         std::string _read_buffer;
 
+        CSVFileDataSource(const std::string& delimiter, const std::string& grouper, unsigned long skip, bool firstRowHeaders);
+
+        static bool hasByteOrderMark(const unsigned char bom[4]);
         bool parse(std::string& s, std::vector<std::string>& read_values, bool ignore_empty_fields, const std::string& delimiter=",", const std::string& grouper="\"");
         void throwUnicodeException();
 
@@ -68,6 +78,103 @@ class CSVFileDataSource : public DataSource {
         virtual bool                       readRecord();
 };
 
+/** Finds the next byte of a small set, testing eight bytes at a time for any byte of the set before testing byte by byte. */
+class ByteSetFinder {
+    private:
+        std::vector<std::uint64_t> _patterns; // each byte of the set, repeated in every byte of a word
+        bool _members[256];
+
+    public:
+        ByteSetFinder(const std::string& bytes);
+
+        bool contains(char c) const { return _members[static_cast<unsigned char>(c)]; }
+        /* Returns the first position in [p, end) of a byte of the set, or 'end'. */
+        const char * find(const char * p, const char * end) const {
+            const std::uint64_t lows = 0x0101010101010101ULL, highs = 0x8080808080808080ULL;
+            for (; end - p >= 8; p += 8) {
+                std::uint64_t word, found = 0;
+                std::memcpy(&word, p, 8);
+                for (auto pattern: _patterns) {
+                    std::uint64_t x = word ^ pattern; // zero bytes where the word holds this byte of the set
+                    found |= (x - lows) & ~x & highs;
+                }
+                if (found) break;
+            }
+            while (p < end && !contains(*p)) ++p;
+            return p;
+        }
+};
+
+/** CSV file data source which maps the file into memory and parses records in place -- rather than reading each line into a string,
+    escaping it and tokenizing it. Records are parsed as CSVFileDataSource parses them. */
+class MappedCSVFileDataSource : public CSVFileDataSource {
+    protected:
+        boost::interprocess::file_mapping _mapping;
+        boost::interprocess::mapped_region _region;
+        const char * _begin;
+        const char * _end;
+        const char * _cursor;
+        ByteSetFinder _line_ends;
+        ByteSetFinder _specials;
+        std::string _line;
+
+        size_t countLines(const char * rangeBegin, const char * rangeEnd) const;
+        bool nextLine(const char *& lineBegin, const char *& lineEnd);
+        bool parse(const char * lineBegin, const char * lineEnd);
+        void finishValue();
+
+    public:
+        MappedCSVFileDataSource(const std::string& sSourceFilename, const std::string& delimiter=",", const std::string& grouper="\"", unsigned long skip=0, bool firstRowHeaders=false);
+        MappedCSVFileDataSource(const MappedCSVFileDataSource& source, const char * rangeBegin, const char * rangeEnd);
+        virtual ~MappedCSVFileDataSource() {}
+
+        virtual void                       gotoFirstRecord();
+        virtual bool                       readRecord();
+};
+
+/** Memory-mapped CSV file data source which parses line-aligned chunks of the file on worker threads, a few chunks ahead of the record
+    being read. Records are read in file order, with the values, record indexes and blank record flag MappedCSVFileDataSource reads. */
+class ChunkedCSVFileDataSource : public MappedCSVFileDataSource {
+    public:
+        static const size_t DEFAULT_CHUNK_SIZE = 4 * 1024 * 1024;
+
+    protected:
+        struct Record {
+            size_t _values_end;     // end of the record's values in the chunk values
+            size_t _record_index;   // record index within the chunk
+            bool _blank_before;     // whether blank lines preceded the record within the chunk
+        };
+        struct Chunk {
+            std::vector<std::string> _values;
+            std::vector<Record> _records;
+            size_t _lines;
+            bool _blank_after;
+            std::exception_ptr _exception; // raised parsing the record after the last record
+
+            Chunk() : _lines(0), _blank_after(false) {}
+        };
+
+        unsigned int _threads;
+        size_t _chunk_size;
+        const char * _data_begin;   // first line after the skipped lines
+        const char * _next_chunk;   // start of the next chunk to parse
+        std::deque<std::future<Chunk> > _parsing;
+        Chunk _chunk;
+        size_t _record;
+        size_t _lines_before;       // lines in the chunks before the current chunk
+
+        Chunk parseChunk(const char * chunkBegin, const char * chunkEnd) const;
+        void scheduleChunks();
+
+    public:
+        ChunkedCSVFileDataSource(const std::string& sSourceFilename, unsigned int threads, const std::string& delimiter=",", const std::string& grouper="\"",
+                                 unsigned long skip=0, bool firstRowHeaders=false, size_t chunkSize=DEFAULT_CHUNK_SIZE);
+        virtual ~ChunkedCSVFileDataSource() {}
+
+        virtual void                       gotoFirstRecord();
+        virtual bool                       readRecord();
+};
+
 /** Sequential scan file data source. */
 class SequentialFileDataSource : public CSVFileDataSource {
     public:
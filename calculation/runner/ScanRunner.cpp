@@ -1,5 +1,6 @@
 
 #include <numeric>
+#include <atomic>
 #include <boost/tokenizer.hpp>
 #include <boost/regex.hpp>
 #include <boost/property_tree/ptree.hpp>
@@ -508,6 +509,63 @@ Parameters::ScanRateType CutStructure::getRate(const ScanRunner& scanner) const
     };
 }
 
+////////////////////////// BestCutTable ///////////////////////////////////////
+
+/** Constructor -- a slot per node, or, for time-only scans, slots added as window end indexes are recorded (time-only scans being
+    scanned on one thread). */
+BestCutTable::BestCutTable(size_t num_nodes, const Parameters& parameters)
+    : _model_type(parameters.getModelType()), _scan_rate(parameters.getScanRateType()), _by_end_index(parameters.getScanType() == Parameters::TIMEONLY),
+      _loglikelihoods(_by_end_index ? 0 : num_nodes), _cuts(_by_end_index ? 0 : num_nodes, 0) {}
+
+BestCutTable::~BestCutTable() {
+    for (auto cut : _cuts) delete cut;
+}
+
+/* Returns whether log likelihood 'loglikelihood' is better than 'best'. Signed rank cuts compare by the rate of interest, higher log
+   likelihoods being better otherwise. */
+bool BestCutTable::isBetter(double loglikelihood, double best) const {
+    if (_model_type == Parameters::SIGNED_RANK) {
+        switch (_scan_rate) {
+            case Parameters::LOWRATE: return loglikelihood < best;
+            case Parameters::HIGHORLOWRATE: return std::abs(loglikelihood) > std::abs(best);
+            case Parameters::HIGHRATE:
+            default: return loglikelihood > best;
+        }
+    }
+    return loglikelihood > best;
+}
+
+/** Returns the cut of the slot of 'node_index' (or of 'endIdx' for time-only scans), cleared of cut children and set to 'loglikelihood',
+    when it is the slot's first cut or better than the slot's cut -- for the caller to set the remaining attributes. Otherwise returns zero. */
+CutStructure * BestCutTable::update(size_t node_index, DataTimeRange::index_t endIdx, double loglikelihood) {
+    size_t slot = _by_end_index ? static_cast<size_t>(endIdx) : node_index;
+    if (_by_end_index && slot >= _cuts.size()) {
+        _loglikelihoods.resize(slot + 1);
+        _cuts.resize(slot + 1, 0);
+    }
+    CutStructure *& cut = _cuts[slot];
+    if (!cut)
+        cut = new CutStructure();
+    else if (isBetter(loglikelihood, _loglikelihoods[slot]))
+        cut->clearCutChildren();
+    else
+        return 0;
+    _loglikelihoods[slot] = loglikelihood;
+    cut->setLogLikelihood(loglikelihood);
+    return cut;
+}
+
+/** Moves the recorded cuts to 'cuts' -- ordered by descending node index, or by ascending end index for time-only scans. */
+void BestCutTable::release(ptr_vector<CutStructure>& cuts) {
+    if (_by_end_index) {
+        for (auto& cut : _cuts)
+            if (cut) { cuts.push_back(cut); cut = 0; }
+    } else {
+        for (auto itr=_cuts.rbegin(); itr != _cuts.rend(); ++itr)
+            if (*itr) { cuts.push_back(*itr); *itr = 0; }
+    }
+}
+
 ////////////////////////// NodeStructure //////////////////////////////////////
 
 /* Adds sample site data to node, skipping add and returning false when data already exists for sample site. */
@@ -518,6 +576,131 @@ bool NodeStructure::addSampleSiteData(size_t ssIdx, double baseline_proportion,
     return true;
 }
 
+////////////////////////// BranchAggregation ////////////////////////////////
+
+BranchAggregation::BranchAggregation(const ptr_vector<NodeStructure>& nodes) {
+    // Order nodes such that each node follows all of its children - starting from the leaves, a parent is ready once all its children are placed.
+    std::vector<size_t> pending(nodes.size());
+    std::deque<unsigned int> ready;
+    for (size_t i=0; i < nodes.size(); ++i) {
+        pending[i] = nodes[i]->getChildren().size();
+        if (pending[i] == 0) ready.push_back(static_cast<unsigned int>(i));
+    }
+    Indexes_t order;
+    order.reserve(nodes.size());
+    while (!ready.empty()) {
+        unsigned int id = ready.front();
+        ready.pop_front();
+        order.push_back(id);
+        for (const auto& parent: nodes[id]->getParents()) {
+            if (--pending[parent.first->getID()] == 0)
+                ready.push_back(static_cast<unsigned int>(parent.first->getID()));
+        }
+    }
+    // In a tree without multiple parents, every branch total is the node's own data plus the branch totals of its children.
+    boost::dynamic_bitset<> from_children(nodes.size());
+    from_children.set();
+    std::vector<Indexes_t> descendants;
+    if (std::any_of(nodes.begin(), nodes.end(), [](const NodeStructure * node) { return node->getParents().size() > 1; })) {
+        // Visits each distinct ancestor of node (node included) once, regardless of how many paths lead to it.
+        boost::dynamic_bitset<> visited(nodes.size());
+        Indexes_t stack;
+        auto visitAncestors = [&nodes, &visited, &stack](unsigned int node, auto visit) {
+            visited.reset();
+            stack.assign(1, node);
+            while (!stack.empty()) {
+                unsigned int id = stack.back();
+                stack.pop_back();
+                if (visited.test_set(id)) continue;
+                visit(id);
+                for (const auto& parent: nodes[id]->getParents())
+                    stack.push_back(static_cast<unsigned int>(parent.first->getID()));
+            }
+        };
+        // Summing children branch totals is only correct when the children have no descendants in common, which is the
+        // case when the node's distinct descendant count equals one plus the sum of its children's descendant counts.
+        std::vector<size_t> num_descendants(nodes.size(), 0);
+        for (unsigned int i=0; i < nodes.size(); ++i)
+            visitAncestors(i, [&num_descendants](unsigned int a) { ++num_descendants[a]; });
+        for (size_t i=0; i < nodes.size(); ++i) {
+            size_t children_descendants = 1;
+            for (const auto& child: nodes[i]->getChildren())
+                children_descendants += num_descendants[child->getID()];
+            from_children.set(i, children_descendants == num_descendants[i]);
+        }
+        // Otherwise the node sums the data of its distinct descendants directly.
+        descendants.resize(nodes.size());
+        for (unsigned int i=0; i < nodes.size(); ++i)
+            visitAncestors(i, [&from_children, &descendants, i](unsigned int a) { if (!from_children.test(a)) descendants[a].push_back(i); });
+    }
+    _steps.reserve(order.size());
+    for (auto id: order) {
+        size_t begin = _sources.size();
+        if (from_children.test(id)) {
+            for (const auto& child: nodes[id]->getChildren())
+                _sources.push_back(static_cast<unsigned int>(child->getID()));
+        } else
+            _sources.insert(_sources.end(), descendants[id].begin(), descendants[id].end());
+        _steps.push_back(Step(id, from_children.test(id), begin, _sources.size()));
+    }
+}
+
+////////////////////////// CutPlan ////////////////////////////////
+
+/** Compiles the cuts of each evaluated node, in the order the scans have always evaluated them. The signed rank model skips root
+    nodes and has no expected counts. */
+CutPlan::CutPlan(const ptr_vector<NodeStructure>& nodes, const Parameters& parameters) {
+    bool signedRank = parameters.getModelType() == Parameters::SIGNED_RANK;
+    auto BrN = [signedRank](const NodeStructure * node) { return signedRank ? 0.0 : node->getBrN(); };
+    for (size_t n=0; n < nodes.size(); ++n) {
+        const NodeStructure& thisNode(*nodes[n]);
+        if (!thisNode.isEvaluated() || (signedRank && thisNode.getLevel() == 1)) continue;
+        size_t begin = _cuts.size();
+        // always do simple cut
+        addCut({&thisNode}, false, BrN(&thisNode));
+        const NodeStructure::ChildContainer_t& children(thisNode.getChildren());
+        Parameters::CutType cutType = children.size() >= 2 ? thisNode.getCutType() : Parameters::SIMPLE;
+        switch (cutType) {
+            case Parameters::SIMPLE: break; // already done, regardless of specified node cut
+            case Parameters::ORDINAL:
+                // Ordinal cuts: ABCD -> AB, ABC, ABCD, BC, BCD, CD
+                for (size_t i=0; i < children.size() - 1; ++i) {
+                    double sumBranchN = BrN(children[i]) + BrN(children[i + 1]);
+                    addCut({children[i], children[i + 1]}, false, sumBranchN);
+                    for (size_t j=i+2; j < children.size(); ++j) {
+                        sumBranchN += BrN(children[j]);
+                        addCut({children[j]}, true, sumBranchN);
+                    }
+                } break;
+            case Parameters::PAIRS:
+            case Parameters::TRIPLETS:
+                // Pair cuts: ABCD -> AB, AC, AD, BC, BD, CD
+                // Triple cuts: ABCD -> AB, AC, ABC, AD, ABD, ACD, BC, BD, BCD, CD
+                for (size_t i=0; i < children.size() - 1; ++i) {
+                    for (size_t j=i+1; j < children.size(); ++j) {
+                        addCut({children[i], children[j]}, false, BrN(children[i]) + BrN(children[j]));
+                        if (cutType == Parameters::PAIRS) continue;
+                        for (size_t k=i+1; k < j; ++k)
+                            addCut({children[i], children[j], children[k]}, false, BrN(children[i]) + BrN(children[k]) + BrN(children[j]));
+                    }
+                } break;
+            case Parameters::COMBINATORIAL:
+            default: throw prg_error("Unknown cut type (%d).", "CutPlan()", cutType);
+        }
+        _nodes.push_back(Node(static_cast<unsigned int>(n), begin, _cuts.size()));
+    }
+}
+
+void CutPlan::addCut(std::initializer_list<const NodeStructure*> nodes, bool extends, double BrN) {
+    Cut cut;
+    cut._size = 0;
+    for (const NodeStructure * node : nodes)
+        cut._nodes[cut._size++] = static_cast<unsigned int>(node->getID());
+    cut._extends = extends;
+    cut._BrN = BrN;
+    _cuts.push_back(cut);
+}
+
 ////////////////////////// SequentialStatistic ///////////////////////////////
 
 const char * SequentialStatistic::_file_suffix = "_sequential";
@@ -619,17 +802,18 @@ SequentialStatistic::SequentialStatistic(const Parameters& parameters, const Sca
             throw resolvable_error("Error: The minimum high rates cases setting (%u) does match setting in previous sequential scan (%u).",
                 _parameters.getMinimumHighRateNodeCases(), _statistic_parameters.getMinimumHighRateNodeCases()
             );
-        // Calculate the size of _llr_sims based upon this looks alpha spending.
-        for (boost::dynamic_bitset<>::size_type i = 0; i < _alpha_simulations.size(); ++i) {
-            // Test whether simulation was marked in last look as being within previous alpha spending.
-            if (_alpha_simulations.test(i))
-                // Once a simulation is marked, it remains marked. So add to list with max double as LLR.
-                _llr_sims.push_back(std::make_pair(std::numeric_limits<double>::max(), static_cast<unsigned int>(i) + 1));
-        }
     }
     _alpha_simulations.resize(_parameters.getNumReplicationsRequested());
+    // Calculate the size of _llr_sims based upon this looks alpha spending.
     size_t alpha_spending_size = static_cast<size_t>(ceil(static_cast<double>(_parameters.getNumReplicationsRequested() + 1) * _alpha_spending));
-    _llr_sims.resize(alpha_spending_size, std::make_pair(0,0));
+    _llr_sims = llr_sim_container_t(alpha_spending_size);
+    for (boost::dynamic_bitset<>::size_type i = 0; i < _alpha_simulations.size(); ++i) {
+        // Test whether simulation was marked in last look as being within previous alpha spending.
+        if (_alpha_simulations.test(i))
+            // Once a simulation is marked, it remains marked. So add to list with max double as LLR.
+            _llr_sims.add(std::make_pair(std::numeric_limits<double>::max(), static_cast<unsigned int>(i) + 1));
+    }
+    while (!_llr_sims.full()) _llr_sims.add(std::make_pair(0.0, 0U));
     _alpha_spendings.push_back(_parameters.getSequentialAlphaSpending());
     // Now rename primary results file to include look number.
     remove(_parameters.getOutputFileName().c_str()); // remove the initial parameter filename, which might have been created during parameters validation
@@ -642,13 +826,7 @@ bool SequentialStatistic::addSimulationLLR(double llr, unsigned int simIdx) {
         return true;
 
     // Attempt to insert current simulation llr into top ranking while maintaining the alpha spending limit.
-    llr_sim_t add_llr_sim(llr, simIdx);
-    llr_sim_container_t::iterator itr = std::upper_bound(_llr_sims.begin(), _llr_sims.end(), add_llr_sim, compare_llr_sim_t());
-    if (itr != _llr_sims.end()) {
-        _llr_sims.insert(itr, add_llr_sim);
-        _llr_sims.pop_back();
-        return true;
-    } return false;
+    return _llr_sims.add(llr_sim_t(llr, simIdx));
 }
 
 std::string& SequentialStatistic::keyEscapeXML(std::string& key, const std::string& to, const std::string& from) const {
@@ -790,7 +968,8 @@ void SequentialStatistic::writeSettings(const std::string &filename) {
 
 void SequentialStatistic::write(const std::string &casefilename, const std::string &controlfilename) {
     _alpha_simulations.reset();
-    for (llr_sim_container_t::iterator itr=_llr_sims.begin(); itr != _llr_sims.end(); ++itr) {
+    llr_sim_container_t::container_t llr_sims(_llr_sims.getSorted());
+    for (llr_sim_container_t::container_t::iterator itr=llr_sims.begin(); itr != llr_sims.end(); ++itr) {
         if (itr->second == 0)
             break;
         _alpha_simulations.set(itr->second - 1);
@@ -903,6 +1082,14 @@ std::shared_ptr<AbstractWindowLength> ScanRunner::getNewWindowLength() const {
     return std::shared_ptr<AbstractWindowLength>(new WindowLength(_parameters, static_cast<int>(_parameters.getMinimumWindowLength()) - 1, static_cast<int>(_parameters.getMaximumWindowInTimeUnits()) - 1));
 }
 
+/** Returns the windows scanned by the uniform temporal scan conditioned on the node, with the zero index offset already incorporated. */
+TemporalWindowScan ScanRunner::getTemporalWindowScan() const {
+    DataTimeRange startWindow(temporalStartRange().getStart() + _zero_translation_additive, temporalStartRange().getEnd() + _zero_translation_additive),
+                  endWindow(temporalEndRange().getStart() + _zero_translation_additive, temporalEndRange().getEnd() + _zero_translation_additive);
+    std::shared_ptr<AbstractWindowLength> window(getNewWindowLength());
+    return TemporalWindowScan(startWindow, endWindow, *window, _parameters.isApplyingExclusionTimeRanges() ? &_window_exclusions : 0);
+}
+
 /** Returns the number if window indexes in range which are excluded. */
 unsigned int ScanRunner::getNumExclusionsInWindow(DataTimeRange::index_t start, DataTimeRange::index_t end) const {
 	unsigned int count = 0;
@@ -942,18 +1129,45 @@ unsigned int ScanRunner::addCN_C(const NodeStructure& sourceNode, NodeStructure&
     return source_count;
 }
 
+/** Indexes the identifiers of 'nodes' -- the slots are kept at most half full so that probe sequences stay short. */
+void NodeIdentifierIndex::build(const ptr_vector<NodeStructure>& nodes) {
+    size_t size = 8;
+    while (size < 2 * nodes.size()) size <<= 1;
+    _slots.assign(size, 0);
+    _mask = size - 1;
+    std::hash<std::string> hash;
+    for (size_t i=0; i < nodes.size(); ++i) {
+        size_t slot = hash(nodes[i]->getIdentifier()) & _mask;
+        while (_slots[slot]) slot = (slot + 1) & _mask;
+        _slots[slot] = i + 1;
+    }
+}
+
+/** Returns pair<bool,size_t> - first value indicates whether 'identifier' is indexed, second is its position in 'nodes'. */
+std::pair<bool,size_t> NodeIdentifierIndex::find(const ptr_vector<NodeStructure>& nodes, const std::string& identifier) const {
+    if (_slots.empty()) return std::make_pair(false, 0);
+    for (size_t slot=std::hash<std::string>()(identifier) & _mask; _slots[slot]; slot = (slot + 1) & _mask) {
+        if (nodes[_slots[slot] - 1]->getIdentifier() == identifier)
+            return std::make_pair(true, _slots[slot] - 1);
+    }
+    return std::make_pair(false, 0);
+}
+
 /** Returns pair<bool,size_t> - first value indicates node existence, second is index into class vector _Nodes. */
 ScanRunner::Index_t ScanRunner::getNodeIndex(const std::string& identifier) const {
-    std::unique_ptr<NodeStructure> node(new NodeStructure(identifier));
-    auto itr = std::lower_bound(_Nodes.begin(), _Nodes.end(), node.get(), CompareNodeStructureByIdentifier());
-    if (itr != _Nodes.end() && (*itr)->getIdentifier() == node.get()->getIdentifier()) {
-        size_t tt = std::distance(_Nodes.begin(), itr);
-        // sanity check
-        if (tt != static_cast<size_t>((*itr)->getID()))
-            throw prg_error("Calculated index (%u) does not match node ID (%u).", "RelativeRiskAdjustmentHandler::getAsProbabilities()", tt, (*itr)->getID());
-        return std::make_pair(true, std::distance(_Nodes.begin(), itr));
-    } else
-        return std::make_pair(false, 0);
+    return _node_index.find(_Nodes, identifier);
+}
+
+/** Returns the bottom-up order for adding node data into branch totals - built by setupTree() or on first request. */
+const BranchAggregation& ScanRunner::getBranchAggregation() const {
+    if (!_branch_aggregation.get()) _branch_aggregation.reset(new BranchAggregation(_Nodes));
+    return *_branch_aggregation.get();
+}
+
+/** Returns the cuts evaluated in scanning the tree - built by setupTree() or on first request. */
+const CutPlan& ScanRunner::getCutPlan() const {
+    if (!_cut_plan.get()) _cut_plan.reset(new CutPlan(_Nodes, _parameters));
+    return *_cut_plan.get();
 }
 
 /** Returns tree statistics information. */
@@ -1165,10 +1379,12 @@ bool ScanRunner::readCounts(const std::string& srcfilename, bool sequence_new_da
     DataTimeRange::index_t censortimetotal = 0;
     std::string filename("count"), time_columnname(_parameters.getDatePrecisionType() == DataTimeRange::GENERIC ? "day since incidence" : "occurance date");
     // Determine the InputSource for this count file. Typically we just want that defined through the Parameters, but when we're
-    // reading accumulated case data in a sequentual scan, the format of the stored data is fixed as CSV.
+    // reading accumulated case data in a sequentual scan, the format of the stored data is fixed as CSV. The file is parsed on the
+    // parallel processes while records are read, in file order, below.
     Parameters::InputSource csvSource(CSV, FieldMapContainer_t());
     std::unique_ptr<DataSource> dataSource(DataSource::getNewDataSourceObject(
-        srcfilename, (_parameters.isSequentialScanTreeOnly() && !sequence_new_data ? &csvSource : _parameters.getInputSource(Parameters::COUNT_FILE))
+        srcfilename, (_parameters.isSequentialScanTreeOnly() && !sequence_new_data ? &csvSource : _parameters.getInputSource(Parameters::COUNT_FILE)),
+        _parameters.getNumParallelProcessesToExecute()
     ));
 
     /** In TreeScan version 2.0, we switched to a separate control data file and removed the control column from counts file.
@@ -1715,10 +1931,12 @@ bool ScanRunner::readControls(const std::string& srcfilename, bool sequence_new_
     bool readSuccess = true, controlDateWarningDisplayed = false;
     std::string filename("control"), time_columnname(_parameters.getDatePrecisionType() == DataTimeRange::GENERIC ? "day since incidence" : "occurance date");
     // Determine the InputSource for this control file. Typically we just want that defined through the Parameters, but when we're
-    // reading accumulated control data in a sequential scan, the format of the stored data is fixed as CSV.
+    // reading accumulated control data in a sequential scan, the format of the stored data is fixed as CSV. The file is parsed on the
+    // parallel processes while records are read, in file order, below.
     Parameters::InputSource csvSource(CSV, FieldMapContainer_t());
     std::unique_ptr<DataSource> dataSource(DataSource::getNewDataSourceObject(
-        srcfilename, (_parameters.isSequentialScanTreeOnly() && !sequence_new_data ? &csvSource : _parameters.getInputSource(Parameters::CONTROL_FILE))
+        srcfilename, (_parameters.isSequentialScanTreeOnly() && !sequence_new_data ? &csvSource : _parameters.getInputSource(Parameters::CONTROL_FILE)),
+        _parameters.getNumParallelProcessesToExecute()
     ));
     int controls = 0, daysSinceIncidence = 0; size_t expectedColumns = (_parameters.getScanType() == Parameters::TREETIME ? 3 : 2);
     long identifierIdx = _parameters.getScanType() == Parameters::TIMEONLY ? -1 : 0;
@@ -1914,6 +2132,7 @@ bool ScanRunner::readTree(const std::string& filename, unsigned int treeOrdinal)
     if (_parameters.getScanType() == Parameters::TIMEONLY) {
         std::unique_ptr<NodeStructure> node(new NodeStructure("All", _parameters, daysInDataTimeRange));
         _Nodes.insert(_Nodes.begin(), node.release());
+        _node_index.build(_Nodes);
         return true;
     }
 
@@ -1924,7 +2143,18 @@ bool ScanRunner::readTree(const std::string& filename, unsigned int treeOrdinal)
     bool readSuccess=true;
     std::unique_ptr<DataSource> dataSource(DataSource::getNewDataSourceObject(filename, _parameters.getInputSource(Parameters::TREE_FILE)));
 
-    // first collect all nodes -- this will allow the referencing of parent nodes not yet encountered
+    // Read the records in a single pass, collecting the edges and the identifiers not yet known -- this will allow the referencing of
+    // parent nodes not yet encountered.
+    struct TreeRecord {
+        size_t _record_index;
+        size_t _num_values;
+        std::string _identifier;
+        std::string _parent;
+        std::string _distance;
+        std::string _name;
+    };
+    std::vector<TreeRecord> records;
+    std::vector<std::string> identifiers;
     while (dataSource->readRecord()) {
         if (dataSource->getNumValues() > 4) {
             readSuccess = false;
@@ -1933,16 +2163,31 @@ bool ScanRunner::readTree(const std::string& filename, unsigned int treeOrdinal)
             );
             continue;
         }
-        std::string identifier = dataSource->getValueAt(0);
-        std::unique_ptr<NodeStructure> node(new NodeStructure(trimString(identifier), _parameters, daysInDataTimeRange));
-        NodeStructureContainer_t::iterator itr = std::lower_bound(_Nodes.begin(), _Nodes.end(), node.get(), CompareNodeStructureByIdentifier());
-        if (itr == _Nodes.end() || (*itr)->getIdentifier() != node.get()->getIdentifier())
-            _Nodes.insert(itr, node.release());
+        TreeRecord record;
+        record._record_index = dataSource->getCurrentRecordIndex();
+        record._num_values = dataSource->getNumValues();
+        record._identifier = dataSource->getValueAt(0);
+        trimString(record._identifier);
+        record._parent = dataSource->getValueAt(1);
+        record._distance = record._num_values >= 3 ? dataSource->getValueAt(2) : "1";
+        if (record._num_values == 4) record._name = dataSource->getValueAt(3);
+        if (!getNodeIndex(record._identifier).first) identifiers.push_back(record._identifier);
+        records.push_back(record);
     }
 
     // stop reading tree file if we've already determined there are problems in the file.
     if (!readSuccess) return readSuccess;
 
+    // add the new nodes, keeping all nodes ordered by identifier
+    std::sort(identifiers.begin(), identifiers.end());
+    identifiers.erase(std::unique(identifiers.begin(), identifiers.end()), identifiers.end());
+    size_t numExisting = _Nodes.size();
+    _Nodes.reserve(numExisting + identifiers.size());
+    for (auto& identifier: identifiers)
+        _Nodes.push_back(new NodeStructure(identifier, _parameters, daysInDataTimeRange));
+    std::inplace_merge(_Nodes.begin(), _Nodes.begin() + numExisting, _Nodes.end(), CompareNodeStructureByIdentifier());
+    _node_index.build(_Nodes);
+
     // reset node identifiers to ordinal position in vector -- this is to keep the original algorithm intact since it uses vector indexes heavily
     for (size_t i=0; i < _Nodes.size(); ++i) _Nodes[i]->setID(static_cast<int>(i));
 
@@ -1950,50 +2195,40 @@ bool ScanRunner::readTree(const std::string& filename, unsigned int treeOrdinal)
     boost::dynamic_bitset<> nodesWithParents(_Nodes.size());
 
     // now set parent/children nodes
-    dataSource->gotoFirstRecord();
-    while (dataSource->readRecord()) {
-        std::string record_value;
-        ScanRunner::Index_t index = getNodeIndex(dataSource->getValueAt(0));
+    for (auto& record: records) {
+        ScanRunner::Index_t index = getNodeIndex(record._identifier);
         NodeStructure * node = _Nodes[index.second];
         // Read optional node name in fourth column.
-        if (dataSource->getNumValues() == 4) {
-            record_value = dataSource->getValueAt(3);
-            if (!record_value.empty()) {
-                node->setName(record_value);
-                _has_node_descriptions = true;
-            }
+        if (!record._name.empty()) {
+            node->setName(record._name);
+            _has_node_descriptions = true;
         }
         // Read optional parent node.
-        record_value = dataSource->getValueAt(1);
-        if (dataSource->getNumValues() == 1 || record_value.empty())
+        if (record._num_values == 1 || record._parent.empty())
             continue;
-        index = getNodeIndex(record_value);
+        index = getNodeIndex(record._parent);
         if (!index.first) {
             readSuccess = false;
-            _print.Printf("Error: Record %ld in tree file has unknown parent node (%s).\n", BasePrint::P_READERROR, dataSource->getCurrentRecordIndex(), record_value.c_str());
+            _print.Printf("Error: Record %ld in tree file has unknown parent node (%s).\n", BasePrint::P_READERROR, record._record_index, record._parent.c_str());
         }
         // test that node does not reference itself as parent
         if (node->getID() == static_cast<int>(index.second)) {
             readSuccess = false;
-            _print.Printf("Error: Record %ld in tree file has node referencing self as parent (%s).\n", BasePrint::P_READERROR, dataSource->getCurrentRecordIndex(), record_value.c_str());
+            _print.Printf("Error: Record %ld in tree file has node referencing self as parent (%s).\n", BasePrint::P_READERROR, record._record_index, record._parent.c_str());
             continue;
         }
         // Read optional distance column or assign default.
-        record_value = "1";
-        if (dataSource->getNumValues() >= 3) {
-            record_value = dataSource->getValueAt(2);
-            double distanceBetween = 1.0;
-            if (!record_value.empty() && (!string_to_numeric_type<double>(record_value.c_str(), distanceBetween) || distanceBetween < 0.0)) {
-                readSuccess = false;
-                _print.Printf(
-                    "Error: Record %ld in tree file references an invalid distance between nodes.\n"
-                    "The distance must be a value greater than zero.\n", BasePrint::P_READERROR, dataSource->getCurrentRecordIndex()
-                );
-                continue;
-            }
+        double distanceBetween = 1.0;
+        if (!record._distance.empty() && (!string_to_numeric_type<double>(record._distance.c_str(), distanceBetween) || distanceBetween < 0.0)) {
+            readSuccess = false;
+            _print.Printf(
+                "Error: Record %ld in tree file references an invalid distance between nodes.\n"
+                "The distance must be a value greater than zero.\n", BasePrint::P_READERROR, record._record_index
+            );
+            continue;
         }
         // Add node as parent.
-        node->addAsParent(*_Nodes[index.second], record_value.empty() ? "1" : record_value);
+        node->addAsParent(*_Nodes[index.second], record._distance.empty() ? "1" : record._distance);
         nodesWithParents.set(node->getID());
         // Detect nodes with multiple parents.
         if (node->getParents().size() > 1) {
@@ -2001,7 +2236,7 @@ bool ScanRunner::readTree(const std::string& filename, unsigned int treeOrdinal)
             if (!_parameters.getAllowMultiParentNodes()) {
                 readSuccess = false;
                 _print.Printf("Error: Record %ld in tree file defines a node that is already defined with a different parent.\n"
-                              "Set 'Allow Multiple Parents for the Same Node' in advanced input parameters if this is intended.\n", BasePrint::P_READERROR, dataSource->getCurrentRecordIndex());
+                              "Set 'Allow Multiple Parents for the Same Node' in advanced input parameters if this is intended.\n", BasePrint::P_READERROR, record._record_index);
                 continue;
             }
         }
@@ -2535,8 +2770,8 @@ bool ScanRunner::runsimulations(std::shared_ptr<AbstractRandomizer> randomizer,
     try {
         PrintQueue lclPrintDirection(_print, false);
         MCSimJobSource jobSource(::GetCurrentTime_HighResolution(), lclPrintDirection, sReplicationFormatString, *this, num_relica, isPowerStep, iteration);
-        typedef contractor<MCSimJobSource> contractor_type;
-        contractor_type theContractor(jobSource);
+        typedef chunked_contractor<MCSimJobSource> contractor_type;
+        contractor_type theContractor(jobSource, num_relica, static_cast<unsigned int>(ulParallelProcessCount));
 
         std::deque<std::shared_ptr<AbstractRandomizer> > _randomizers;
         _randomizers.push_back(randomizer);
@@ -2550,7 +2785,7 @@ bool ScanRunner::runsimulations(std::shared_ptr<AbstractRandomizer> randomizer,
         for (unsigned u=0; u < ulParallelProcessCount; ++u) {
             try {
                 MCSimSuccessiveFunctor mcsf(thread_mutex, _randomizers.at(u), *this);
-                tg.create_thread(subcontractor<contractor_type,MCSimSuccessiveFunctor>(theContractor,mcsf));
+                tg.create_thread(chunked_subcontractor<contractor_type,MCSimSuccessiveFunctor>(theContractor,mcsf));
             } catch (std::bad_alloc &) {
                 if (u == 0) throw; // if this is the first thread, re-throw exception
                 _print.Printf("Notice: Insufficient memory to create %u%s parallel simulation ... continuing analysis with %u parallel simulations.\n", BasePrint::P_NOTICE, u + 1, (u == 1 ? "nd" : (u == 2 ? "rd" : "th")), u);
@@ -2572,6 +2807,9 @@ bool ScanRunner::runsimulations(std::shared_ptr<AbstractRandomizer> randomizer,
         jobSource.Assert_NoExceptionsCaught();
         if (jobSource.GetUnregisteredJobCount() > 0)
             throw prg_error("At least %d jobs remain uncompleted.", "ScanRunner", jobSource.GetUnregisteredJobCount());
+        jobSource.ResolveCutRanks();
+        // finish writing simulation data still queued by the randomizers
+        randomizer->closeWriting();
     } catch (prg_exception& x) {
         x.addTrace("runsimulations()","ScanRunner");
         throw;
@@ -2587,9 +2825,6 @@ bool ScanRunner::runsequentialsimulations(unsigned int num_relica) {
     try {
         PrintQueue lclPrintDirection(_print, false);
         MCSimJobSource jobSource(::GetCurrentTime_HighResolution(), lclPrintDirection, sReplicationFormatString, *this, num_relica, false);
-        typedef contractor<MCSimJobSource> contractor_type;
-        contractor_type theContractor(jobSource);
-
         std::shared_ptr<SequentialFileDataSource> source;
         std::shared_ptr<SequentialScanLoglikelihoodRatioWriter> sequential_writer;
         std::string buffer;
@@ -2601,6 +2836,8 @@ bool ScanRunner::runsequentialsimulations(unsigned int num_relica) {
         } else {
             sequential_writer.reset(new SequentialScanLoglikelihoodRatioWriter(*this));
         }
+        typedef chunked_contractor<MCSimJobSource> contractor_type;
+        contractor_type theContractor(jobSource, num_relica, static_cast<unsigned int>(ulParallelProcessCount));
 
         // run threads:
         boost::thread_group tg;
@@ -2609,10 +2846,10 @@ bool ScanRunner::runsequentialsimulations(unsigned int num_relica) {
             try {
                 if (source.get()) {
                     SequentialReadMCSimSuccessiveFunctor mcsf(thread_mutex, *this, source);
-                    tg.create_thread(subcontractor<contractor_type,SequentialReadMCSimSuccessiveFunctor>(theContractor,mcsf));
+                    tg.create_thread(chunked_subcontractor<contractor_type,SequentialReadMCSimSuccessiveFunctor>(theContractor,mcsf));
                 } else {
                     SequentialMCSimSuccessiveFunctor mcsf(thread_mutex, *this, sequential_writer);
-                    tg.create_thread(subcontractor<contractor_type,SequentialMCSimSuccessiveFunctor>(theContractor,mcsf));
+                    tg.create_thread(chunked_subcontractor<contractor_type,SequentialMCSimSuccessiveFunctor>(theContractor,mcsf));
                 }
             } catch (std::bad_alloc &) {
                 if (u == 0) throw; // if this is the first thread, re-throw exception
@@ -2635,6 +2872,7 @@ bool ScanRunner::runsequentialsimulations(unsigned int num_relica) {
         jobSource.Assert_NoExceptionsCaught();
         if (jobSource.GetUnregisteredJobCount() > 0)
             throw prg_error("At least %d jobs remain uncompleted.", "ScanRunner", jobSource.GetUnregisteredJobCount());
+        jobSource.ResolveCutRanks();
     } catch (prg_exception& x) {
         x.addTrace("runsequentialsimulations()","ScanRunner");
         throw;
@@ -2663,82 +2901,77 @@ size_t ScanRunner::calculateCutsCount() const {
     return cuts;
 }
 
+/** Scans the items 0 through 'num_items' - 1 (nodes, or cut plan nodes) by calling 'scan'(first, last, cuts, logCalculator) over ranges of
+    consecutive items -- in parallel when running more than one thread -- then moves the best cuts to _Cut. The threads record their
+    cuts in one table of best cuts by node, each node being scanned within a single range, so the cuts kept (including which of
+    equally good cuts) are those of the serial scan. Time-only scans keep their cuts by window end index, which nodes share, so are
+    scanned on one thread. */
+template <typename ScanItems>
+void ScanRunner::scanNodes(size_t num_items, ScanItems scan) {
+    BestCutTable cuts(_Nodes.size(), _parameters);
+    unsigned int threads = _parameters.getScanType() == Parameters::TIMEONLY ? 1 :
+        static_cast<unsigned int>(std::min<size_t>(_parameters.getNumParallelProcessesToExecute(), num_items));
+    if (threads < 2) {
+        Loglikelihood_t calcLogLikelihood(AbstractLoglikelihood::getNewLoglikelihood(*this));
+        scan(0, num_items, cuts, calcLogLikelihood);
+    } else {
+        // Several ranges per thread, taken in turn, since nodes differ widely in their numbers of cuts and windows.
+        size_t num_ranges = std::min<size_t>(num_items, static_cast<size_t>(threads) * 16);
+        std::vector<std::exception_ptr> exceptions(threads);
+        std::atomic<size_t> next_range(0);
+        boost::thread_group tg;
+        for (unsigned int t=0; t < threads; ++t) {
+            try {
+                tg.create_thread([this, &scan, &cuts, &exceptions, &next_range, num_items, num_ranges, t]() {
+                    try {
+                        Loglikelihood_t calcLogLikelihood(AbstractLoglikelihood::getNewLoglikelihood(*this));
+                        for (size_t r=next_range++; r < num_ranges; r=next_range++)
+                            scan(r * num_items / num_ranges, (r + 1) * num_items / num_ranges, cuts, calcLogLikelihood);
+                    } catch (...) {
+                        exceptions[t] = std::current_exception();
+                        next_range = num_ranges; // stop the other threads taking ranges
+                    }
+                });
+            } catch (...) {
+                if (t == 0) throw; // the threads already created take the remaining ranges
+                break;
+            }
+        }
+        tg.join_all();
+        for (const auto& exception : exceptions)
+            if (exception) std::rethrow_exception(exception);
+    }
+    cuts.release(_Cut);
+}
+
 /** SCANNING THE TREE */
 bool ScanRunner::scanTree() {
     _print.Printf("Scanning the tree ...\n", BasePrint::P_STDOUT);
-    Loglikelihood_t calcLogLikelihood(AbstractLoglikelihood::getNewLoglikelihood(*this));
-
-    for (size_t n=0; n < _Nodes.size(); ++n) {
-        const NodeStructure& thisNode(*_Nodes[n]);
-        if (isEvaluated(thisNode)) {
+    const CutPlan& plan(getCutPlan());
+    scanNodes(plan.getNodes().size(), [this, &plan](size_t first, size_t last, BestCutTable& cuts, const Loglikelihood_t& calcLogLikelihood) {
+        CutStructure::CutChildContainer_t currentChildren;
+        int sumBranchC = 0;
+        for (size_t p=first; p < last; ++p) {
+            const CutPlan::Node& planNode(plan.getNodes()[p]);
+            if (!isEvaluated(*_Nodes[planNode._node])) continue;
             // Always do simple cut for each node
-            calculateCut(n, thisNode.getBrC(), thisNode.getBrN(), calcLogLikelihood);
-            //if (thisNode.getChildren().size() == 0) continue;
-            Parameters::CutType cutType = thisNode.getChildren().size() >= 2 ? thisNode.getCutType() : Parameters::SIMPLE;
-            switch (cutType) {
-                case Parameters::SIMPLE: break; // already done, regardless of specified node cut
-                case Parameters::ORDINAL: {
-                    CutStructure::CutChildContainer_t currentChildren;
-                    // Ordinal cuts: ABCD -> AB, ABC, ABCD, BC, BCD, CD
-                    for (size_t i=0; i < thisNode.getChildren().size() - 1; ++i) {
-                        const NodeStructure& firstChildNode(*(thisNode.getChildren()[i]));
-                        currentChildren.clear();
-                        currentChildren.push_back(firstChildNode.getID());
-                        int sumBranchC=firstChildNode.getBrC();
-                        double sumBranchN=firstChildNode.getBrN();
-                        for (size_t j=i+1; j < thisNode.getChildren().size(); ++j) {
-                            const NodeStructure& childNode(*(thisNode.getChildren()[j]));
-                            currentChildren.push_back(childNode.getID());
-                            sumBranchC += childNode.getBrC();
-                            sumBranchN += childNode.getBrN();
-                            CutStructure * cut = calculateCut(n, sumBranchC, sumBranchN, calcLogLikelihood);
-                            if (cut) {
-                                cut->setCutChildren(currentChildren);
-                            }
-                        }
-                    }
-                } break;
-                case Parameters::PAIRS:
-                    // Pair cuts: ABCD -> AB, AC, AD, BC, BD, CD
-                    for (size_t i=0; i < thisNode.getChildren().size() - 1; ++i) {
-                        const NodeStructure& startChildNode(*(thisNode.getChildren()[i]));
-                        for (size_t j=i+1; j < thisNode.getChildren().size(); ++j) {
-                            const NodeStructure& stopChildNode(*(thisNode.getChildren()[j]));
-                            CutStructure * cut = calculateCut(n, startChildNode.getBrC() + stopChildNode.getBrC(), startChildNode.getBrN() + stopChildNode.getBrN(), calcLogLikelihood);
-                            if (cut) {
-                                cut->addCutChild(startChildNode.getID(), true);
-                                cut->addCutChild(stopChildNode.getID());
-                            }                            //++hits; printf("hits %d\n", hits);
-                        }
-                    } break;
-                case Parameters::TRIPLETS:
-                    // Triple cuts: ABCD -> AB, AC, ABC, AD, ABD, ACD, BC, BD, BCD, CD
-                    for (size_t i=0; i < thisNode.getChildren().size() - 1; ++i) {
-                        const NodeStructure& startChildNode(*(thisNode.getChildren()[i]));
-                        for (size_t j=i+1; j < thisNode.getChildren().size(); ++j) {
-                            const NodeStructure& stopChildNode(*(thisNode.getChildren()[j]));
-                            CutStructure * cut = calculateCut(n, startChildNode.getBrC() + stopChildNode.getBrC(), startChildNode.getBrN() + stopChildNode.getBrN(), calcLogLikelihood);
-                            if (cut) {
-                                cut->addCutChild(startChildNode.getID(), true);
-                                cut->addCutChild(stopChildNode.getID());
-                            }
-                            for (size_t k=i+1; k < j; ++k) {
-                                const NodeStructure& middleChildNode(*(thisNode.getChildren()[k]));
-                                //printf("Evaluating cut [%s,%s,%s]\n", startChildNode.getIdentifier().c_str(), middleChildNode.getIdentifier().c_str(), stopChildNode.getIdentifier().c_str());
-                                cut = calculateCut(n, startChildNode.getBrC() + middleChildNode.getBrC() + stopChildNode.getBrC(), startChildNode.getBrN() + middleChildNode.getBrN() + stopChildNode.getBrN(), calcLogLikelihood);
-                                if (cut) {
-                                    cut->addCutChild(startChildNode.getID(), true);
-                                    cut->addCutChild(middleChildNode.getID());
-                                    cut->addCutChild(stopChildNode.getID());
-                                }
-                            }
-                        }
-                    } break;
-                case Parameters::COMBINATORIAL:
-                default: throw prg_error("Unknown cut type (%d).", "scanTree()", cutType);
+            const CutPlan::Cut& branch(plan.getCuts()[planNode._begin]);
+            calculateCut(cuts, planNode._node, _Nodes[planNode._node]->getBrC(), branch._BrN, calcLogLikelihood);
+            // then ordinal, pair or triplet cuts of children
+            for (size_t c=planNode._begin + 1; c < planNode._end; ++c) {
+                const CutPlan::Cut& planCut(plan.getCuts()[c]);
+                if (!planCut._extends) {
+                    sumBranchC = 0;
+                    currentChildren.clear();
+                }
+                for (unsigned int i=0; i < planCut._size; ++i)
+                    sumBranchC += _Nodes[planCut._nodes[i]]->getBrC();
+                planCut.addChildren(currentChildren);
+                CutStructure * cut = calculateCut(cuts, planNode._node, sumBranchC, planCut._BrN, calcLogLikelihood);
+                if (cut) cut->setCutChildren(currentChildren);
             }
         }
-    }
+    });
     rankCutsAndReportMostLikely();   
     return _Cut.size() != 0;
 }
@@ -2746,77 +2979,30 @@ bool ScanRunner::scanTree() {
 /** Scan the tree using the signed-rank model and produce candidate cuts. */
 bool ScanRunner::scanTreeSignedRank() {
     _print.Printf("Scanning the tree ...\n", BasePrint::P_STDOUT);
-    Loglikelihood_t calcLogLikelihood(AbstractLoglikelihood::getNewLoglikelihood(*this));
-
-    for (size_t n = 0; n < _Nodes.size(); ++n) {
-        const NodeStructure& thisNode(*_Nodes[n]);
-        if (isEvaluated(thisNode)) {
+    const CutPlan& plan(getCutPlan());
+    scanNodes(plan.getNodes().size(), [this, &plan](size_t first, size_t last, BestCutTable& cuts, const Loglikelihood_t& calcLogLikelihood) {
+        CutStructure::CutChildContainer_t currentChildren;
+        SampleSiteMap_t accumulation;
+        for (size_t p=first; p < last; ++p) {
+            const CutPlan::Node& planNode(plan.getNodes()[p]);
+            if (!isEvaluated(*_Nodes[planNode._node])) continue;
             // Always do simple cut for each node
-            calculateCut(n, thisNode.getSampleSiteDataBr(), calcLogLikelihood);
-            //if (thisNode.getChildren().size() == 0) continue;
-            Parameters::CutType cutType = thisNode.getChildren().size() >= 2 ? thisNode.getCutType() : Parameters::SIMPLE;
-            switch (cutType) {
-            case Parameters::SIMPLE: break; // already done, regardless of specified node cut
-            case Parameters::ORDINAL: { // Ordinal cuts: ABCD -> AB, ABC, ABCD, BC, BCD, CD
-                CutStructure::CutChildContainer_t currentChildren;
-                // Ordinal cuts: ABCD -> AB, ABC, ABCD, BC, BCD, CD
-                for (size_t i = 0; i < thisNode.getChildren().size() - 1; ++i) {
-                    const NodeStructure& firstChildNode(*(thisNode.getChildren()[i]));
+            calculateCut(cuts, planNode._node, _Nodes[planNode._node]->getSampleSiteDataBr(), calcLogLikelihood);
+            // then ordinal, pair or triplet cuts of children
+            for (size_t c=planNode._begin + 1; c < planNode._end; ++c) {
+                const CutPlan::Cut& planCut(plan.getCuts()[c]);
+                if (!planCut._extends) {
+                    accumulation.clear();
                     currentChildren.clear();
-                    currentChildren.push_back(firstChildNode.getID());
-                    SampleSiteMap_t accumulation = firstChildNode.getSampleSiteDataBr();
-                    for (size_t j = i + 1; j < thisNode.getChildren().size(); ++j) {
-                        const NodeStructure& childNode(*(thisNode.getChildren()[j]));
-                        currentChildren.push_back(childNode.getID());
-                        CutStructure* cut = calculateCut(n, combine(accumulation, childNode.getSampleSiteDataBr()), calcLogLikelihood);
-                        if (cut) cut->setCutChildren(currentChildren);
-                    }
-                }
-            } break;
-            case Parameters::PAIRS: {// Pair cuts: ABCD -> AB, AC, AD, BC, BD, CD
-                for (size_t i = 0; i < thisNode.getChildren().size() - 1; ++i) {
-                    const NodeStructure& startChildNode(*(thisNode.getChildren()[i]));
-                    for (size_t j = i + 1; j < thisNode.getChildren().size(); ++j) {
-                        SampleSiteMap_t accumulation = startChildNode.getSampleSiteDataBr();
-                        const NodeStructure& stopChildNode(*(thisNode.getChildren()[j]));
-                        CutStructure* cut = calculateCut(n, combine(accumulation, stopChildNode.getSampleSiteDataBr()), calcLogLikelihood);
-                        if (cut) {
-                            cut->addCutChild(startChildNode.getID(), true);
-                            cut->addCutChild(stopChildNode.getID());
-                        }
-                    }
                 }
-            } break;
-            case Parameters::TRIPLETS: {// Triple cuts: ABCD -> AB, AC, ABC, AD, ABD, ACD, BC, BD, BCD, CD
-                for (size_t i = 0; i < thisNode.getChildren().size() - 1; ++i) {
-                    const NodeStructure& startChildNode(*(thisNode.getChildren()[i]));
-                    for (size_t j = i + 1; j < thisNode.getChildren().size(); ++j) {
-                        SampleSiteMap_t accumulation = startChildNode.getSampleSiteDataBr();
-                        const NodeStructure& stopChildNode(*(thisNode.getChildren()[j]));
-                        CutStructure* cut = calculateCut(n, combine(accumulation, stopChildNode.getSampleSiteDataBr()), calcLogLikelihood);
-                        if (cut) {
-                            cut->addCutChild(startChildNode.getID(), true);
-                            cut->addCutChild(stopChildNode.getID());
-                        }
-                        for (size_t k = i + 1; k < j; ++k) {
-                            const NodeStructure& middleChildNode(*(thisNode.getChildren()[k]));
-                            SampleSiteMap_t accumulationStartStop = accumulation;
-                            //printf("Evaluating cut [%s,%s,%s]\n", startChildNode.getIdentifier().c_str(), middleChildNode.getIdentifier().c_str(), stopChildNode.getIdentifier().c_str());
-                            cut = calculateCut(n, combine(accumulationStartStop, middleChildNode.getSampleSiteDataBr()), calcLogLikelihood);
-                            if (cut) {
-                                cut->addCutChild(startChildNode.getID(), true);
-                                cut->addCutChild(middleChildNode.getID());
-                                cut->addCutChild(stopChildNode.getID());
-                            }
-                        }
-                    }
-                }
-            } break;
-            case Parameters::COMBINATORIAL:
-                default: throw prg_error("Unknown cut type (%d).", "scanTreeSignedRank()", cutType);
+                for (unsigned int i=0; i < planCut._size; ++i)
+                    combine(accumulation, _Nodes[planCut._nodes[i]]->getSampleSiteDataBr());
+                planCut.addChildren(currentChildren);
+                CutStructure* cut = calculateCut(cuts, planNode._node, accumulation, calcLogLikelihood);
+                if (cut) cut->setCutChildren(currentChildren);
             }
         }
-    }
+    });
     rankCutsAndReportMostLikely();
     return _Cut.size() != 0;
 }
@@ -2824,38 +3010,30 @@ bool ScanRunner::scanTreeSignedRank() {
 /** SCANNING THE TREE for temporal model */
 bool ScanRunner::scanTreeTemporalConditionNode() {
     _print.Printf("Scanning the tree.\n", BasePrint::P_STDOUT);
-    Loglikelihood_t calcLogLikelihood(AbstractLoglikelihood::getNewLoglikelihood(*this));
 
-    // Define the start and end windows with the zero index offset already incorporated.
-    DataTimeRange startWindow(temporalStartRange().getStart() + _zero_translation_additive, temporalStartRange().getEnd() + _zero_translation_additive),
-                  endWindow(temporalEndRange().getStart() + _zero_translation_additive, temporalEndRange().getEnd() + _zero_translation_additive);
-    // Define the minimum and maximum window lengths.
-    std::shared_ptr<AbstractWindowLength> window(getNewWindowLength());
-    int iWindowStart, iMinWindowStart, iWindowEnd, iMaxEndWindow;
-
-    for (size_t n=0; n < _Nodes.size(); ++n) {
-        if (isEvaluated(*_Nodes[n])) {
-            const NodeStructure& thisNode(*(_Nodes[n]));
-            // always do simple cut
-            iMaxEndWindow = std::min(endWindow.getEnd(), startWindow.getEnd() + window->maximum());
-            for (iWindowEnd=endWindow.getStart(); iWindowEnd <= iMaxEndWindow; ++iWindowEnd) {
-                window->windowstart(startWindow, iWindowEnd, iMinWindowStart, iWindowStart);
-                for (; iWindowStart >= iMinWindowStart; --iWindowStart) {
-                    //_print.Printf("%d to %d\n", BasePrint::P_STDOUT,iWindowStart, iWindowEnd);
-                    calculateCut(n, thisNode.getBrC_C()[iWindowStart] - thisNode.getBrC_C()[iWindowEnd + 1], static_cast<NodeStructure::expected_t>(thisNode.getBrC()), calcLogLikelihood, iWindowStart, iWindowEnd);
-                }
-            }
-            //if (thisNode.getChildren().size() == 0) continue;
-            Parameters::CutType cutType = thisNode.getChildren().size() >= 2 ? thisNode.getCutType() : Parameters::SIMPLE;
-            switch (cutType) {
-                case Parameters::SIMPLE: break; // already done, regardless of specified node cut
-                case Parameters::ORDINAL: {
-                    // Ordinal cuts: ABCD -> AB, ABC, ABCD, BC, BCD, CD
-                    CutStructure::CutChildContainer_t currentChildren;
-                    iMaxEndWindow = std::min(endWindow.getEnd(), startWindow.getEnd() + window->maximum());
-                    for (iWindowEnd=endWindow.getStart(); iWindowEnd <= iMaxEndWindow; ++iWindowEnd) {
-                        window->windowstart(startWindow, iWindowEnd, iMinWindowStart, iWindowStart);
-                        for (; iWindowStart >= iMinWindowStart; --iWindowStart) {
+    // Enumerate the windows, with their lengths, once for all nodes.
+    TemporalWindowScan windows(getTemporalWindowScan());
+
+    scanNodes(_Nodes.size(), [this, &windows](size_t first, size_t last, BestCutTable& cuts, const Loglikelihood_t& calcLogLikelihood) {
+        std::vector<NodeStructure::count_t> window_counts(windows.size());
+        int iWindowStart, iWindowEnd;
+        for (size_t n=first; n < last; ++n) {
+            if (isEvaluated(*_Nodes[n])) {
+                const NodeStructure& thisNode(*(_Nodes[n]));
+                // always do simple cut
+                windows.getCounts(thisNode.getBrC_C().data(), window_counts.data());
+                for (size_t w=0; w < windows.size(); ++w)
+                    calculateCut(cuts, n, window_counts[w], static_cast<NodeStructure::expected_t>(thisNode.getBrC()), calcLogLikelihood, windows, w);
+                //if (thisNode.getChildren().size() == 0) continue;
+                Parameters::CutType cutType = thisNode.getChildren().size() >= 2 ? thisNode.getCutType() : Parameters::SIMPLE;
+                switch (cutType) {
+                    case Parameters::SIMPLE: break; // already done, regardless of specified node cut
+                    case Parameters::ORDINAL: {
+                        // Ordinal cuts: ABCD -> AB, ABC, ABCD, BC, BCD, CD
+                        CutStructure::CutChildContainer_t currentChildren;
+                        for (size_t w=0; w < windows.size(); ++w) {
+                            iWindowStart = windows.getStart(w);
+                            iWindowEnd = windows.getEnd(w);
                             for (size_t i=0; i < thisNode.getChildren().size() - 1; ++i) {
                                 const NodeStructure& firstChildNode(*(thisNode.getChildren()[i]));
                                 currentChildren.clear();
@@ -2867,21 +3045,19 @@ bool ScanRunner::scanTreeTemporalConditionNode() {
                                     currentChildren.push_back(childNode.getID());
                                     branchWindow += childNode.getBrC_C()[iWindowStart] - childNode.getBrC_C()[iWindowEnd + 1];
                                     branchSum += static_cast<NodeStructure::expected_t>(childNode.getBrC());
-                                    CutStructure * cut = calculateCut(n, branchWindow, branchSum, calcLogLikelihood, iWindowStart, iWindowEnd);
+                                    CutStructure * cut = calculateCut(cuts, n, branchWindow, branchSum, calcLogLikelihood, windows, w);
                                     if (cut) {
                                         cut->setCutChildren(currentChildren);
                                     }
                                 }
                             }
                         }
-                    }
-                } break;
-                case Parameters::PAIRS:
-                    // Pair cuts: ABCD -> AB, AC, AD, BC, BD, CD
-                    iMaxEndWindow = std::min(endWindow.getEnd(), startWindow.getEnd() + window->maximum());
-                    for (iWindowEnd=endWindow.getStart(); iWindowEnd <= iMaxEndWindow; ++iWindowEnd) {
-                        window->windowstart(startWindow, iWindowEnd, iMinWindowStart, iWindowStart);
-                        for (; iWindowStart >= iMinWindowStart; --iWindowStart) {
+                    } break;
+                    case Parameters::PAIRS:
+                        // Pair cuts: ABCD -> AB, AC, AD, BC, BD, CD
+                        for (size_t w=0; w < windows.size(); ++w) {
+                            iWindowStart = windows.getStart(w);
+                            iWindowEnd = windows.getEnd(w);
                             for (size_t i=0; i < thisNode.getChildren().size() - 1; ++i) {
                                 const NodeStructure& startChildNode(*(thisNode.getChildren()[i]));
                                 NodeStructure::count_t startBranchWindow = startChildNode.getBrC_C()[iWindowStart] - startChildNode.getBrC_C()[iWindowEnd + 1];
@@ -2890,21 +3066,19 @@ bool ScanRunner::scanTreeTemporalConditionNode() {
                                     const NodeStructure& stopChildNode(*(thisNode.getChildren()[j]));
                                     NodeStructure::count_t stopBranchWindow = stopChildNode.getBrC_C()[iWindowStart] - stopChildNode.getBrC_C()[iWindowEnd + 1];
                                     NodeStructure::expected_t stopBranchSum = static_cast<NodeStructure::expected_t>(stopChildNode.getBrC());
-                                    CutStructure * cut = calculateCut(n, startBranchWindow + stopBranchWindow, startBranchSum + stopBranchSum, calcLogLikelihood, iWindowStart, iWindowEnd);
+                                    CutStructure * cut = calculateCut(cuts, n, startBranchWindow + stopBranchWindow, startBranchSum + stopBranchSum, calcLogLikelihood, windows, w);
                                     if (cut) {
                                         cut->addCutChild(startChildNode.getID(), true);
                                         cut->addCutChild(stopChildNode.getID());
                                     }
                                 }
                             }
-                        }
-                    } break;
-                case Parameters::TRIPLETS:
-                    // Triple cuts: ABCD -> AB, AC, ABC, AD, ABD, ACD, BC, BD, BCD, CD
-                    iMaxEndWindow = std::min(endWindow.getEnd(), startWindow.getEnd() + window->maximum());
-                    for (iWindowEnd=endWindow.getStart(); iWindowEnd <= iMaxEndWindow; ++iWindowEnd) {
-                        window->windowstart(startWindow, iWindowEnd, iMinWindowStart, iWindowStart);
-                        for (; iWindowStart >= iMinWindowStart; --iWindowStart) {
+                        } break;
+                    case Parameters::TRIPLETS:
+                        // Triple cuts: ABCD -> AB, AC, ABC, AD, ABD, ACD, BC, BD, BCD, CD
+                        for (size_t w=0; w < windows.size(); ++w) {
+                            iWindowStart = windows.getStart(w);
+                            iWindowEnd = windows.getEnd(w);
                             for (size_t i=0; i < thisNode.getChildren().size() - 1; ++i) {
                                 const NodeStructure& startChildNode(*(thisNode.getChildren()[i]));
                                 NodeStructure::count_t startBranchWindow = startChildNode.getBrC_C()[iWindowStart] - startChildNode.getBrC_C()[iWindowEnd + 1];
@@ -2913,7 +3087,7 @@ bool ScanRunner::scanTreeTemporalConditionNode() {
                                     const NodeStructure& stopChildNode(*(thisNode.getChildren()[j]));
                                     NodeStructure::count_t stopBranchWindow = stopChildNode.getBrC_C()[iWindowStart] - stopChildNode.getBrC_C()[iWindowEnd + 1];
                                     NodeStructure::expected_t stopBranchSum = static_cast<NodeStructure::expected_t>(stopChildNode.getBrC());
-                                    CutStructure * cut = calculateCut(n, startBranchWindow + stopBranchWindow, startBranchSum + stopBranchSum, calcLogLikelihood, iWindowStart, iWindowEnd);
+                                    CutStructure * cut = calculateCut(cuts, n, startBranchWindow + stopBranchWindow, startBranchSum + stopBranchSum, calcLogLikelihood, windows, w);
                                     if (cut) {
                                         cut->addCutChild(startChildNode.getID(), true);
                                         cut->addCutChild(stopChildNode.getID());
@@ -2922,7 +3096,7 @@ bool ScanRunner::scanTreeTemporalConditionNode() {
                                         const NodeStructure& middleChildNode(*(thisNode.getChildren()[k]));
                                         NodeStructure::count_t middleBranchWindow = middleChildNode.getBrC_C()[iWindowStart] - middleChildNode.getBrC_C()[iWindowEnd + 1];
                                         NodeStructure::expected_t middleBranchSum = static_cast<NodeStructure::expected_t>(middleChildNode.getBrC());
-                                        CutStructure * cut = calculateCut(n, startBranchWindow + middleBranchWindow + stopBranchWindow, startBranchSum + middleBranchSum + stopBranchSum, calcLogLikelihood, iWindowStart, iWindowEnd);
+                                        CutStructure * cut = calculateCut(cuts, n, startBranchWindow + middleBranchWindow + stopBranchWindow, startBranchSum + middleBranchSum + stopBranchSum, calcLogLikelihood, windows, w);
                                         if (cut) {
                                             cut->addCutChild(startChildNode.getID(), true);
                                             cut->addCutChild(middleChildNode.getID());
@@ -2931,13 +3105,13 @@ bool ScanRunner::scanTreeTemporalConditionNode() {
                                     }
                                 }
                             }
-                        }
-                    } break;
-                case Parameters::COMBINATORIAL:
-                default: throw prg_error("Unknown cut type (%d).", "scanTreeTemporalConditionNode()", cutType);
+                        } break;
+                    case Parameters::COMBINATORIAL:
+                    default: throw prg_error("Unknown cut type (%d).", "scanTreeTemporalConditionNode()", cutType);
+                }
             }
         }
-    }   
+    });
     rankCutsAndReportMostLikely();
     return _Cut.size() != 0;
 }
@@ -2946,192 +3120,54 @@ bool ScanRunner::scanTreeTemporalConditionNode() {
 /** SCANNING THE TREE for temporal model conditioned on node and censored. */
 bool ScanRunner::scanTreeTemporalConditionNodeCensored() {
     _print.Printf("Scanning the tree.\n", BasePrint::P_STDOUT);
-   Loglikelihood_t calcLogLikelihood(AbstractLoglikelihood::getNewLoglikelihood(*this));
 
     // Define the start and end windows with the zero index offset already incorporated.
     DataTimeRange startWindow(temporalStartRange().getStart() + _zero_translation_additive, temporalStartRange().getEnd() + _zero_translation_additive),
                   endWindow(temporalEndRange().getStart() + _zero_translation_additive, temporalEndRange().getEnd() + _zero_translation_additive);
     // Define the minimum and maximum window lengths.
-    std::shared_ptr<AbstractWindowLength> window(getNewWindowLength());
-    int iWindowStart, iMinWindowStart, iWindowEnd, iMaxEndWindow;
-    for (size_t n = 0; n < _Nodes.size(); ++n) {
-        if (isEvaluated(*_Nodes[n])) {
-            const NodeStructure& thisNode(*(_Nodes[n]));
-            // always do simple cut
-            iMaxEndWindow = std::min(endWindow.getEnd(), startWindow.getEnd() + window->maximum());
-            for (iWindowEnd = endWindow.getStart(); iWindowEnd <= iMaxEndWindow; ++iWindowEnd) {
-                window->windowstart(startWindow, iWindowEnd, iMinWindowStart, iWindowStart, thisNode.getMinCensoredBr());
-                for (; iWindowStart >= iMinWindowStart; --iWindowStart) {
-                    calculateCut(n, thisNode.getBrC_C()[iWindowStart] - thisNode.getBrC_C()[iWindowEnd + 1], 
-                                    thisNode.getBrN_C()[iWindowStart] - thisNode.getBrN_C()[iWindowEnd + 1], 
-                                    thisNode.getBrC(), thisNode.getBrN(), calcLogLikelihood, iWindowStart, iWindowEnd);
-                }
-            }
-            //if (thisNode.getChildren().size() == 0) continue;
-            Parameters::CutType cutType = thisNode.getChildren().size() >= 2 ? thisNode.getCutType() : Parameters::SIMPLE;
-            switch (cutType) {
-            case Parameters::SIMPLE: break; // already done, regardless of specified node cut
-            case Parameters::ORDINAL: {
-                // Ordinal cuts: ABCD -> AB, ABC, ABCD, BC, BCD, CD
-                CutStructure::CutChildContainer_t currentChildren;
-                iMaxEndWindow = std::min(endWindow.getEnd(), startWindow.getEnd() + window->maximum());
-                for (iWindowEnd = endWindow.getStart(); iWindowEnd <= iMaxEndWindow; ++iWindowEnd) {
-                    window->windowstart(startWindow, iWindowEnd, iMinWindowStart, iWindowStart, thisNode.getMinCensoredBr());
-                    for (; iWindowStart >= iMinWindowStart; --iWindowStart) {
-                        for (size_t i = 0; i < thisNode.getChildren().size() - 1; ++i) {
-                            const NodeStructure& firstChildNode(*(thisNode.getChildren()[i]));
-                            currentChildren.clear();
-                            currentChildren.push_back(firstChildNode.getID());
-                            NodeStructure::count_t branchWindow = firstChildNode.getBrC_C()[iWindowStart] - firstChildNode.getBrC_C()[iWindowEnd + 1];
-                            NodeStructure::expected_t branchSum = firstChildNode.getBrN_C()[iWindowStart] - firstChildNode.getBrN_C()[iWindowEnd + 1];
-                            NodeStructure::count_t branchCTotal = firstChildNode.getBrC();
-                            NodeStructure::expected_t branchNTotal = firstChildNode.getBrN();
-                            for (size_t j = i + 1; j < thisNode.getChildren().size(); ++j) {
-                                const NodeStructure& childNode(*(thisNode.getChildren()[j]));
-                                currentChildren.push_back(childNode.getID());
-                                branchWindow += childNode.getBrC_C()[iWindowStart] - childNode.getBrC_C()[iWindowEnd + 1];
-                                branchSum += childNode.getBrN_C()[iWindowStart] - childNode.getBrN_C()[iWindowEnd + 1];
-                                branchCTotal += childNode.getBrC();
-                                branchNTotal += childNode.getBrN();
-                                CutStructure * cut = calculateCut(n, branchWindow, branchSum, branchCTotal, branchNTotal, calcLogLikelihood, iWindowStart, iWindowEnd);
-                                if (cut) {
-                                    cut->setCutChildren(currentChildren);
-                                }
-                            }
-                        }
-                    }
-                }
-            } break;
-            case Parameters::PAIRS:
-                // Pair cuts: ABCD -> AB, AC, AD, BC, BD, CD
-                iMaxEndWindow = std::min(endWindow.getEnd(), startWindow.getEnd() + window->maximum());
-                for (iWindowEnd = endWindow.getStart(); iWindowEnd <= iMaxEndWindow; ++iWindowEnd) {
-                    window->windowstart(startWindow, iWindowEnd, iMinWindowStart, iWindowStart, thisNode.getMinCensoredBr());
-                    for (; iWindowStart >= iMinWindowStart; --iWindowStart) {
-                        for (size_t i = 0; i < thisNode.getChildren().size() - 1; ++i) {
-                            const NodeStructure& startChildNode(*(thisNode.getChildren()[i]));
-                            NodeStructure::count_t startBranchWindow = startChildNode.getBrC_C()[iWindowStart] - startChildNode.getBrC_C()[iWindowEnd + 1];
-                            NodeStructure::expected_t startBranchSum = startChildNode.getBrN_C()[iWindowStart] - startChildNode.getBrN_C()[iWindowEnd + 1];
-                            NodeStructure::count_t startBranchTotalC = startChildNode.getBrC();
-                            NodeStructure::expected_t startBranchTotalN = startChildNode.getBrN();
-                            for (size_t j = i + 1; j < thisNode.getChildren().size(); ++j) {
-                                const NodeStructure& stopChildNode(*(thisNode.getChildren()[j]));
-                                NodeStructure::count_t stopBranchWindow = stopChildNode.getBrC_C()[iWindowStart] - stopChildNode.getBrC_C()[iWindowEnd + 1];
-                                NodeStructure::expected_t stopBranchSum = stopChildNode.getBrN_C()[iWindowStart] - stopChildNode.getBrN_C()[iWindowEnd + 1];
-                                CutStructure * cut = calculateCut(n, startBranchWindow + stopBranchWindow, startBranchSum + stopBranchSum, 
-                                                                  startBranchTotalC + stopChildNode.getBrC(), startBranchTotalN + stopChildNode.getBrN(),
-                                                                  calcLogLikelihood, iWindowStart, iWindowEnd);
-                                if (cut) {
-                                    cut->addCutChild(startChildNode.getID(), true);
-                                    cut->addCutChild(stopChildNode.getID());
-                                }
-                            }
-                        }
-                    }
-                } break;
-            case Parameters::TRIPLETS:
-                // Triple cuts: ABCD -> AB, AC, ABC, AD, ABD, ACD, BC, BD, BCD, CD
+    scanNodes(_Nodes.size(), [this, &startWindow, &endWindow](size_t first, size_t last, BestCutTable& cuts, const Loglikelihood_t& calcLogLikelihood) {
+        std::shared_ptr<AbstractWindowLength> window(getNewWindowLength());
+        int iWindowStart, iMinWindowStart, iWindowEnd, iMaxEndWindow;
+        for (size_t n=first; n < last; ++n) {
+            if (isEvaluated(*_Nodes[n])) {
+                const NodeStructure& thisNode(*(_Nodes[n]));
+                // always do simple cut
                 iMaxEndWindow = std::min(endWindow.getEnd(), startWindow.getEnd() + window->maximum());
                 for (iWindowEnd = endWindow.getStart(); iWindowEnd <= iMaxEndWindow; ++iWindowEnd) {
                     window->windowstart(startWindow, iWindowEnd, iMinWindowStart, iWindowStart, thisNode.getMinCensoredBr());
                     for (; iWindowStart >= iMinWindowStart; --iWindowStart) {
-                        for (size_t i = 0; i < thisNode.getChildren().size() - 1; ++i) {
-                            const NodeStructure& startChildNode(*(thisNode.getChildren()[i]));
-                            NodeStructure::count_t startBranchWindow = startChildNode.getBrC_C()[iWindowStart] - startChildNode.getBrC_C()[iWindowEnd + 1];
-                            NodeStructure::expected_t startBranchSum = startChildNode.getBrN_C()[iWindowStart] - startChildNode.getBrN_C()[iWindowEnd + 1];
-                            NodeStructure::count_t startBranchTotalC = startChildNode.getBrC();
-                            NodeStructure::expected_t startBranchTotalN = startChildNode.getBrN();
-                            for (size_t j = i + 1; j < thisNode.getChildren().size(); ++j) {
-                                const NodeStructure& stopChildNode(*(thisNode.getChildren()[j]));
-                                NodeStructure::count_t stopBranchWindow = stopChildNode.getBrC_C()[iWindowStart] - stopChildNode.getBrC_C()[iWindowEnd + 1];
-                                NodeStructure::expected_t stopBranchSum = stopChildNode.getBrN_C()[iWindowStart] - stopChildNode.getBrN_C()[iWindowEnd + 1];
-                                NodeStructure::count_t stopBranchTotalC = stopChildNode.getBrC();
-                                NodeStructure::expected_t stopBranchTotalN = stopChildNode.getBrN();
-                                CutStructure * cut = calculateCut(n, startBranchWindow + stopBranchWindow, startBranchSum + stopBranchSum, 
-                                                                  startBranchTotalC + stopBranchTotalC, startBranchTotalN + stopBranchTotalN,
-                                                                  calcLogLikelihood, iWindowStart, iWindowEnd);
-                                if (cut) {
-                                    cut->addCutChild(startChildNode.getID(), true);
-                                    cut->addCutChild(stopChildNode.getID());
-                                }
-                                for (size_t k = i + 1; k < j; ++k) {
-                                    const NodeStructure& middleChildNode(*(thisNode.getChildren()[k]));
-                                    NodeStructure::count_t middleBranchWindow = middleChildNode.getBrC_C()[iWindowStart] - middleChildNode.getBrC_C()[iWindowEnd + 1];
-                                    NodeStructure::expected_t middleBranchSum = middleChildNode.getBrN_C()[iWindowStart] - middleChildNode.getBrN_C()[iWindowEnd + 1];
-                                    NodeStructure::count_t middleBranchTotalC = middleChildNode.getBrC();
-                                    NodeStructure::expected_t middleBranchTotalN = middleChildNode.getBrN();
-                                    CutStructure * cut = calculateCut(n, startBranchWindow + middleBranchWindow + stopBranchWindow, startBranchSum + middleBranchSum + stopBranchSum, 
-                                                                      startBranchTotalC + middleBranchTotalC + stopBranchTotalC, startBranchTotalN + middleBranchTotalN + stopBranchTotalN,
-                                                                      calcLogLikelihood, iWindowStart, iWindowEnd);
-                                    if (cut) {
-                                        cut->addCutChild(startChildNode.getID(), true);
-                                        cut->addCutChild(middleChildNode.getID());
-                                        cut->addCutChild(stopChildNode.getID());
-                                    }
-                                }
-                            }
-                        }
+                        calculateCut(cuts, n, thisNode.getBrC_C()[iWindowStart] - thisNode.getBrC_C()[iWindowEnd + 1], 
+                                        thisNode.getBrN_C()[iWindowStart] - thisNode.getBrN_C()[iWindowEnd + 1], 
+                                        thisNode.getBrC(), thisNode.getBrN(), calcLogLikelihood, iWindowStart, iWindowEnd);
                     }
-                } break;
-            case Parameters::COMBINATORIAL:
-            default: throw prg_error("Unknown cut type (%d).", "scanTreeTemporalConditionNode()", cutType);
-            }
-        }
-    }
-    rankCutsAndReportMostLikely();
-    return _Cut.size() != 0;
-}
-
-/** SCANNING THE TREE for temporal model -- conditioned on the total cases across nodes and time. */
-bool ScanRunner::scanTreeTemporalConditionNodeTime() {
-    _print.Printf("Scanning the tree.\n", BasePrint::P_STDOUT);
-    Loglikelihood_t calcLogLikelihood(AbstractLoglikelihood::getNewLoglikelihood(*this));
-
-    // Define the start and end windows with the zero index offset already incorporated.
-    DataTimeRange startWindow(temporalStartRange().getStart() + _zero_translation_additive,
-                              temporalStartRange().getEnd() + _zero_translation_additive),
-                  endWindow(temporalEndRange().getStart() + _zero_translation_additive,
-                            temporalEndRange().getEnd() + _zero_translation_additive);
-    // Define the minimum and maximum window lengths.
-    std::shared_ptr<AbstractWindowLength> window(getNewWindowLength());
-    int  iWindowStart, iMinWindowStart, iWindowEnd, iMaxEndWindow;
-    for (size_t n=0; n < _Nodes.size(); ++n) {
-        if (isEvaluated(*_Nodes[n])) {
-            const NodeStructure& thisNode(*(_Nodes[n]));
-            // always do simple cut
-            iMaxEndWindow = std::min(endWindow.getEnd(), startWindow.getEnd() + window->maximum());
-            for (iWindowEnd=endWindow.getStart(); iWindowEnd <= iMaxEndWindow; ++iWindowEnd) {
-                window->windowstart(startWindow, iWindowEnd, iMinWindowStart, iWindowStart);
-                for (; iWindowStart >= iMinWindowStart; --iWindowStart) {
-                    //_print.Printf("%d to %d\n", BasePrint::P_STDOUT,iWindowStart, iWindowEnd);
-                    calculateCut(n, thisNode.getBrC_C()[iWindowStart] - thisNode.getBrC_C()[iWindowEnd + 1],
-                                  thisNode.getBrN_C()[iWindowStart] - thisNode.getBrN_C()[iWindowEnd + 1],
-                                  calcLogLikelihood, iWindowStart, iWindowEnd);
                 }
-            }
-            //if (thisNode.getChildren().size() == 0) continue;
-            Parameters::CutType cutType = thisNode.getChildren().size() >= 2 ? thisNode.getCutType() : Parameters::SIMPLE;
-            switch (cutType) {
+                //if (thisNode.getChildren().size() == 0) continue;
+                Parameters::CutType cutType = thisNode.getChildren().size() >= 2 ? thisNode.getCutType() : Parameters::SIMPLE;
+                switch (cutType) {
                 case Parameters::SIMPLE: break; // already done, regardless of specified node cut
                 case Parameters::ORDINAL: {
                     // Ordinal cuts: ABCD -> AB, ABC, ABCD, BC, BCD, CD
                     CutStructure::CutChildContainer_t currentChildren;
                     iMaxEndWindow = std::min(endWindow.getEnd(), startWindow.getEnd() + window->maximum());
-                    for (iWindowEnd=endWindow.getStart(); iWindowEnd <= iMaxEndWindow; ++iWindowEnd) {
-                        window->windowstart(startWindow, iWindowEnd, iMinWindowStart, iWindowStart);
+                    for (iWindowEnd = endWindow.getStart(); iWindowEnd <= iMaxEndWindow; ++iWindowEnd) {
+                        window->windowstart(startWindow, iWindowEnd, iMinWindowStart, iWindowStart, thisNode.getMinCensoredBr());
                         for (; iWindowStart >= iMinWindowStart; --iWindowStart) {
-                            for (size_t i=0; i < thisNode.getChildren().size() - 1; ++i) {
+                            for (size_t i = 0; i < thisNode.getChildren().size() - 1; ++i) {
                                 const NodeStructure& firstChildNode(*(thisNode.getChildren()[i]));
                                 currentChildren.clear();
                                 currentChildren.push_back(firstChildNode.getID());
                                 NodeStructure::count_t branchWindow = firstChildNode.getBrC_C()[iWindowStart] - firstChildNode.getBrC_C()[iWindowEnd + 1];
-                                NodeStructure::expected_t branchExpected = firstChildNode.getBrN_C()[iWindowStart] - firstChildNode.getBrN_C()[iWindowEnd + 1];
-                                for (size_t j=i+1; j < thisNode.getChildren().size(); ++j) {
+                                NodeStructure::expected_t branchSum = firstChildNode.getBrN_C()[iWindowStart] - firstChildNode.getBrN_C()[iWindowEnd + 1];
+                                NodeStructure::count_t branchCTotal = firstChildNode.getBrC();
+                                NodeStructure::expected_t branchNTotal = firstChildNode.getBrN();
+                                for (size_t j = i + 1; j < thisNode.getChildren().size(); ++j) {
                                     const NodeStructure& childNode(*(thisNode.getChildren()[j]));
                                     currentChildren.push_back(childNode.getID());
                                     branchWindow += childNode.getBrC_C()[iWindowStart] - childNode.getBrC_C()[iWindowEnd + 1];
-                                    branchExpected += childNode.getBrN_C()[iWindowStart] - childNode.getBrN_C()[iWindowEnd + 1];
-                                    CutStructure * cut = calculateCut(n, branchWindow, branchExpected, calcLogLikelihood, iWindowStart, iWindowEnd);
+                                    branchSum += childNode.getBrN_C()[iWindowStart] - childNode.getBrN_C()[iWindowEnd + 1];
+                                    branchCTotal += childNode.getBrC();
+                                    branchNTotal += childNode.getBrN();
+                                    CutStructure * cut = calculateCut(cuts, n, branchWindow, branchSum, branchCTotal, branchNTotal, calcLogLikelihood, iWindowStart, iWindowEnd);
                                     if (cut) {
                                         cut->setCutChildren(currentChildren);
                                     }
@@ -3143,18 +3179,22 @@ bool ScanRunner::scanTreeTemporalConditionNodeTime() {
                 case Parameters::PAIRS:
                     // Pair cuts: ABCD -> AB, AC, AD, BC, BD, CD
                     iMaxEndWindow = std::min(endWindow.getEnd(), startWindow.getEnd() + window->maximum());
-                    for (iWindowEnd=endWindow.getStart(); iWindowEnd <= iMaxEndWindow; ++iWindowEnd) {
-                        window->windowstart(startWindow, iWindowEnd, iMinWindowStart, iWindowStart);
+                    for (iWindowEnd = endWindow.getStart(); iWindowEnd <= iMaxEndWindow; ++iWindowEnd) {
+                        window->windowstart(startWindow, iWindowEnd, iMinWindowStart, iWindowStart, thisNode.getMinCensoredBr());
                         for (; iWindowStart >= iMinWindowStart; --iWindowStart) {
-                            for (size_t i=0; i < thisNode.getChildren().size() - 1; ++i) {
+                            for (size_t i = 0; i < thisNode.getChildren().size() - 1; ++i) {
                                 const NodeStructure& startChildNode(*(thisNode.getChildren()[i]));
                                 NodeStructure::count_t startBranchWindow = startChildNode.getBrC_C()[iWindowStart] - startChildNode.getBrC_C()[iWindowEnd + 1];
-                                NodeStructure::expected_t startBranchExpected = startChildNode.getBrN_C()[iWindowStart] - startChildNode.getBrN_C()[iWindowEnd + 1];
-                                for (size_t j=i+1; j < thisNode.getChildren().size(); ++j) {
+                                NodeStructure::expected_t startBranchSum = startChildNode.getBrN_C()[iWindowStart] - startChildNode.getBrN_C()[iWindowEnd + 1];
+                                NodeStructure::count_t startBranchTotalC = startChildNode.getBrC();
+                                NodeStructure::expected_t startBranchTotalN = startChildNode.getBrN();
+                                for (size_t j = i + 1; j < thisNode.getChildren().size(); ++j) {
                                     const NodeStructure& stopChildNode(*(thisNode.getChildren()[j]));
                                     NodeStructure::count_t stopBranchWindow = stopChildNode.getBrC_C()[iWindowStart] - stopChildNode.getBrC_C()[iWindowEnd + 1];
-                                    NodeStructure::expected_t stopBranchExpected = stopChildNode.getBrN_C()[iWindowStart] - stopChildNode.getBrN_C()[iWindowEnd + 1];
-                                    CutStructure * cut = calculateCut(n, startBranchWindow + stopBranchWindow, startBranchExpected + stopBranchExpected, calcLogLikelihood, iWindowStart, iWindowEnd);
+                                    NodeStructure::expected_t stopBranchSum = stopChildNode.getBrN_C()[iWindowStart] - stopChildNode.getBrN_C()[iWindowEnd + 1];
+                                    CutStructure * cut = calculateCut(cuts, n, startBranchWindow + stopBranchWindow, startBranchSum + stopBranchSum, 
+                                                                      startBranchTotalC + stopChildNode.getBrC(), startBranchTotalN + stopChildNode.getBrN(),
+                                                                      calcLogLikelihood, iWindowStart, iWindowEnd);
                                     if (cut) {
                                         cut->addCutChild(startChildNode.getID(), true);
                                         cut->addCutChild(stopChildNode.getID());
@@ -3166,28 +3206,37 @@ bool ScanRunner::scanTreeTemporalConditionNodeTime() {
                 case Parameters::TRIPLETS:
                     // Triple cuts: ABCD -> AB, AC, ABC, AD, ABD, ACD, BC, BD, BCD, CD
                     iMaxEndWindow = std::min(endWindow.getEnd(), startWindow.getEnd() + window->maximum());
-                    for (iWindowEnd=endWindow.getStart(); iWindowEnd <= iMaxEndWindow; ++iWindowEnd) {
-                        window->windowstart(startWindow, iWindowEnd, iMinWindowStart, iWindowStart);
+                    for (iWindowEnd = endWindow.getStart(); iWindowEnd <= iMaxEndWindow; ++iWindowEnd) {
+                        window->windowstart(startWindow, iWindowEnd, iMinWindowStart, iWindowStart, thisNode.getMinCensoredBr());
                         for (; iWindowStart >= iMinWindowStart; --iWindowStart) {
-                            for (size_t i=0; i < thisNode.getChildren().size() - 1; ++i) {
+                            for (size_t i = 0; i < thisNode.getChildren().size() - 1; ++i) {
                                 const NodeStructure& startChildNode(*(thisNode.getChildren()[i]));
                                 NodeStructure::count_t startBranchWindow = startChildNode.getBrC_C()[iWindowStart] - startChildNode.getBrC_C()[iWindowEnd + 1];
-                                NodeStructure::expected_t startBranchExpected = startChildNode.getBrN_C()[iWindowStart] - startChildNode.getBrN_C()[iWindowEnd + 1];
-                                for (size_t j=i+1; j < thisNode.getChildren().size(); ++j) {
+                                NodeStructure::expected_t startBranchSum = startChildNode.getBrN_C()[iWindowStart] - startChildNode.getBrN_C()[iWindowEnd + 1];
+                                NodeStructure::count_t startBranchTotalC = startChildNode.getBrC();
+                                NodeStructure::expected_t startBranchTotalN = startChildNode.getBrN();
+                                for (size_t j = i + 1; j < thisNode.getChildren().size(); ++j) {
                                     const NodeStructure& stopChildNode(*(thisNode.getChildren()[j]));
                                     NodeStructure::count_t stopBranchWindow = stopChildNode.getBrC_C()[iWindowStart] - stopChildNode.getBrC_C()[iWindowEnd + 1];
-                                    NodeStructure::expected_t stopBranchExpected = stopChildNode.getBrN_C()[iWindowStart] - stopChildNode.getBrN_C()[iWindowEnd + 1];
-                                    CutStructure * cut = calculateCut(n, startBranchWindow + stopBranchWindow, startBranchExpected + stopBranchExpected, calcLogLikelihood, iWindowStart, iWindowEnd);
+                                    NodeStructure::expected_t stopBranchSum = stopChildNode.getBrN_C()[iWindowStart] - stopChildNode.getBrN_C()[iWindowEnd + 1];
+                                    NodeStructure::count_t stopBranchTotalC = stopChildNode.getBrC();
+                                    NodeStructure::expected_t stopBranchTotalN = stopChildNode.getBrN();
+                                    CutStructure * cut = calculateCut(cuts, n, startBranchWindow + stopBranchWindow, startBranchSum + stopBranchSum, 
+                                                                      startBranchTotalC + stopBranchTotalC, startBranchTotalN + stopBranchTotalN,
+                                                                      calcLogLikelihood, iWindowStart, iWindowEnd);
                                     if (cut) {
                                         cut->addCutChild(startChildNode.getID(), true);
                                         cut->addCutChild(stopChildNode.getID());
                                     }
-                                    for (size_t k=i+1; k < j; ++k) {
+                                    for (size_t k = i + 1; k < j; ++k) {
                                         const NodeStructure& middleChildNode(*(thisNode.getChildren()[k]));
                                         NodeStructure::count_t middleBranchWindow = middleChildNode.getBrC_C()[iWindowStart] - middleChildNode.getBrC_C()[iWindowEnd + 1];
-                                        NodeStructure::expected_t middleBranchExpected = middleChildNode.getBrN_C()[iWindowStart] - middleChildNode.getBrN_C()[iWindowEnd + 1];
-                                        //printf("Evaluating cut [%s,%s,%s]\n", startChildNode.getIdentifier().c_str(), middleChildNode.getIdentifier().c_str(), stopChildNode.getIdentifier().c_str());
-                                        cut = calculateCut(n, startBranchWindow + middleBranchWindow + stopBranchWindow, startBranchExpected + middleBranchExpected + stopBranchExpected, calcLogLikelihood, iWindowStart, iWindowEnd);
+                                        NodeStructure::expected_t middleBranchSum = middleChildNode.getBrN_C()[iWindowStart] - middleChildNode.getBrN_C()[iWindowEnd + 1];
+                                        NodeStructure::count_t middleBranchTotalC = middleChildNode.getBrC();
+                                        NodeStructure::expected_t middleBranchTotalN = middleChildNode.getBrN();
+                                        CutStructure * cut = calculateCut(cuts, n, startBranchWindow + middleBranchWindow + stopBranchWindow, startBranchSum + middleBranchSum + stopBranchSum, 
+                                                                          startBranchTotalC + middleBranchTotalC + stopBranchTotalC, startBranchTotalN + middleBranchTotalN + stopBranchTotalN,
+                                                                          calcLogLikelihood, iWindowStart, iWindowEnd);
                                         if (cut) {
                                             cut->addCutChild(startChildNode.getID(), true);
                                             cut->addCutChild(middleChildNode.getID());
@@ -3199,16 +3248,143 @@ bool ScanRunner::scanTreeTemporalConditionNodeTime() {
                         }
                     } break;
                 case Parameters::COMBINATORIAL:
-                default: throw prg_error("Unknown cut type (%d).", "scanTreeTemporalConditionNodeTime()", cutType);
+                default: throw prg_error("Unknown cut type (%d).", "scanTreeTemporalConditionNode()", cutType);
+                }
+            }
+        }
+    });
+    rankCutsAndReportMostLikely();
+    return _Cut.size() != 0;
+}
+
+/** SCANNING THE TREE for temporal model -- conditioned on the total cases across nodes and time. */
+bool ScanRunner::scanTreeTemporalConditionNodeTime() {
+    _print.Printf("Scanning the tree.\n", BasePrint::P_STDOUT);
+
+    // Define the start and end windows with the zero index offset already incorporated.
+    DataTimeRange startWindow(temporalStartRange().getStart() + _zero_translation_additive,
+                              temporalStartRange().getEnd() + _zero_translation_additive),
+                  endWindow(temporalEndRange().getStart() + _zero_translation_additive,
+                            temporalEndRange().getEnd() + _zero_translation_additive);
+    // Define the minimum and maximum window lengths.
+    scanNodes(_Nodes.size(), [this, &startWindow, &endWindow](size_t first, size_t last, BestCutTable& cuts, const Loglikelihood_t& calcLogLikelihood) {
+        std::shared_ptr<AbstractWindowLength> window(getNewWindowLength());
+        int  iWindowStart, iMinWindowStart, iWindowEnd, iMaxEndWindow;
+        for (size_t n=first; n < last; ++n) {
+            if (isEvaluated(*_Nodes[n])) {
+                const NodeStructure& thisNode(*(_Nodes[n]));
+                // always do simple cut
+                iMaxEndWindow = std::min(endWindow.getEnd(), startWindow.getEnd() + window->maximum());
+                for (iWindowEnd=endWindow.getStart(); iWindowEnd <= iMaxEndWindow; ++iWindowEnd) {
+                    window->windowstart(startWindow, iWindowEnd, iMinWindowStart, iWindowStart);
+                    for (; iWindowStart >= iMinWindowStart; --iWindowStart) {
+                        //_print.Printf("%d to %d\n", BasePrint::P_STDOUT,iWindowStart, iWindowEnd);
+                        calculateCut(cuts, n, thisNode.getBrC_C()[iWindowStart] - thisNode.getBrC_C()[iWindowEnd + 1],
+                                      thisNode.getBrN_C()[iWindowStart] - thisNode.getBrN_C()[iWindowEnd + 1],
+                                      calcLogLikelihood, iWindowStart, iWindowEnd);
+                    }
+                }
+                //if (thisNode.getChildren().size() == 0) continue;
+                Parameters::CutType cutType = thisNode.getChildren().size() >= 2 ? thisNode.getCutType() : Parameters::SIMPLE;
+                switch (cutType) {
+                    case Parameters::SIMPLE: break; // already done, regardless of specified node cut
+                    case Parameters::ORDINAL: {
+                        // Ordinal cuts: ABCD -> AB, ABC, ABCD, BC, BCD, CD
+                        CutStructure::CutChildContainer_t currentChildren;
+                        iMaxEndWindow = std::min(endWindow.getEnd(), startWindow.getEnd() + window->maximum());
+                        for (iWindowEnd=endWindow.getStart(); iWindowEnd <= iMaxEndWindow; ++iWindowEnd) {
+                            window->windowstart(startWindow, iWindowEnd, iMinWindowStart, iWindowStart);
+                            for (; iWindowStart >= iMinWindowStart; --iWindowStart) {
+                                for (size_t i=0; i < thisNode.getChildren().size() - 1; ++i) {
+                                    const NodeStructure& firstChildNode(*(thisNode.getChildren()[i]));
+                                    currentChildren.clear();
+                                    currentChildren.push_back(firstChildNode.getID());
+                                    NodeStructure::count_t branchWindow = firstChildNode.getBrC_C()[iWindowStart] - firstChildNode.getBrC_C()[iWindowEnd + 1];
+                                    NodeStructure::expected_t branchExpected = firstChildNode.getBrN_C()[iWindowStart] - firstChildNode.getBrN_C()[iWindowEnd + 1];
+                                    for (size_t j=i+1; j < thisNode.getChildren().size(); ++j) {
+                                        const NodeStructure& childNode(*(thisNode.getChildren()[j]));
+                                        currentChildren.push_back(childNode.getID());
+                                        branchWindow += childNode.getBrC_C()[iWindowStart] - childNode.getBrC_C()[iWindowEnd + 1];
+                                        branchExpected += childNode.getBrN_C()[iWindowStart] - childNode.getBrN_C()[iWindowEnd + 1];
+                                        CutStructure * cut = calculateCut(cuts, n, branchWindow, branchExpected, calcLogLikelihood, iWindowStart, iWindowEnd);
+                                        if (cut) {
+                                            cut->setCutChildren(currentChildren);
+                                        }
+                                    }
+                                }
+                            }
+                        }
+                    } break;
+                    case Parameters::PAIRS:
+                        // Pair cuts: ABCD -> AB, AC, AD, BC, BD, CD
+                        iMaxEndWindow = std::min(endWindow.getEnd(), startWindow.getEnd() + window->maximum());
+                        for (iWindowEnd=endWindow.getStart(); iWindowEnd <= iMaxEndWindow; ++iWindowEnd) {
+                            window->windowstart(startWindow, iWindowEnd, iMinWindowStart, iWindowStart);
+                            for (; iWindowStart >= iMinWindowStart; --iWindowStart) {
+                                for (size_t i=0; i < thisNode.getChildren().size() - 1; ++i) {
+                                    const NodeStructure& startChildNode(*(thisNode.getChildren()[i]));
+                                    NodeStructure::count_t startBranchWindow = startChildNode.getBrC_C()[iWindowStart] - startChildNode.getBrC_C()[iWindowEnd + 1];
+                                    NodeStructure::expected_t startBranchExpected = startChildNode.getBrN_C()[iWindowStart] - startChildNode.getBrN_C()[iWindowEnd + 1];
+                                    for (size_t j=i+1; j < thisNode.getChildren().size(); ++j) {
+                                        const NodeStructure& stopChildNode(*(thisNode.getChildren()[j]));
+                                        NodeStructure::count_t stopBranchWindow = stopChildNode.getBrC_C()[iWindowStart] - stopChildNode.getBrC_C()[iWindowEnd + 1];
+                                        NodeStructure::expected_t stopBranchExpected = stopChildNode.getBrN_C()[iWindowStart] - stopChildNode.getBrN_C()[iWindowEnd + 1];
+                                        CutStructure * cut = calculateCut(cuts, n, startBranchWindow + stopBranchWindow, startBranchExpected + stopBranchExpected, calcLogLikelihood, iWindowStart, iWindowEnd);
+                                        if (cut) {
+                                            cut->addCutChild(startChildNode.getID(), true);
+                                            cut->addCutChild(stopChildNode.getID());
+                                        }
+                                    }
+                                }
+                            }
+                        } break;
+                    case Parameters::TRIPLETS:
+                        // Triple cuts: ABCD -> AB, AC, ABC, AD, ABD, ACD, BC, BD, BCD, CD
+                        iMaxEndWindow = std::min(endWindow.getEnd(), startWindow.getEnd() + window->maximum());
+                        for (iWindowEnd=endWindow.getStart(); iWindowEnd <= iMaxEndWindow; ++iWindowEnd) {
+                            window->windowstart(startWindow, iWindowEnd, iMinWindowStart, iWindowStart);
+                            for (; iWindowStart >= iMinWindowStart; --iWindowStart) {
+                                for (size_t i=0; i < thisNode.getChildren().size() - 1; ++i) {
+                                    const NodeStructure& startChildNode(*(thisNode.getChildren()[i]));
+                                    NodeStructure::count_t startBranchWindow = startChildNode.getBrC_C()[iWindowStart] - startChildNode.getBrC_C()[iWindowEnd + 1];
+                                    NodeStructure::expected_t startBranchExpected = startChildNode.getBrN_C()[iWindowStart] - startChildNode.getBrN_C()[iWindowEnd + 1];
+                                    for (size_t j=i+1; j < thisNode.getChildren().size(); ++j) {
+                                        const NodeStructure& stopChildNode(*(thisNode.getChildren()[j]));
+                                        NodeStructure::count_t stopBranchWindow = stopChildNode.getBrC_C()[iWindowStart] - stopChildNode.getBrC_C()[iWindowEnd + 1];
+                                        NodeStructure::expected_t stopBranchExpected = stopChildNode.getBrN_C()[iWindowStart] - stopChildNode.getBrN_C()[iWindowEnd + 1];
+                                        CutStructure * cut = calculateCut(cuts, n, startBranchWindow + stopBranchWindow, startBranchExpected + stopBranchExpected, calcLogLikelihood, iWindowStart, iWindowEnd);
+                                        if (cut) {
+                                            cut->addCutChild(startChildNode.getID(), true);
+                                            cut->addCutChild(stopChildNode.getID());
+                                        }
+                                        for (size_t k=i+1; k < j; ++k) {
+                                            const NodeStructure& middleChildNode(*(thisNode.getChildren()[k]));
+                                            NodeStructure::count_t middleBranchWindow = middleChildNode.getBrC_C()[iWindowStart] - middleChildNode.getBrC_C()[iWindowEnd + 1];
+                                            NodeStructure::expected_t middleBranchExpected = middleChildNode.getBrN_C()[iWindowStart] - middleChildNode.getBrN_C()[iWindowEnd + 1];
+                                            //printf("Evaluating cut [%s,%s,%s]\n", startChildNode.getIdentifier().c_str(), middleChildNode.getIdentifier().c_str(), stopChildNode.getIdentifier().c_str());
+                                            cut = calculateCut(cuts, n, startBranchWindow + middleBranchWindow + stopBranchWindow, startBranchExpected + middleBranchExpected + stopBranchExpected, calcLogLikelihood, iWindowStart, iWindowEnd);
+                                            if (cut) {
+                                                cut->addCutChild(startChildNode.getID(), true);
+                                                cut->addCutChild(middleChildNode.getID());
+                                                cut->addCutChild(stopChildNode.getID());
+                                            }
+                                        }
+                                    }
+                                }
+                            }
+                        } break;
+                    case Parameters::COMBINATORIAL:
+                    default: throw prg_error("Unknown cut type (%d).", "scanTreeTemporalConditionNodeTime()", cutType);
+                }
             }
         }
-    } 
+    });
     rankCutsAndReportMostLikely();
     return _Cut.size() != 0;
 }
 
 /** Calculates the log likelihood of the cut over evaluation currently, then updates collection of best cuts by node. */
-CutStructure* ScanRunner::calculateCut(size_t node_index, const SampleSiteMap_t& samplesiteData, const Loglikelihood_t& logCalculator) {
+CutStructure* ScanRunner::calculateCut(BestCutTable& cuts, size_t node_index, const SampleSiteMap_t& samplesiteData, const Loglikelihood_t& logCalculator) {
     double loglikelihood = logCalculator->LogLikelihoodRatio(SampleSiteMapDifferenceProxy(samplesiteData));
     // Apply scan rate type filtering to exclude cuts that do not meet criteria.
     switch (_parameters.getScanRateType()) {
@@ -3225,17 +3401,17 @@ CutStructure* ScanRunner::calculateCut(size_t node_index, const SampleSiteMap_t&
             if (loglikelihood <= 0.0 || loglikelihood == logCalculator->UNSET_LOGLIKELIHOOD)
                 return 0;
     }
-    // If we reach this point, the cut is valid.
-    std::unique_ptr<CutStructure> cut(new CutStructure());
-    cut->setLogLikelihood(loglikelihood);
-    cut->setID(static_cast<int>(node_index));
-    cut->setSampleSiteData(samplesiteData);
-    // Now add the cut to the collection of best cuts, possibly replacing an existing cut for this node.
-    return updateCut(cut);
+    // If we reach this point, the cut is valid -- record it if it is the best cut of this node so far.
+    CutStructure * cut = cuts.update(node_index, 0, loglikelihood);
+    if (cut) {
+        cut->setID(static_cast<int>(node_index));
+        cut->setSampleSiteData(samplesiteData);
+    }
+    return cut;
 }
 
 /** Calculates the log likelihood of the cut over evaluation currently, then updates collection of best cuts by node. */
-CutStructure * ScanRunner::calculateCut(size_t node_index, int BrC, double BrN, const Loglikelihood_t& logCalculator, DataTimeRange::index_t startIdx, DataTimeRange::index_t endIdx, int BrC_All, double BrN_All) {
+CutStructure * ScanRunner::calculateCut(BestCutTable& cuts, size_t node_index, int BrC, double BrN, const Loglikelihood_t& logCalculator, DataTimeRange::index_t startIdx, DataTimeRange::index_t endIdx, int BrC_All, double BrN_All) {
     // Skip calculation if branch count does not meet evaluation minimum.
     if (BrC < static_cast<int>(_node_evaluation_minimum)) return 0;
 
@@ -3256,85 +3432,43 @@ CutStructure * ScanRunner::calculateCut(size_t node_index, int BrC, double BrN,
         loglikelihood = logCalculator->LogLikelihood(BrC, BrN, BrC_All, BrN_All);
     else
         loglikelihood = logCalculator->LogLikelihood(BrC, BrN);
-    if (loglikelihood == logCalculator->UNSET_LOGLIKELIHOOD &&
+    return recordCut(cuts, node_index, BrC, BrN, loglikelihood, startIdx, endIdx);
+}
+
+/** Calculates the log likelihood of the cut in a window of the uniform temporal scan, then updates collection of best cuts by node. */
+CutStructure * ScanRunner::calculateCut(BestCutTable& cuts, size_t node_index, int BrC, double BrN, const Loglikelihood_t& logCalculator, const TemporalWindowScan& windows, size_t window) {
+    // Skip calculation if branch count does not meet evaluation minimum.
+    if (BrC < static_cast<int>(_node_evaluation_minimum)) return 0;
+    // A window where every time interval is excluded has no length -- its log likelihood is left at zero.
+    double loglikelihood = windows.getLength(window) ? logCalculator->LogLikelihood(BrC, BrN, windows.getLength(window)) : 0;
+    return recordCut(cuts, node_index, BrC, BrN, loglikelihood, windows.getStart(window), windows.getEnd(window));
+}
+
+/** Records cut with calculated log likelihood in the table of best cuts by node, unless the log likelihood is unset. */
+CutStructure * ScanRunner::recordCut(BestCutTable& cuts, size_t node_index, int BrC, double BrN, double loglikelihood, DataTimeRange::index_t startIdx, DataTimeRange::index_t endIdx) {
+    if (loglikelihood == AbstractLoglikelihood::UNSET_LOGLIKELIHOOD &&
         !(_parameters.isSequentialScanTreeOnly() && getSequentialStatistic().testCutSignaled(static_cast<int>(node_index)) != 0))
         // Exclude this cut if log likelihood is unset -- unless we're tree sequential scanning and this cut has signalled in prior looks.
         return 0;
 
-    std::unique_ptr<CutStructure> cut(new CutStructure());
-    cut->setLogLikelihood(loglikelihood);
-    cut->setID(static_cast<int>(node_index));
-    cut->setC(BrC);
-    cut->setN(BrN);
-    cut->setStartIdx(startIdx);
-    cut->setEndIdx(endIdx);
-
-    return updateCut(cut);
+    CutStructure * cut = cuts.update(node_index, endIdx, loglikelihood);
+    if (cut) {
+        cut->setID(static_cast<int>(node_index));
+        cut->setC(BrC);
+        cut->setN(BrN);
+        cut->setStartIdx(startIdx);
+        cut->setEndIdx(endIdx);
+    }
+    return cut;
 }
 
 /** Calculates the log likelihood of the cut over evaluation currently, then updates collection of best cuts by node. */
-CutStructure * ScanRunner::calculateCut(size_t node_index, int C, double N, int BrC, double BrN, const Loglikelihood_t& logCalculator, DataTimeRange::index_t startIdx, DataTimeRange::index_t endIdx) {
+CutStructure * ScanRunner::calculateCut(BestCutTable& cuts, size_t node_index, int C, double N, int BrC, double BrN, const Loglikelihood_t& logCalculator, DataTimeRange::index_t startIdx, DataTimeRange::index_t endIdx) {
     // Skip calculation if branch count does not meet evaluation minimum.
     if (BrC < static_cast<int>(_node_evaluation_minimum)) return 0;
     double loglikelihood = logCalculator->LogLikelihood(C, N, BrC, BrN);
     if (loglikelihood == logCalculator->UNSET_LOGLIKELIHOOD) return 0;
-    std::unique_ptr<CutStructure> cut(new CutStructure());
-    cut->setLogLikelihood(loglikelihood);
-    cut->setID(static_cast<int>(node_index));
-    cut->setC(C);
-    cut->setN(N);
-    cut->setStartIdx(startIdx);
-    cut->setEndIdx(endIdx);
-
-    return updateCut(cut);
-}
-
-CutStructure * ScanRunner::updateCut(std::unique_ptr<CutStructure>& cut) {
-    CutStructureContainer_t::iterator itr;
-    if (_parameters.getScanType() == Parameters::TIMEONLY) {
-        // for time-only scans, we want to keep secondary clusters -- possibly one for each end date
-        itr = std::lower_bound(_Cut.begin(), _Cut.end(), cut.get(), CompareCutsByEndIdx());
-        if (!(itr != _Cut.end() && (*itr)->getEndIdx() == cut->getEndIdx()))
-            return *(_Cut.insert(itr, cut.release()));
-    } else {
-        // we're keeping the best cut for each node
-        itr = std::lower_bound(_Cut.begin(), _Cut.end(), cut.get(), CompareCutsById());
-        if (!(itr != _Cut.end() && (*itr)->getID() == cut->getID()))
-            return *(_Cut.insert(itr, cut.release()));
-    }
-    // at this point, we're replacing a cut with better log likelihood cut
-    if (_parameters.getModelType() == Parameters::SIGNED_RANK) {
-        switch (_parameters.getScanRateType()) {
-            case Parameters::LOWRATE:
-                if (cut->getLogLikelihood() < (*itr)->getLogLikelihood()) {
-                    size_t idx = std::distance(_Cut.begin(), itr);
-                    delete _Cut[idx]; _Cut[idx] = 0;
-                    _Cut[idx] = cut.release();
-                    return _Cut[idx];
-                } break;
-            case Parameters::HIGHORLOWRATE:
-                if (std::abs(cut->getLogLikelihood()) > std::abs((*itr)->getLogLikelihood())) {
-                    size_t idx = std::distance(_Cut.begin(), itr);
-                    delete _Cut[idx]; _Cut[idx] = 0;
-                    _Cut[idx] = cut.release();
-                    return _Cut[idx];
-                } break;
-            case Parameters::HIGHRATE:
-            default:
-                if (cut->getLogLikelihood() > (*itr)->getLogLikelihood()) {
-                    size_t idx = std::distance(_Cut.begin(), itr);
-                    delete _Cut[idx]; _Cut[idx] = 0;
-                    _Cut[idx] = cut.release();
-                    return _Cut[idx];
-                } break;
-        }
-    } else if (cut->getLogLikelihood() > (*itr)->getLogLikelihood()) { // for other models, higher log likelihood is always better
-        size_t idx = std::distance(_Cut.begin(), itr);
-        delete _Cut[idx]; _Cut[idx] = 0;
-        _Cut[idx] = cut.release();
-        return _Cut[idx];
-    }
-    return 0;
+    return recordCut(cuts, node_index, C, N, loglikelihood, startIdx, endIdx);
 }
 
 /** SETTING UP THE TREE */
@@ -3513,10 +3647,9 @@ bool ScanRunner::setupTree() {
             _print.Printf("Error: Node '%s' has itself as an ancestor.\n", BasePrint::P_ERROR, (*itr)->getIdentifier().c_str());
             return false;
         }
-        // If we're do replications and there exist nodes with multiple parents, set ancestor indexes for this node.
-        if (_parameters.getNumReplicationsRequested() > 0 && _has_multi_parent_nodes)
-            (*itr)->setAncestors(ancestor_nodes);
     }
+    // Precompute the bottom-up order in which simulated data is added up the tree during replications.
+    _branch_aggregation.reset(new BranchAggregation(_Nodes));
 
     if (_parameters.getModelType() == Parameters::POISSON ||
         _parameters.getModelType() == Parameters::BERNOULLI_TREE ||
@@ -3545,6 +3678,9 @@ bool ScanRunner::setupTree() {
         if (pnode->assignLevel(notEvaluatedLevels) == 1) // assign node tree level and whether evaluated
             _rootNodes.push_back(pnode);
     }
+    // Compile the cuts evaluated by the tree scans of the real data and replicas, now that it's known which nodes are evaluated.
+    if (!Parameters::isTemporalScanType(_parameters.getScanType()))
+        _cut_plan.reset(new CutPlan(_Nodes, _parameters));
     // If tree sequential scan, determine which nodes are read from and/or written to the simulation data cache.
     if (_parameters.isSequentialScanTreeOnly()) {
         if (!_sequential_statistic->isFirstLook()) _sequential_read_nodes.resize(_Nodes.size()); // nothing to read on first look
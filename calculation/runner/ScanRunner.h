@@ -11,7 +11,9 @@
 #include "Parameters.h"
 #include "CriticalValues.h"
 #include "WindowLength.h"
+#include "TemporalWindowScan.h"
 #include "SampleSiteData.h"
+#include "TopValues.h"
 #include <iostream>
 #include <fstream>
 #include <limits>
@@ -22,6 +24,7 @@
 #include <iomanip>
 #include <algorithm>
 #include <set>
+#include <initializer_list>
 
 /** Matched Sets class for tree-only, unconditional Bernoull, with variable case probability. */
 class MatchedSets {
@@ -88,6 +91,7 @@ public:
         _report_order(0), _branch_order(0), _start_idx(0), _end_idx(1) {}
 
     void                    addCutChild(int cutID, bool clear=false) {if (clear) _cut_children.clear(); _cut_children.push_back(cutID);}
+    void                    clearCutChildren() {_cut_children.clear();}
     int                     getC() const {return _C; /* Observed */}
     const SampleSiteMap_t & getSampleSiteData() const { return _sample_site_data; }
     const CutChildContainer_t & getCutChildren() const {return _cut_children;}
@@ -108,7 +112,7 @@ public:
     double                  getRelativeRisk(const ScanRunner& scanner) const;
     DataTimeRange::index_t  getStartIdx() const {return _start_idx;}
     DataTimeRange::index_t  getEndIdx() const {return _end_idx;}
-    unsigned int            incrementRank() {return ++_rank;}
+    unsigned int            incrementRank(unsigned int count=1) {return _rank += count;}
     void                    setC(int i) {_C = i;}
     void                    setSampleSiteData(const SampleSiteMap_t& ssData) { _sample_site_data = ssData; }
     void                    setCutChildren(const CutChildContainer_t & c) {_cut_children = c;}
@@ -132,7 +136,6 @@ public:
     typedef std::vector<count_t> CountContainer_t;
     typedef std::vector<expected_t> ExpectedContainer_t;
     enum CumulativeStatus {NON_CUMULATIVE=0, CUMULATIVE};
-    typedef std::list<unsigned int> Ancestors_t;
     typedef std::list<std::pair<int, count_t> > CensorDist_t;
 
 protected:
@@ -159,8 +162,6 @@ protected:
     CountContainer_t        _IntC_Censored;     // Number of censored cases internal to the node.
     count_t                 _min_censored_Br;   // minimum censored on branch
 
-    Ancestors_t             _ancestors;         // nodes which have this node in tree branch
-
     void initialize_containers(const Parameters& parameters, size_t container_size) {
         _IntC_C.resize(container_size);
         _BrC_C.resize(container_size);
@@ -242,7 +243,6 @@ public:
     }
     bool isEvaluated() const { return _is_evaluated; }
     void setIsEvaluated(bool b) { _is_evaluated = b; }
-    const Ancestors_t& getAncestors() const {return _ancestors;}
     CensorDist_t& getCensorDistribution(CensorDist_t& censor_distribution) const {
         censor_distribution.clear();
         NodeStructure::count_t nodeCensored=0, nodeCount = getIntC();
@@ -357,12 +357,6 @@ public:
         _is_evaluated &= std::find(notEvaluatedLevels.begin(), notEvaluatedLevels.end(), _level) == notEvaluatedLevels.end();
         return _level;
     }
-    void setAncestors(boost::dynamic_bitset<>& ancestor_nodes) {
-        // convert ON bits in set to indexes stored in _ancestors container
-        _ancestors.clear();
-        for (boost::dynamic_bitset<>::size_type p=ancestor_nodes.find_first(); p != ancestor_nodes.npos; p = ancestor_nodes.find_next(p))
-            _ancestors.push_back(static_cast<unsigned int>(p));
-    }
     void setCumulative() {
         if (_cumulative_status == NON_CUMULATIVE) {
             TreeScan::cumulative_backward(_IntC_C);
@@ -396,18 +390,18 @@ public:
     }
 };
 
-class CompareCutsById {
-public:
-    bool operator() (const CutStructure * lhs, const CutStructure * rhs) {
-        return lhs->getID() > rhs->getID();
-    }
-};
+/** Open addressing hash index of the node identifiers to node positions. Slots hold positions in the nodes collection, so identifiers
+    are not copied and a lookup compares against the identifiers of the nodes themselves. */
+class NodeIdentifierIndex {
+    private:
+        std::vector<size_t> _slots; // node position plus one, zero when empty
+        size_t              _mask;
 
-class CompareCutsByEndIdx {
-public:
-    bool operator() (const CutStructure * lhs, const CutStructure * rhs) {
-        return lhs->getEndIdx() < rhs->getEndIdx();
-    }
+    public:
+        NodeIdentifierIndex() : _mask(0) {}
+
+        void                    build(const ptr_vector<NodeStructure>& nodes);
+        std::pair<bool,size_t>  find(const ptr_vector<NodeStructure>& nodes, const std::string& identifier) const;
 };
 
 class CompareCutsByLoglikelihood {
@@ -440,6 +434,29 @@ public:
     }
 };
 
+/** The best cut of each node -- or, for time-only scans, of each window end index -- while scanning the tree, as a dense array of slots.
+    A candidate is compared against the log likelihood of its slot only; the slot's CutStructure is allocated with its first cut and
+    overwritten by better cuts. Slots are independent, so threads scanning distinct nodes may update the table concurrently. */
+class BestCutTable {
+private:
+    const Parameters::ModelType _model_type;
+    const Parameters::ScanRateType _scan_rate;
+    const bool _by_end_index;                   // time-only scans keep the best cut of each window end index
+    std::vector<double> _loglikelihoods;
+    std::vector<CutStructure*> _cuts;
+
+    bool isBetter(double loglikelihood, double best) const;
+
+public:
+    BestCutTable(size_t num_nodes, const Parameters& parameters);
+    BestCutTable(const BestCutTable&) = delete;
+    BestCutTable& operator=(const BestCutTable&) = delete;
+    ~BestCutTable();
+
+    CutStructure * update(size_t node_index, DataTimeRange::index_t endIdx, double loglikelihood);
+    void release(ptr_vector<CutStructure>& cuts);
+};
+
 struct TreeStatistics {
     typedef std::map<unsigned int, unsigned int> NodesLevel_t;
 
@@ -472,22 +489,91 @@ struct TreeStatistics {
     TreeStatistics() : _num_nodes(0), _num_nodes_evaluated(0), _num_root(0), _num_leaf(0), _num_parent(0) {}
 };
 
+/** Precomputed bottom-up order for summing node data into branch totals in one linear pass. Every node is placed after all of its
+    descendants. A node's branch total is its own data plus the branch totals of its children, unless children share descendants
+    (multiple parents) - then the branch total is summed over the node's distinct descendants instead, so no data is counted twice. */
+class BranchAggregation {
+public:
+    typedef std::vector<unsigned int> Indexes_t;
+    struct Step {
+        unsigned int _node;         // node which branch total is calculated
+        bool _from_children;        // sources are children (branch totals) or otherwise all distinct descendants, self included (node totals)
+        size_t _begin;              // range of source node indexes in _sources
+        size_t _end;
+
+        Step(unsigned int node, bool from_children, size_t begin, size_t end) : _node(node), _from_children(from_children), _begin(begin), _end(end) {}
+    };
+    typedef std::vector<Step> Steps_t;
+
+private:
+    Steps_t _steps;
+    Indexes_t _sources;
+
+public:
+    BranchAggregation(const ptr_vector<NodeStructure>& nodes);
+
+    const Steps_t & getSteps() const { return _steps; }
+    const Indexes_t & getSources() const { return _sources; }
+};
+
+/** The cuts evaluated in scanning the tree, compiled once the tree is set up: for each evaluated node, the node's branch followed by the
+    ordinal, pair or triplet cuts of its children. Scans of the real data and of every replica iterate these flat arrays rather than
+    walking each node's children and cut type. Whether a node is evaluated also depends on its branch cases, so is left to the scan. */
+class CutPlan {
+public:
+    struct Cut {
+        unsigned int _nodes[3];     // nodes summed by the cut, in order of summation -- a triplet's start and stop children, then its middle child
+        unsigned int _size;         // number of nodes in _nodes
+        bool _extends;              // whether the cut adds its nodes to the sum of the previous cut (the ordinal cuts of a run after its first)
+        double _BrN;                // expected of the cut, summed in the order the scans always have
+
+        /* Adds the cut's nodes to 'children' in reporting order -- a triplet's middle child between its start and stop children. */
+        void addChildren(std::vector<int>& children) const {
+            children.push_back(static_cast<int>(_nodes[0]));
+            if (_size == 3) children.push_back(static_cast<int>(_nodes[2]));
+            if (_size > 1) children.push_back(static_cast<int>(_nodes[1]));
+        }
+    };
+    struct Node {
+        unsigned int _node;         // evaluated node
+        size_t _begin;              // range of the node's cuts in _cuts -- the first cut being the node's branch
+        size_t _end;
+
+        Node(unsigned int node, size_t begin, size_t end) : _node(node), _begin(begin), _end(end) {}
+    };
+    typedef std::vector<Cut> Cuts_t;
+    typedef std::vector<Node> Nodes_t;
+
+private:
+    Nodes_t _nodes;
+    Cuts_t _cuts;
+
+    void addCut(std::initializer_list<const NodeStructure*> nodes, bool extends, double BrN);
+
+public:
+    CutPlan(const ptr_vector<NodeStructure>& nodes, const Parameters& parameters);
+
+    const Nodes_t & getNodes() const { return _nodes; }
+    const Cuts_t & getCuts() const { return _cuts; }
+};
+
 class AbstractRandomizer;
 class RelativeRiskAdjustmentHandler;
 
 typedef std::pair<double, unsigned int> llr_sim_t;
 
+/* Orders by descending log likelihood ratio, then by ascending simulation index -- the order simulations are added in. */
 class compare_llr_sim_t {
 public:
-    bool operator() (const llr_sim_t &lhs, const llr_sim_t &rhs) {
-        return lhs.first > rhs.first;
+    bool operator() (const llr_sim_t &lhs, const llr_sim_t &rhs) const {
+        return lhs.first > rhs.first || (lhs.first == rhs.first && lhs.second < rhs.second);
     }
 };
 
 class SequentialStatistic {
     public:
         typedef std::vector<double>                     alpha_spending_container_t;
-        typedef std::deque<llr_sim_t>                   llr_sim_container_t;
+        typedef TopValues<llr_sim_t, compare_llr_sim_t> llr_sim_container_t;
         typedef std::map<unsigned int, unsigned int>    signalled_cuts_container_t;
 
         static const char         * _file_suffix;
@@ -533,7 +619,7 @@ class SequentialStatistic {
         bool                        isMarkedSimulation(unsigned int simIdx) const { return _alpha_simulations.test(simIdx - 1); }
         const std::string         & getCountDataFilename() const { return _counts_filename; }
         const std::string         & getControlDataFilename() const { return _controls_filename; }
-        double                      getCriticalValue() const { return _llr_sims.back().first; }
+        double                      getCriticalValue() const { return _llr_sims.worst().first; }
         const std::string         & getSimulationDataFilename() const { return _simulations_filename; }
         std::string                 getSimulationDataArchiveName() const {
             std::string archivename(_simulations_filename);
@@ -571,11 +657,14 @@ public:
     typedef std::vector<unsigned int>                           TimeIntervalContainer_t;
     typedef std::vector<TimeIntervalContainer_t>                DayOfWeekIndexes_t;
     typedef std::shared_ptr<TreeStatistics>                   TreeStatistics_t;
+    typedef std::shared_ptr<BranchAggregation>                BranchAggregation_t;
+    typedef std::shared_ptr<CutPlan>                          CutPlan_t;
     typedef std::shared_ptr<SequentialStatistic>              SequentialStatistic_t;
 
 protected:
     BasePrint                         & _print;
     NodeStructureContainer_t            _Nodes;
+    NodeIdentifierIndex                 _node_index;
     std::vector<std::string>            _sample_site_identifiers;
     NodeStructure::ChildContainer_t     _rootNodes;
     CutStructureContainer_t             _Cut;
@@ -592,6 +681,8 @@ protected:
     PowerEstimationContainer_t          _power_estimations;
     DayOfWeekIndexes_t                  _day_of_week_indexes;
     mutable TreeStatistics_t            _tree_statistics;
+    mutable BranchAggregation_t         _branch_aggregation;
+    mutable CutPlan_t                   _cut_plan;
     bool                                _has_multi_parent_nodes;
     bool                                _censored_data;
     bool                                _has_node_descriptions;
@@ -624,16 +715,19 @@ protected:
     bool                        runPowerEvaluations();
     bool                        runsimulations(std::shared_ptr<AbstractRandomizer> randomizer, unsigned int num_relica, bool isPowerStep, unsigned int iteration=0);
     bool                        runsequentialsimulations(unsigned int num_relica);
+    template <typename ScanItems>
+    void                        scanNodes(size_t num_items, ScanItems scan);
     bool                        scanTree();
     bool                        scanTreeTemporalConditionNode();
     bool                        scanTreeTemporalConditionNodeCensored();
     bool                        scanTreeTemporalConditionNodeTime();
     bool                        scanTreeSignedRank();
     bool                        setupTree();
-    CutStructure *              calculateCut(size_t node_index, int BrC, double BrN, const Loglikelihood_t& logCalculator, DataTimeRange::index_t startIdx=0, DataTimeRange::index_t endIdx=1, int BrC_All=0, double BrN_All=0.0);
-    CutStructure *              calculateCut(size_t node_index, int C, double N, int BrC, double BrN, const Loglikelihood_t& logCalculator, DataTimeRange::index_t startIdxa, DataTimeRange::index_t endIdx);
-    CutStructure              * calculateCut(size_t node_index, const SampleSiteMap_t& samplesiteData, const Loglikelihood_t& logCalculator);
-    CutStructure *              updateCut(std::unique_ptr<CutStructure>& cut);
+    CutStructure *              calculateCut(BestCutTable& cuts, size_t node_index, int BrC, double BrN, const Loglikelihood_t& logCalculator, DataTimeRange::index_t startIdx=0, DataTimeRange::index_t endIdx=1, int BrC_All=0, double BrN_All=0.0);
+    CutStructure *              calculateCut(BestCutTable& cuts, size_t node_index, int C, double N, int BrC, double BrN, const Loglikelihood_t& logCalculator, DataTimeRange::index_t startIdxa, DataTimeRange::index_t endIdx);
+    CutStructure *              calculateCut(BestCutTable& cuts, size_t node_index, int BrC, double BrN, const Loglikelihood_t& logCalculator, const TemporalWindowScan& windows, size_t window);
+    CutStructure *              recordCut(BestCutTable& cuts, size_t node_index, int BrC, double BrN, double loglikelihood, DataTimeRange::index_t startIdx, DataTimeRange::index_t endIdx);
+    CutStructure              * calculateCut(BestCutTable& cuts, size_t node_index, const SampleSiteMap_t& samplesiteData, const Loglikelihood_t& logCalculator);
 
 public:
     ScanRunner(const Parameters& parameters, BasePrint& print);
@@ -700,6 +794,8 @@ public:
     double                             getTotalN() const {return _TotalN;}
     std::pair<int, double>             getTotalsFromLook() const { return _totals_in_look; }
     const TreeStatistics             & getTreeStatistics() const;
+    const BranchAggregation          & getBranchAggregation() const;
+    const CutPlan                    & getCutPlan() const;
     DataTimeRange::index_t             getZeroTranslationAdditive() const {return _zero_translation_additive;}
     bool                               isEvaluated(const NodeStructure& node) const;
     unsigned int                       getNodeEvaluationMinimum() const { return _node_evaluation_minimum; }
@@ -727,6 +823,7 @@ public:
     }
 
     std::shared_ptr<AbstractWindowLength> getNewWindowLength() const;
+    TemporalWindowScan getTemporalWindowScan() const;
     double get_node_n_time_total_cases(DataTimeRange::index_t start_idx, DataTimeRange::index_t end_idx) const {
         // Obtain the total number of cases in window range for all nodes.
         auto test = std::make_pair(start_idx, end_idx);
@@ -0,0 +1,51 @@
+//******************************************************************************
+#include "TreeScan.h"
+#pragma hdrstop
+//******************************************************************************
+#include "SignedRankCutScan.h"
+#include <algorithm>
+#include <cmath>
+
+/** Returns the number of bits needed to hold 'value'. */
+static size_t getBitWidth(size_t value) {
+    size_t width = 0;
+    for (; value; value >>= 1) ++width;
+    return width;
+}
+
+/** Constructor -- the doubled ranks of 'sample_sites' sample sites are at most 2 * sample_sites. */
+SignedRankCutScan::SignedRankCutScan(size_t sample_sites)
+    : _sample_sites(sample_sites), _words((sample_sites + 63) / 64), _planes(getBitWidth(2 * sample_sites)), _order(sample_sites) {}
+
+/** Ranks the sample site differences of a cut by absolute value, as SignedRankLoglikelihood does, and adds the cut. Zero differences
+    take their rank positions but contribute no rank; tied differences take the average of their rank positions. */
+void SignedRankCutScan::add(const double * differences) {
+    size_t stride = (_planes + 1) * _words;
+    _bits.resize(_bits.size() + stride, 0);
+    word_t * positive = &_bits[_bits.size() - stride], * planes = positive + _words;
+    for (size_t s=0; s < _sample_sites; ++s) _order[s] = s;
+    std::sort(_order.begin(), _order.end(), [differences](size_t a, size_t b) { return std::abs(differences[a]) < std::abs(differences[b]); });
+    std::uint64_t total = 0;
+    for (size_t i=0, j=0; i < _sample_sites; i = j) {
+        double absolute = std::abs(differences[_order[i]]);
+        for (j=i + 1; j < _sample_sites && std::abs(differences[_order[j]]) == absolute; ++j);
+        if (absolute == 0.0) continue;
+        std::uint64_t doubled = (i + 1) + j; // twice the average of rank positions i + 1 through j
+        total += doubled * (j - i);
+        for (size_t k=i; k < j; ++k) {
+            size_t site = _order[k], word = site / 64;
+            word_t bit = word_t(1) << (site % 64);
+            if (differences[site] > 0.0) positive[word] |= bit;
+            for (size_t p=0; p < _planes; ++p)
+                if ((doubled >> p) & 1) planes[p * _words + word] |= bit;
+        }
+    }
+    _offsets.push_back(static_cast<double>(total) / 2.0);
+}
+
+/** Sets 'words' to the bit set of the sample sites flipped in a replica. */
+void SignedRankCutScan::getFlips(const boost::dynamic_bitset<>& flips, word_t * words) const {
+    std::fill(words, words + _words, word_t(0));
+    for (size_t s=flips.find_first(); s != boost::dynamic_bitset<>::npos; s = flips.find_next(s))
+        words[s / 64] |= word_t(1) << (s % 64);
+}
@@ -0,0 +1,60 @@
+//******************************************************************************
+#ifndef __SignedRankCutScan_H
+#define __SignedRankCutScan_H
+//******************************************************************************
+#include <boost/dynamic_bitset.hpp>
+#include <cstdint>
+#include <vector>
+
+/** The signed ranks of the cuts evaluated by the signed rank (trend) simulations, ranked once per run. The signed rank randomizer only
+    flips the sign of each sample site, so the absolute differences of every cut -- and with them the ranks -- never change between
+    replicas. A replica's statistic is then the sum of the cut's ranks signed by whether the site's observed sign was flipped, calculated
+    by popcounts over bit sets of the sample sites: one of the sites with positive observed difference and one for each bit of the
+    doubled ranks (average ranks of ties being multiples of one half). */
+class SignedRankCutScan {
+    public:
+        typedef std::uint64_t word_t;
+
+    private:
+        const size_t _sample_sites;
+        const size_t _words;                        // words of a sample site bit set
+        const size_t _planes;                       // bit sets per cut for the doubled ranks
+        std::vector<word_t> _bits;                  // per cut: positive sites, then the rank bit sets -- each _words long
+        std::vector<double> _offsets;               // per cut: the sum of its ranks
+        std::vector<size_t> _order;                 // construction scratch -- sample sites ordered by absolute difference
+
+        static unsigned int popcount(word_t w) {
+#if defined(__GNUC__)
+            return static_cast<unsigned int>(__builtin_popcountll(w));
+#else
+            w = w - ((w >> 1) & 0x5555555555555555ULL);
+            w = (w & 0x3333333333333333ULL) + ((w >> 2) & 0x3333333333333333ULL);
+            w = (w + (w >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+            return static_cast<unsigned int>((w * 0x0101010101010101ULL) >> 56);
+#endif
+        }
+
+    public:
+        SignedRankCutScan(size_t sample_sites);
+
+        size_t          size() const { return _offsets.size(); }
+        size_t          getNumWords() const { return _words; }
+
+        void            add(const double * differences);
+        void            getFlips(const boost::dynamic_bitset<>& flips, word_t * words) const;
+
+        /* Returns the signed rank statistic of 'cut' given the sample sites flipped in the replica, as returned by getFlips(). */
+        double getLogLikelihoodRatio(size_t cut, const word_t * flips) const {
+            const word_t * positive = &_bits[cut * (_planes + 1) * _words], * plane = positive + _words;
+            std::uint64_t ranksum = 0;
+            for (size_t p=0; p < _planes; ++p, plane += _words) {
+                std::uint64_t count = 0;
+                for (size_t w=0; w < _words; ++w)
+                    count += popcount((positive[w] ^ flips[w]) & plane[w]);
+                ranksum += count << p;
+            }
+            return static_cast<double>(ranksum) - _offsets[cut];
+        }
+};
+//******************************************************************************
+#endif
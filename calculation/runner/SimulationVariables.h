@@ -3,6 +3,7 @@
 #define __SimulationVariables_H
 //*****************************************************************************
 #include "TreeScan.h"
+#include <algorithm>
 
 class SimulationVariables {
     public:
@@ -45,5 +46,32 @@ class SimulationVariables {
         void            reset(double mlc_llr) {init(mlc_llr);}
         void            set_sim_count_explicit(unsigned int i) {_simulations_count = i;}
 };
+
+/** The simulated maximum log likelihoods of a run, kept so the ranks of the cuts are resolved once the simulations complete rather than
+    for every cut with each replica. A cut's rank counts the simulated maxima at least its log likelihood. */
+class RankAccumulator {
+    private:
+        std::vector<double> _maxima;
+        bool                _sorted;
+
+    public:
+        RankAccumulator() : _sorted(true) {}
+
+        void add(double maximum) {
+            if (std::isnan(maximum)) return; // never at least any log likelihood
+            _sorted &= _maxima.empty() || !(maximum < _maxima.back());
+            _maxima.push_back(maximum);
+        }
+        /* Returns the number of maxima at least 'loglikelihood'. */
+        unsigned int countAtLeast(double loglikelihood) {
+            if (std::isnan(loglikelihood)) return 0;
+            if (!_sorted) {
+                std::sort(_maxima.begin(), _maxima.end());
+                _sorted = true;
+            }
+            return static_cast<unsigned int>(_maxima.end() - std::lower_bound(_maxima.begin(), _maxima.end(), loglikelihood));
+        }
+        size_t size() const {return _maxima.size();}
+};
 //*****************************************************************************
 #endif
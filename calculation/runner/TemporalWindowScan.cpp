@@ -0,0 +1,41 @@
+//******************************************************************************
+#include "TreeScan.h"
+#pragma hdrstop
+//******************************************************************************
+#include "TemporalWindowScan.h"
+#include <limits>
+
+/** Enumerates the windows with end in 'endWindow' and start in 'startWindow', as restricted by 'window'. When 'exclusions' is specified,
+    excluded time intervals are subtracted from the window lengths. */
+TemporalWindowScan::TemporalWindowScan(const DataTimeRange& startWindow, const DataTimeRange& endWindow, AbstractWindowLength& window, const boost::dynamic_bitset<> * exclusions) {
+    // number of excluded time intervals before each time interval, so that a window's exclusions are the difference of two values
+    std::vector<size_t> excluded(1, 0);
+    if (exclusions) {
+        excluded.reserve(exclusions->size() + 1);
+        for (size_t t=0; t < exclusions->size(); ++t)
+            excluded.push_back(excluded.back() + (exclusions->test(t) ? 1 : 0));
+    }
+    auto excludedBefore = [&excluded](int t) { return excluded[std::min(static_cast<size_t>(t), excluded.size() - 1)]; };
+
+    int iWindowStart, iMinWindowStart, iMaxEndWindow = std::min(endWindow.getEnd(), startWindow.getEnd() + window.maximum());
+    for (int iWindowEnd=endWindow.getStart(); iWindowEnd <= iMaxEndWindow; ++iWindowEnd) {
+        window.windowstart(startWindow, iWindowEnd, iMinWindowStart, iWindowStart);
+        for (; iWindowStart >= iMinWindowStart; --iWindowStart) {
+            _starts.push_back(iWindowStart);
+            _ends.push_back(iWindowEnd);
+            _lengths.push_back(static_cast<size_t>(iWindowEnd - iWindowStart + 1) - (excludedBefore(iWindowEnd + 1) - excludedBefore(iWindowStart)));
+        }
+    }
+}
+
+/** Returns the maximum log likelihood of the windows with at least 'minimum_cases' cases, calculating the log likelihoods of all windows into
+    'loglikelihoods'. Returns -std::numeric_limits<double>::max() if no window has the minimum cases. */
+double TemporalWindowScan::getMaximumLogLikelihood(const int * counts, double n, double minimum_cases, const AbstractLoglikelihood& calculator, double * loglikelihoods) const {
+    getLogLikelihoods(counts, n, calculator, loglikelihoods);
+    double maximum = -std::numeric_limits<double>::max();
+    for (size_t w=0, windows=_starts.size(); w < windows; ++w) {
+        if (counts[w] >= minimum_cases)
+            maximum = std::max(maximum, loglikelihoods[w]);
+    }
+    return maximum;
+}
@@ -0,0 +1,40 @@
+//******************************************************************************
+#ifndef __TemporalWindowScan_H
+#define __TemporalWindowScan_H
+//******************************************************************************
+#include "WindowLength.h"
+#include "Loglikelihood.h"
+#include <boost/dynamic_bitset.hpp>
+#include <vector>
+
+/** The windows evaluated by the temporal scans conditioned on the node, enumerated once per run in scanning order -- window end ascending,
+    then window start descending -- together with their lengths less any excluded time intervals. The windows of a cumulative series of
+    cases are then counted and evaluated as flat arrays, without calling the window length or exclusion logic for each window. */
+class TemporalWindowScan {
+    private:
+        std::vector<int> _starts;
+        std::vector<int> _ends;
+        std::vector<size_t> _lengths;
+
+    public:
+        TemporalWindowScan(const DataTimeRange& startWindow, const DataTimeRange& endWindow, AbstractWindowLength& window, const boost::dynamic_bitset<> * exclusions=0);
+
+        size_t          size() const { return _starts.size(); }
+        int             getStart(size_t w) const { return _starts[w]; }
+        int             getEnd(size_t w) const { return _ends[w]; }
+        size_t          getLength(size_t w) const { return _lengths[w]; }
+
+        /* Counts the cases in each window from the cumulative series -- cumulative[t] being the cases in time interval t and after. */
+        void getCounts(const int * cumulative, int * counts) const {
+            const int * starts = _starts.data(), * ends = _ends.data();
+            for (size_t w=0, windows=_starts.size(); w < windows; ++w)
+                counts[w] = cumulative[starts[w]] - cumulative[ends[w] + 1];
+        }
+        /* Calculates the log likelihood of each window, given the cases in window and the total cases n of the series. */
+        void getLogLikelihoods(const int * counts, double n, const AbstractLoglikelihood& calculator, double * loglikelihoods) const {
+            calculator.WindowLogLikelihoods(counts, n, _lengths.data(), _lengths.size(), loglikelihoods);
+        }
+        double getMaximumLogLikelihood(const int * counts, double n, double minimum_cases, const AbstractLoglikelihood& calculator, double * loglikelihoods) const;
+};
+//******************************************************************************
+#endif
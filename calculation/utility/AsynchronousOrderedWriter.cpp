@@ -0,0 +1,116 @@
+//******************************************************************************
+#include "TreeScan.h"
+#pragma hdrstop
+//******************************************************************************
+#include "AsynchronousOrderedWriter.h"
+#include "PrjException.h"
+#include <charconv>
+#include <cstdio>
+
+/** Opens file 'filename' with 'mode', writing records starting at sequence number 'first'. At most 'capacity' records are queued. */
+AsynchronousOrderedWriter::AsynchronousOrderedWriter(const std::string& filename, std::ios::openmode mode, sequence_t first, size_t capacity)
+    : _stream(_file), _name(filename), _capacity(capacity), _next(first), _closing(false), _failed(false) {
+    _file.open(filename.c_str(), mode);
+    if (!_file) throw resolvable_error("Error: Could not open the file '%s' for writing.\n", filename.c_str());
+    _thread = boost::thread(&AsynchronousOrderedWriter::run, this);
+}
+
+/** Writes to the caller's 'stream', which must outlive this object; 'name' identifies the stream in error messages. */
+AsynchronousOrderedWriter::AsynchronousOrderedWriter(std::ostream& stream, const std::string& name, sequence_t first, size_t capacity)
+    : _stream(stream), _name(name), _capacity(capacity), _next(first), _closing(false), _failed(false) {
+    _thread = boost::thread(&AsynchronousOrderedWriter::run, this);
+}
+
+AsynchronousOrderedWriter::~AsynchronousOrderedWriter() {
+    try {
+        close();
+    } catch (...) {}
+}
+
+/** Writer thread: takes all queued records at once, writing each record once every record before it has been written. */
+void AsynchronousOrderedWriter::run() {
+    std::deque<Record_t> records;
+    while (true) {
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            while (_queue.empty() && !_closing) _queue_not_empty.wait(lock);
+            if (_queue.empty()) break; // closing, with nothing left to write
+            records.swap(_queue);
+        }
+        _queue_not_full.notify_all();
+        for (auto& record : records) {
+            if (record.first != _next) {
+                _reorder.emplace(record.first, std::move(record.second));
+                continue;
+            }
+            writeRecord(record.second);
+            ++_next;
+            auto itr = _reorder.begin();
+            for (; itr != _reorder.end() && itr->first == _next; itr = _reorder.erase(itr), ++_next)
+                writeRecord(itr->second);
+        }
+        records.clear();
+    }
+    // Records still waiting on an earlier record, which will not arrive (e.g. simulations were cancelled), are written in sequence.
+    for (auto& record : _reorder)
+        writeRecord(record.second);
+    _reorder.clear();
+    _stream.flush();
+}
+
+void AsynchronousOrderedWriter::writeRecord(const std::string& record) {
+    if (_failed) return;
+    _stream.write(record.data(), static_cast<std::streamsize>(record.size()));
+    if (!_stream) {
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            _failed = true;
+        }
+        _queue_not_full.notify_all();
+    }
+}
+
+void AsynchronousOrderedWriter::throwError() const {
+    throw resolvable_error("Error: Could not write to the file '%s'.\n", _name.c_str());
+}
+
+/** Queues 'record' as record number 'sequence'. Throws if an earlier write to the stream failed. */
+void AsynchronousOrderedWriter::write(sequence_t sequence, std::string&& record) {
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        while (_queue.size() >= _capacity && !_failed) _queue_not_full.wait(lock);
+        if (_failed) throwError();
+        if (_closing) throw prg_error("Record %u written to '%s' after it was closed.", "AsynchronousOrderedWriter::write()", sequence, _name.c_str());
+        _queue.emplace_back(sequence, std::move(record));
+    }
+    _queue_not_empty.notify_one();
+}
+
+/** Writes all queued records and stops the writer thread, closing the file if opened by this object. Throws if a write failed. */
+void AsynchronousOrderedWriter::close() {
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        _closing = true;
+    }
+    _queue_not_empty.notify_one();
+    if (_thread.joinable()) _thread.join();
+    if (_file.is_open()) {
+        _file.close();
+        if (_file.fail()) _failed = true;
+    }
+    if (_failed) throwError();
+}
+
+/** Appends integer 'value' to 's'. */
+std::string & AsynchronousOrderedWriter::append(std::string& s, int value) {
+    char buffer[16];
+    std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    return s.append(buffer, result.ptr);
+}
+
+/** Appends real 'value' to 's', formatted as a default std::ostream would. */
+std::string & AsynchronousOrderedWriter::append(std::string& s, double value) {
+    char buffer[32];
+    int length = std::snprintf(buffer, sizeof(buffer), "%g", value);
+    return s.append(buffer, static_cast<size_t>(length));
+}
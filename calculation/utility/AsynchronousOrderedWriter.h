@@ -0,0 +1,55 @@
+//******************************************************************************
+#ifndef __AsynchronousOrderedWriter_H
+#define __AsynchronousOrderedWriter_H
+//******************************************************************************
+#include "boost/thread/thread.hpp"
+#include "boost/thread/mutex.hpp"
+#include "boost/thread/condition_variable.hpp"
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+
+/** Writes records to a stream on a dedicated thread, in the order of their sequence numbers regardless of the order threads submit them.
+    Submitting a record only queues it -- a thread waits on the writer only when the bounded queue is full, never on the stream itself.
+    The writer thread moves queued records into a reorder buffer keyed by sequence number, writing them out once all earlier records
+    have arrived. Records are formatted into strings by the submitting thread, using the append functions here instead of iostreams. */
+class AsynchronousOrderedWriter {
+    public:
+        typedef unsigned int sequence_t;
+
+    private:
+        typedef std::pair<sequence_t, std::string> Record_t;
+
+        std::ofstream                       _file;          // file opened by writer, if not writing to caller's stream
+        std::ostream                      & _stream;
+        const std::string                   _name;
+        const size_t                        _capacity;
+        std::deque<Record_t>                _queue;
+        std::map<sequence_t, std::string>   _reorder;       // records waiting on an earlier record -- accessed by writer thread only
+        sequence_t                          _next;          // sequence number of the next record to write
+        bool                                _closing;
+        bool                                _failed;
+        boost::mutex                        _mutex;
+        boost::condition_variable           _queue_not_empty;
+        boost::condition_variable           _queue_not_full;
+        boost::thread                       _thread;
+
+        void run();
+        void writeRecord(const std::string& record);
+        void throwError() const;
+
+    public:
+        AsynchronousOrderedWriter(const std::string& filename, std::ios::openmode mode, sequence_t first=1, size_t capacity=1024);
+        AsynchronousOrderedWriter(std::ostream& stream, const std::string& name, sequence_t first=1, size_t capacity=1024);
+        ~AsynchronousOrderedWriter();
+
+        void write(sequence_t sequence, std::string&& record);
+        void close();
+
+        static std::string & append(std::string& s, int value);
+        static std::string & append(std::string& s, double value);
+};
+//******************************************************************************
+#endif
@@ -288,14 +288,8 @@ void MCSimJobSource::RegisterResult_NoAutoAbort(job_id_type const & rJobID, para
     // update ratios, significance, etc.
     double llr_result = grLoglikelihood->LogLikelihoodRatio(rResult.dSuccessfulResult.first);
 
-    if (!_isPowerStep && !grRunner.getParameters().isSequentialScanTreeOnly()) {
-        ScanRunner::CutStructureContainer_t::const_iterator itr=grRunner.getCuts().begin(), itrEnd=grRunner.getCuts().end();
-        for (; itr != itrEnd; ++itr) {
-            if (rResult.dSuccessfulResult.first >= (*itr)->getLogLikelihood()) {
-                (*itr)->incrementRank();
-            }
-        }
-    }
+    if (!_isPowerStep && !grRunner.getParameters().isSequentialScanTreeOnly())
+        _rank_accumulator.add(rResult.dSuccessfulResult.first);
 
     if (_ratio_writer.get()) _ratio_writer->write(llr_result, rParam);
     if (!_isPowerStep) grRunner.updateCriticalValuesList(llr_result);
@@ -322,6 +316,15 @@ void MCSimJobSource::RegisterResult_NoAutoAbort(job_id_type const & rJobID, para
 }
 
 
+/** Increments the rank of each cut by the number of registered simulations whose maximum log likelihood is at least the cut's. Called
+    once the simulations complete. */
+void MCSimJobSource::ResolveCutRanks()
+{
+  ScanRunner::CutStructureContainer_t::const_iterator itr=grRunner.getCuts().begin(), itrEnd=grRunner.getCuts().end();
+  for (; itr != itrEnd && _rank_accumulator.size(); ++itr)
+    (*itr)->incrementRank(_rank_accumulator.countAtLeast((*itr)->getLogLikelihood()));
+}
+
 /** When we're through checking for auto-abort, we want to release any resources
     used.  (This is mostly for cancel and exception conditions that occur while
     auto-abort checking is active.) */
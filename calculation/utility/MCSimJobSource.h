@@ -53,6 +53,7 @@ private: // data members
   ScanRunner                              & grRunner;
   Loglikelihood_t               grLoglikelihood;
   bool                                      _isPowerStep;
+  RankAccumulator                           _rank_accumulator; // simulated maxima ranking the cuts, resolved by ResolveCutRanks()
 
 private: // functions
   void                      RegisterResult_NoAutoAbort(job_id_type const & rJobId, param_type const & rParam, result_type const & rResult);
@@ -81,6 +82,7 @@ public:
   unsigned int              GetExceptionCount() const;
   exception_sequence_type   GetExceptions() const;
   void                      Assert_NoExceptionsCaught() const;
+  void                      ResolveCutRanks();
 };
 //******************************************************************************
 #endif
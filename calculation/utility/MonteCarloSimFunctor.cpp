@@ -6,6 +6,7 @@
 #include "PrjException.h"
 #include "WindowLength.h"
 #include "DataSource.h"
+#include "SignedRankRandomizer.h"
 
 AbstractMeasureList::AbstractMeasureList(const ScanRunner & scanRunner, Loglikelihood_t loglikelihood) :
     _scanRunner(scanRunner), _loglikelihood(loglikelihood) {}
@@ -27,15 +28,65 @@ MCSimSuccessiveFunctor::MCSimSuccessiveFunctor(
     // This will need refactoring if we ever implement multiple data time ranges.
     const Parameters& parameters = _scanRunner.getParameters();
     size_t daysInDataTimeRange = Parameters::isTemporalScanType(parameters.getScanType()) ?parameters.getDataTimeRangeSet().getTotalDaysAcrossRangeSets() + 1 : 1;
-    for (auto node: _scanRunner.getNodes())
-        _treeSimNodes.push_back(SimulationNode(daysInDataTimeRange, node->getLevel(), static_cast<unsigned int>(_scanRunner.getSampleSiteIdentifiers().size())));
-    //_treeSimNodes.resize(_scanRunner.getNodes().size(), SimulationNode(daysInDataTimeRange));
+    bool conditionNodeTime = (parameters.getScanType() == Parameters::TREETIME && parameters.getConditionalType() == Parameters::NODEANDTIME) ||
+                             (parameters.getScanType() == Parameters::TIMEONLY && parameters.isPerformingDayOfWeekAdjustment()) ||
+                             (parameters.getScanType() == Parameters::TREETIME && parameters.getConditionalType() == Parameters::NODE && parameters.isPerformingDayOfWeekAdjustment());
+    // Replicas scanned through scanTreeTemporalConditionNode() read windows with getBrC_Window(), so nodes with fewer branch cases than
+    // a sixteenth of the time intervals can be held as sparse case times rather than taking the full length of the data time range.
+    NodeStructure::count_t sparse_limit = 0;
+    if (!conditionNodeTime && parameters.getModelType() == Parameters::UNIFORM && !_scanRunner.isCensoredData() && _randomizer->supportsSparseNodes())
+        sparse_limit = static_cast<NodeStructure::count_t>(daysInDataTimeRange / 16);
+    _treeSimNodes = SimNodeContainer_t(_scanRunner.getNodes(), daysInDataTimeRange, static_cast<unsigned int>(_scanRunner.getSampleSiteIdentifiers().size()), SimNodeContainer_t::NODE_MAJOR, sparse_limit);
+    if (!conditionNodeTime && parameters.getModelType() == Parameters::UNIFORM && !_scanRunner.isCensoredData()) {
+        _window_scan.reset(new TemporalWindowScan(_scanRunner.getTemporalWindowScan()));
+        _window_counts.resize(_window_scan->size());
+        _window_loglikelihoods.resize(_window_scan->size());
+        _branch_series.resize(daysInDataTimeRange);
+    }
     _loglikelihood.reset(AbstractLoglikelihood::getNewLoglikelihood(_scanRunner));
+    _signed_rank_randomizer = dynamic_cast<SignedRankRandomizer*>(_randomizer.get());
+    if (parameters.getModelType() == Parameters::SIGNED_RANK) {
+        _cut_differences.resize(_treeSimNodes.getSampleSites());
+        // Replicas of the signed rank randomizer only flip the signs of sample sites, so unless reading simulated data, the cuts are ranked
+        // once from the differences of a replica without flips.
+        if (_signed_rank_randomizer && !_signed_rank_randomizer->isReading()) {
+            std::shared_ptr<SignedRankCutScan> cuts(new SignedRankCutScan(_treeSimNodes.getSampleSites()));
+            _signed_rank_randomizer->getObservedDifferences(_scanRunner.getNodes(), _treeSimNodes);
+            scanSignedRankCuts([&cuts](const double * differences) { cuts->add(differences); });
+            _signed_rank_cuts = cuts;
+            _sample_site_flips.resize(cuts->getNumWords());
+        }
+    }
 
-    if ((parameters.getScanType() == Parameters::TREETIME && parameters.getConditionalType() == Parameters::NODEANDTIME) ||
-        (parameters.getScanType() == Parameters::TIMEONLY && parameters.isPerformingDayOfWeekAdjustment()) ||
-        (parameters.getScanType() == Parameters::TREETIME && parameters.getConditionalType() == Parameters::NODE && parameters.isPerformingDayOfWeekAdjustment()))
+    if (conditionNodeTime)
         _measure_list.reset(AbstractMeasureList::getNewMeasureList(_scanRunner, _loglikelihood));
+    // Replicas which are scanned through scanTree() can be randomized and scanned a block at a time.
+    _scan_tree_blocks = !conditionNodeTime && parameters.getModelType() != Parameters::UNIFORM &&
+                        parameters.getModelType() != Parameters::BERNOULLI_TIME && parameters.getModelType() != Parameters::SIGNED_RANK;
+}
+
+/* Records the exception currently being handled in result. */
+static void setExceptionResult(MCSimSuccessiveFunctor::result_type& result) {
+    try {
+        throw;
+    } catch (memory_exception & e) {
+        result.eException_type = MCSimJobSource::result_type::memory;
+        result.Exception = prg_exception(e.what(), "MCSimSuccessiveFunctor");
+    } catch (resolvable_error & e) {
+        result.eException_type = MCSimJobSource::result_type::resolvable;
+        result.Exception = prg_exception(e.what(), "MCSimSuccessiveFunctor");
+    } catch (prg_exception & e) {
+        result.eException_type = MCSimJobSource::result_type::prg;
+        result.Exception = e;
+    } catch (std::exception & e) {
+        result.eException_type = MCSimJobSource::result_type::std;
+        result.Exception = prg_exception(e.what(), "MCSimSuccessiveFunctor");
+    } catch (...) {
+        result.eException_type = MCSimJobSource::result_type::unknown;
+        result.Exception = prg_exception("(...) -- unknown error", "MCSimSuccessiveFunctor");
+    }
+    result.bUnExceptional = false;
+    result.Exception.addTrace("operator()", "MCSimSuccessiveFunctor");
 }
 
 MCSimSuccessiveFunctor::result_type MCSimSuccessiveFunctor::operator() (MCSimSuccessiveFunctor::param_type const & param) {
@@ -58,33 +109,34 @@ MCSimSuccessiveFunctor::result_type MCSimSuccessiveFunctor::operator() (MCSimSuc
         else
             temp_result.dSuccessfulResult = scanTree(param);
         temp_result.bUnExceptional = true;
-    } catch (memory_exception & e) {
-        temp_result.eException_type = MCSimJobSource::result_type::memory;
-        temp_result.Exception = prg_exception(e.what(), "MCSimSuccessiveFunctor");
-        temp_result.bUnExceptional = false;
-    } catch (resolvable_error & e) {
-        temp_result.eException_type = MCSimJobSource::result_type::resolvable;
-        temp_result.Exception = prg_exception(e.what(), "MCSimSuccessiveFunctor");
-        temp_result.bUnExceptional = false;
-    } catch (prg_exception & e) {
-        temp_result.eException_type = MCSimJobSource::result_type::prg;
-        temp_result.Exception = e;
-        temp_result.bUnExceptional = false;
-    } catch (std::exception & e) {
-        temp_result.eException_type = MCSimJobSource::result_type::std;
-        temp_result.Exception = prg_exception(e.what(), "MCSimSuccessiveFunctor");
-        temp_result.bUnExceptional = false;
     } catch (...) {
-        temp_result.eException_type = MCSimJobSource::result_type::unknown;
-        temp_result.Exception = prg_exception("(...) -- unknown error", "MCSimSuccessiveFunctor");
-        temp_result.bUnExceptional = false;
-    }
-    if (!temp_result.bUnExceptional) {
-        temp_result.Exception.addTrace("operator()", "MCSimSuccessiveFunctor");
+        setExceptionResult(temp_result);
     }
     return temp_result;
 }
 
+/* Runs replicas [first, last), appending their results. Replicas scanned by scanTree() are randomized and scanned as a block,
+   so that each node's data is read once per block rather than once per replica. */
+void MCSimSuccessiveFunctor::operator() (MCSimSuccessiveFunctor::param_type first, MCSimSuccessiveFunctor::param_type last, MCSimSuccessiveFunctor::block_result_type& results) {
+    if (!_scan_tree_blocks) {
+        for (param_type param=first; param < last; ++param)
+            results.push_back(std::make_pair(param, (*this)(param)));
+        return;
+    }
+    result_type temp_result;
+    try {
+        scanTree(first, last, _block_results);
+        temp_result.bUnExceptional = true;
+    } catch (...) {
+        setExceptionResult(temp_result); // the block fails as a whole
+    }
+    for (param_type param=first; param < last; ++param) {
+        if (temp_result.bUnExceptional)
+            temp_result.dSuccessfulResult = _block_results[param - first];
+        results.push_back(std::make_pair(param, temp_result));
+    }
+}
+
 /** Returns true if NodeStructure/SimulationNode is evaluated in scanning processing. */
 bool MCSimSuccessiveFunctor::isEvaluated(const NodeStructure& node, const SimulationNode& simNode) const {
     // If the node branch does not have the minimum number of cases in branch, it is not evaluated.
@@ -95,78 +147,101 @@ bool MCSimSuccessiveFunctor::isEvaluated(const NodeStructure& node, const Simula
     return node.isEvaluated();
 }
 
+/** Calculates the log likelihoods of a cut for the replicas of a block in one batch -- c holding the cut's cases per replica and n its expected --
+    then retains each as its replica's best where the replica evaluates the node and the cut has the minimum number of cases. */
+void MCSimSuccessiveFunctor::retainBlockLogLikelihoods(const NodeStructure::count_t * c, double n, std::vector<successful_result_type>& results, double minimum_cases) {
+    _loglikelihood->LogLikelihoods(c, &n, 0, results.size(), _block_loglikelihoods.data());
+    for (size_t r=0; r < results.size(); ++r)
+        if (_block_evaluated[r] && c[r] >= minimum_cases)
+            results[r].first = std::max(results[r].first, _block_loglikelihoods[r]);
+}
+
 /** This function randomizes data and scans tree for either the Poisson or Bernoulli model. */
 MCSimSuccessiveFunctor::successful_result_type MCSimSuccessiveFunctor::scanTree(MCSimSuccessiveFunctor::param_type const & param) {
+    scanTree(param, param + 1, _block_results);
+    return _block_results.front();
+}
+
+/** This function randomizes data for replicas [first, last) and scans tree for all of them in one pass -- either the Poisson or Bernoulli model.
+    The branch counts of the replicas are gathered into a node by replica matrix, so the node data and cut structure are read once per block. */
+void MCSimSuccessiveFunctor::scanTree(MCSimSuccessiveFunctor::param_type first, MCSimSuccessiveFunctor::param_type last, std::vector<successful_result_type>& results) {
+    const ScanRunner::NodeStructureContainer_t& nodes = _scanRunner.getNodes();
+    const size_t numReplicas = last - first;
+    results.assign(numReplicas, std::make_pair(-std::numeric_limits<double>::max(), 0));
+    _block_branch_counts.resize(nodes.size() * numReplicas);
+    _block_evaluated.resize(numReplicas);
+    _block_sums.resize(numReplicas);
+    _block_loglikelihoods.resize(numReplicas);
+
     // randomize data
-    int TotalSimC = _randomizer.get()->RandomizeData(param, _scanRunner.getNodes(), _mutex, _treeSimNodes);
+    for (size_t r=0; r < numReplicas; ++r) {
+        results[r].second = _randomizer.get()->RandomizeData(first + static_cast<param_type>(r), nodes, _mutex, _treeSimNodes);
+        for (size_t n=0; n < nodes.size(); ++n)
+            _block_branch_counts[n * numReplicas + r] = _treeSimNodes[n].getBrC();
+    }
 
     //--------------------- SCANNING THE TREE, SIMULATIONS -------------------------
-    const ScanRunner::NodeStructureContainer_t& nodes = _scanRunner.getNodes();
-    int sumBranchC = 0, sumBranchC2 = 0;
-    double simLogLikelihood = -std::numeric_limits<double>::max(), minimum_cases = _scanRunner.getNodeEvaluationMinimum(), sumBranchN=0.0;
-    for (size_t n=0; n < nodes.size(); ++n) {
-        const NodeStructure& thisNode(*(nodes[n]));
-        if (isEvaluated(thisNode, _treeSimNodes[n])) {
-            // always do simple cut
-            simLogLikelihood = std::max(simLogLikelihood, _loglikelihood->LogLikelihood(_treeSimNodes[n].getBrC(), nodes[n]->getBrN()));
-            Parameters::CutType cutType = thisNode.getChildren().size() >= 2 ? thisNode.getCutType() : Parameters::SIMPLE;
-            switch (cutType) {
-                case Parameters::SIMPLE: break; // already done
-                case Parameters::ORDINAL:
-                    // Ordinal cuts: ABCD -> AB, ABC, ABCD, BC, BCD, CD
-                    for (size_t i=0; i < thisNode.getChildren().size() - 1; ++i) {
-                        const NodeStructure& firstChildNode(*(thisNode.getChildren()[i]));
-                        sumBranchC = _treeSimNodes[i].getBrC();
-                        sumBranchN = firstChildNode.getBrN();
-                        for (size_t j=i+1; j < thisNode.getChildren().size(); ++j) {
-                            const NodeStructure& childNode(*(thisNode.getChildren()[j]));
-                            sumBranchC += _treeSimNodes[static_cast<size_t>(childNode.getID())].getBrC();
-                            sumBranchN += childNode.getBrN();
-                            if (sumBranchC >= minimum_cases)
-                                simLogLikelihood = std::max(simLogLikelihood, _loglikelihood->LogLikelihood(sumBranchC, sumBranchN));
-                        }
-                    } break;
-                case Parameters::PAIRS:
-                    // Pair cuts: ABCD -> AB, AC, AD, BC, BD, CD
-                    for (size_t i=0; i < thisNode.getChildren().size() - 1; ++i) {
-                        const NodeStructure& startChildNode(*(thisNode.getChildren()[i]));
-                        for (size_t j=i+1; j < thisNode.getChildren().size(); ++j) {
-                            const NodeStructure& stopChildNode(*(thisNode.getChildren()[j]));
-                            sumBranchC = _treeSimNodes[static_cast<size_t>(startChildNode.getID())].getBrC() + _treeSimNodes[static_cast<size_t>(stopChildNode.getID())].getBrC();
-                            if (sumBranchC >= minimum_cases)
-                                simLogLikelihood = std::max(simLogLikelihood, _loglikelihood->LogLikelihood(sumBranchC, startChildNode.getBrN() + stopChildNode.getBrN()));
-                        }
-                    } break;
-                case Parameters::TRIPLETS:
-                    // Triple cuts: ABCD -> AB, AC, ABC, AD, ABD, ACD, BC, BD, BCD, CD
-                    for (size_t i=0; i < thisNode.getChildren().size() - 1; ++i) {
-                        const NodeStructure& startChildNode(*(thisNode.getChildren()[i]));
-                        for (size_t j=i+1; j < thisNode.getChildren().size(); ++j) {
-                            const NodeStructure& stopChildNode(*(thisNode.getChildren()[j]));
-                            sumBranchC = _treeSimNodes[static_cast<size_t>(startChildNode.getID())].getBrC() + _treeSimNodes[static_cast<size_t>(stopChildNode.getID())].getBrC();
-                            if (sumBranchC >= minimum_cases)
-                                simLogLikelihood = std::max(simLogLikelihood, _loglikelihood->LogLikelihood(sumBranchC, startChildNode.getBrN() + stopChildNode.getBrN()));
-                            for (size_t k=i+1; k < j; ++k) {
-                                const NodeStructure& middleChildNode(*(thisNode.getChildren()[k]));
-                                sumBranchC2 = sumBranchC + _treeSimNodes[static_cast<size_t>(middleChildNode.getID())].getBrC();
-                                if (sumBranchC2 >= minimum_cases)
-                                    simLogLikelihood = std::max(simLogLikelihood, _loglikelihood->LogLikelihood(sumBranchC2, startChildNode.getBrN() + middleChildNode.getBrN() + stopChildNode.getBrN()));
-                            }
-                        }
-                    } break;
-                case Parameters::COMBINATORIAL: default: throw prg_error("Unknown cut type (%d).", "scanTree()", cutType);
-            };
-         }
-    } // for i<nNodes
+    const CutPlan& plan(_scanRunner.getCutPlan());
+    const unsigned int minimum_branch_cases = _scanRunner.getNodeEvaluationMinimum();
+    const double minimum_cases = minimum_branch_cases;
+    auto replicaCounts = [this, numReplicas](unsigned int node) { return &_block_branch_counts[static_cast<size_t>(node) * numReplicas]; };
+    for (const CutPlan::Node& planNode : plan.getNodes()) {
+        // If the node branch does not have the minimum number of cases in branch, it is not evaluated for that replica.
+        const NodeStructure::count_t * branchC = replicaCounts(planNode._node);
+        bool anyEvaluated = false;
+        for (size_t r=0; r < numReplicas; ++r) {
+            _block_evaluated[r] = static_cast<unsigned int>(branchC[r]) >= minimum_branch_cases;
+            anyEvaluated |= _block_evaluated[r] != 0;
+        }
+        if (!anyEvaluated) continue;
+        // always do simple cut
+        retainBlockLogLikelihoods(branchC, plan.getCuts()[planNode._begin]._BrN, results, 0.0);
+        // then ordinal, pair or triplet cuts of children -- summing the cases of the cut's nodes, or adding them to the previous cut's
+        for (size_t c=planNode._begin + 1; c < planNode._end; ++c) {
+            const CutPlan::Cut& cut(plan.getCuts()[c]);
+            unsigned int i = 0;
+            if (!cut._extends) {
+                const NodeStructure::count_t * firstC = replicaCounts(cut._nodes[i++]);
+                std::copy_n(firstC, numReplicas, _block_sums.begin());
+            }
+            for (; i < cut._size; ++i) {
+                const NodeStructure::count_t * nodeC = replicaCounts(cut._nodes[i]);
+                for (size_t r=0; r < numReplicas; ++r)
+                    _block_sums[r] += nodeC[r];
+            }
+            retainBlockLogLikelihoods(_block_sums.data(), cut._BrN, results, minimum_cases);
+        }
+    }
+}
 
-    return std::make_pair(simLogLikelihood,TotalSimC);
+/** Calls 'evaluate' with the sample site differences of each cut evaluated by the signed rank simulations -- the branch of each evaluated
+    node, then the ordinal, pair or triplet cuts of its children. The differences of cuts are summed in place into the functor's buffer. */
+template <typename Evaluate>
+void MCSimSuccessiveFunctor::scanSignedRankCuts(Evaluate evaluate) {
+    const CutPlan& plan(_scanRunner.getCutPlan());
+    double * accumulation = _cut_differences.data();
+    for (const CutPlan::Node& planNode : plan.getNodes()) {
+        // always do simple cut
+        evaluate(_treeSimNodes[planNode._node].getSampleSiteDifferencesBr().data());
+        // then ordinal, pair or triplet cuts of children
+        for (size_t c=planNode._begin + 1; c < planNode._end; ++c) {
+            const CutPlan::Cut& cut(plan.getCuts()[c]);
+            unsigned int i = 0;
+            if (!cut._extends) {
+                SimulationNode::ConstDifferences_t firstDiffBr = _treeSimNodes[cut._nodes[i++]].getSampleSiteDifferencesBr();
+                std::copy(firstDiffBr.begin(), firstDiffBr.end(), accumulation);
+            }
+            for (; i < cut._size; ++i) {
+                SimulationNode::ConstDifferences_t nodeDiffBr = _treeSimNodes[cut._nodes[i]].getSampleSiteDifferencesBr();
+                std::transform(nodeDiffBr.begin(), nodeDiffBr.end(), accumulation, accumulation, std::plus<double>());
+            }
+            evaluate(accumulation);
+        }
+    }
 }
 
 /** This function randomizes data and scans tree for either the signed rank model. */
 MCSimSuccessiveFunctor::successful_result_type MCSimSuccessiveFunctor::scanTreeSignedRank(MCSimSuccessiveFunctor::param_type const& param) {
-    // randomize data
-    int TotalSimC = _randomizer.get()->RandomizeData(param, _scanRunner.getNodes(), _mutex, _treeSimNodes);
-
     //--------------------- SCANNING THE TREE, SIMULATIONS -------------------------
     auto retainBest=[this](double& currentBest, double candidate) {
         switch (_scanRunner.getParameters().getScanRateType()) {
@@ -176,72 +251,21 @@ MCSimSuccessiveFunctor::successful_result_type MCSimSuccessiveFunctor::scanTreeS
             default: return std::max(currentBest, candidate);
         }
     };
-    const ScanRunner::NodeStructureContainer_t& nodes = _scanRunner.getNodes();
     double simLogLikelihood = _scanRunner.getParameters().getScanRateType() == Parameters::LOWRATE ? std::numeric_limits<double>::max() : 0;
-    for (size_t n = 0; n < nodes.size(); ++n) {
-        const NodeStructure& thisNode(*(nodes[n]));
-        if (isEvaluated(thisNode, _treeSimNodes[n])) {
-            // always do simple cut
-            simLogLikelihood = retainBest(simLogLikelihood,
-                _loglikelihood->LogLikelihoodRatio(SampleSiteVectorDifferenceProxy(_treeSimNodes[n].getSampleSiteDifferencesBr()))
-            );
-            Parameters::CutType cutType = thisNode.getChildren().size() >= 2 ? thisNode.getCutType() : Parameters::SIMPLE;
-            switch (cutType) {
-            case Parameters::SIMPLE: break; // already done
-            case Parameters::ORDINAL: {// Ordinal cuts: ABCD -> AB, ABC, ABCD, BC, BCD, CD
-                for (size_t i = 0; i < thisNode.getChildren().size() - 1; ++i) {
-                    SimulationNode::SampleSiteDiff_t accumulation = _treeSimNodes[i].getSampleSiteDifferencesBr();
-                    for (size_t j = i + 1; j < thisNode.getChildren().size(); ++j) {
-                        const NodeStructure& childNode(*(thisNode.getChildren()[j]));
-                        const auto& childNodeDiffBr = _treeSimNodes[static_cast<size_t>(childNode.getID())].getSampleSiteDifferencesBr();
-                        std::transform(childNodeDiffBr.begin(), childNodeDiffBr.end(), accumulation.begin(), accumulation.begin(), std::plus<double>());
-                        simLogLikelihood = retainBest(simLogLikelihood,
-                            _loglikelihood->LogLikelihoodRatio(SampleSiteVectorDifferenceProxy(accumulation))
-                        );
-                    }
-                }
-            } break;
-            case Parameters::PAIRS: {// Pair cuts: ABCD -> AB, AC, AD, BC, BD, CD
-                for (size_t i = 0; i < thisNode.getChildren().size() - 1; ++i) {
-                    const NodeStructure& startChildNode(*(thisNode.getChildren()[i]));
-                    for (size_t j = i + 1; j < thisNode.getChildren().size(); ++j) {
-                        SimulationNode::SampleSiteDiff_t accumulation = _treeSimNodes[static_cast<size_t>(startChildNode.getID())].getSampleSiteDifferencesBr();
-                        const NodeStructure& stopChildNode(*(thisNode.getChildren()[j]));
-                        const auto& childNodeDiffBr = _treeSimNodes[static_cast<size_t>(stopChildNode.getID())].getSampleSiteDifferencesBr();
-                        std::transform(childNodeDiffBr.begin(), childNodeDiffBr.end(), accumulation.begin(), accumulation.begin(), std::plus<double>());
-                        simLogLikelihood = retainBest(simLogLikelihood,
-                            _loglikelihood->LogLikelihoodRatio(SampleSiteVectorDifferenceProxy(accumulation))
-                        );
-                    }
-                }
-            } break;
-            case Parameters::TRIPLETS: {// Triple cuts: ABCD -> AB, AC, ABC, AD, ABD, ACD, BC, BD, BCD, CD
-                for (size_t i = 0; i < thisNode.getChildren().size() - 1; ++i) {
-                    const NodeStructure& startChildNode(*(thisNode.getChildren()[i]));
-                    for (size_t j = i + 1; j < thisNode.getChildren().size(); ++j) {
-                        SimulationNode::SampleSiteDiff_t accumulation = _treeSimNodes[static_cast<size_t>(startChildNode.getID())].getSampleSiteDifferencesBr();
-                        const NodeStructure& stopChildNode(*(thisNode.getChildren()[j]));
-                        const auto& childNodeDiffBr = _treeSimNodes[static_cast<size_t>(stopChildNode.getID())].getSampleSiteDifferencesBr();
-                        std::transform(childNodeDiffBr.begin(), childNodeDiffBr.end(), accumulation.begin(), accumulation.begin(), std::plus<double>());
-                        simLogLikelihood = retainBest(simLogLikelihood,
-                            _loglikelihood->LogLikelihoodRatio(SampleSiteVectorDifferenceProxy(accumulation))
-                        );
-                        for (size_t k = i + 1; k < j; ++k) {
-                            SimulationNode::SampleSiteDiff_t accumulationStartStop = accumulation;
-                            const NodeStructure& middleChildNode(*(thisNode.getChildren()[k]));
-                            const auto& middleChildNodeDiffBr = _treeSimNodes[static_cast<size_t>(middleChildNode.getID())].getSampleSiteDifferencesBr();
-                            std::transform(middleChildNodeDiffBr.begin(), middleChildNodeDiffBr.end(), accumulationStartStop.begin(), accumulationStartStop.begin(), std::plus<double>());
-                            simLogLikelihood = retainBest(simLogLikelihood,
-                                _loglikelihood->LogLikelihoodRatio(SampleSiteVectorDifferenceProxy(accumulationStartStop))
-                            );
-                        }
-                    }
-                }
-            } break;
-            case Parameters::COMBINATORIAL: default: throw prg_error("Unknown cut type (%d).", "scanTree()", cutType);
-            };
-        }
-    } // for i<nNodes
+    if (_signed_rank_cuts) {
+        // Randomize the sample site flips only, evaluating them against the ranks of each cut.
+        _signed_rank_cuts->getFlips(_signed_rank_randomizer->RandomizeSampleSiteFlips(param, _scanRunner.getNodes(), _treeSimNodes), _sample_site_flips.data());
+        for (size_t c=0; c < _signed_rank_cuts->size(); ++c)
+            simLogLikelihood = retainBest(simLogLikelihood, _signed_rank_cuts->getLogLikelihoodRatio(c, _sample_site_flips.data()));
+        return std::make_pair(std::abs(simLogLikelihood), 0);
+    }
+    // randomize data
+    int TotalSimC = _randomizer.get()->RandomizeData(param, _scanRunner.getNodes(), _mutex, _treeSimNodes);
+    const SignedRankLoglikelihood& loglikelihood(static_cast<const SignedRankLoglikelihood&>(*_loglikelihood));
+    size_t sample_sites = _treeSimNodes.getSampleSites();
+    scanSignedRankCuts([&](const double * differences) {
+        simLogLikelihood = retainBest(simLogLikelihood, loglikelihood.LogLikelihoodRatio(differences, sample_sites));
+    });
     return std::make_pair(std::abs(simLogLikelihood), TotalSimC);
 }
 
@@ -251,126 +275,78 @@ MCSimSuccessiveFunctor::successful_result_type MCSimSuccessiveFunctor::scanTreeT
     int TotalSimC = _randomizer.get()->RandomizeData(param, _scanRunner.getNodes(), _mutex, _treeSimNodes);
 
     //--------------------- SCANNING THE TREE, SIMULATIONS -------------------------
-    DataTimeRange::index_t idxAdditive = _scanRunner.getZeroTranslationAdditive();
-    // Define the start and end windows with the zero index offset already incorporated.
-    DataTimeRange startWindow(_scanRunner.temporalStartRange().getStart() + idxAdditive, _scanRunner.temporalStartRange().getEnd() + idxAdditive),
-                  endWindow(_scanRunner.temporalEndRange().getStart() + idxAdditive, _scanRunner.temporalEndRange().getEnd() + idxAdditive);
-    // Define the minimum and maximum window lengths.
-    std::shared_ptr<AbstractWindowLength> window(_scanRunner.getNewWindowLength());
-    int  iWindowStart, iMinWindowStart, iWindowEnd, iMaxEndWindow;
-
-    auto getWindowLength = [this](int iWindowStart, int iWindowEnd){
-        if (_scanRunner.getParameters().isApplyingExclusionTimeRanges()) {
-            return static_cast<size_t>(iWindowEnd - iWindowStart + 1 - _scanRunner.getNumExclusionsInWindow(iWindowStart, iWindowEnd));
-        } else
-            return static_cast<size_t>(iWindowEnd - iWindowStart + 1);
-    };
+    // The windows of each cut are evaluated as a whole from the cut's cumulative branch series -- for cuts of several children,
+    // the sum of the children's series.
+    const TemporalWindowScan& windows(*_window_scan);
     const ScanRunner::NodeStructureContainer_t& nodes = _scanRunner.getNodes();
-    int branchSum = 0, branchSum2 = 0;
+    size_t intervals = _treeSimNodes.getIntervals();
     double simLogLikelihood = -std::numeric_limits<double>::max(), minimum_cases = _scanRunner.getNodeEvaluationMinimum();
+    auto scanSeries = [&](const NodeStructure::count_t * series, NodeStructure::expected_t branchSum) {
+        windows.getCounts(series, _window_counts.data());
+        simLogLikelihood = std::max(simLogLikelihood, windows.getMaximumLogLikelihood(_window_counts.data(), branchSum, minimum_cases, *_loglikelihood, _window_loglikelihoods.data()));
+    };
+    auto addSeries = [intervals](const NodeStructure::count_t * first, const NodeStructure::count_t * second, NodeStructure::count_t * sum) {
+        for (size_t t=0; t < intervals; ++t) sum[t] = first[t] + second[t];
+    };
     for (size_t n=0; n < nodes.size(); ++n) {
         const NodeStructure& thisNode(*(nodes[n]));
         const SimulationNode& thisSimNode(_treeSimNodes[n]);
         if (isEvaluated(thisNode, thisSimNode)) {
             // always do simple cut
-            iMaxEndWindow = std::min(endWindow.getEnd(), startWindow.getEnd() + window->maximum());
-            for (iWindowEnd=endWindow.getStart(); iWindowEnd <= iMaxEndWindow; ++iWindowEnd) {
-                window->windowstart(startWindow, iWindowEnd, iMinWindowStart, iWindowStart);
-                for (; iWindowStart >= iMinWindowStart; --iWindowStart) {
-                    NodeStructure::count_t branchWindow = thisSimNode.getBrC_C()[iWindowStart] - thisSimNode.getBrC_C()[iWindowEnd + 1];
-                    if (branchWindow >= minimum_cases)
-                        simLogLikelihood = std::max(simLogLikelihood,
-                            _loglikelihood->LogLikelihood(branchWindow, static_cast<NodeStructure::expected_t>(thisSimNode.getBrC()), getWindowLength(iWindowStart, iWindowEnd))
-                        );
-                }
-            }
+            NodeStructure::count_t * row = _branch_series.data();
+            thisSimNode.copyBrC_C(row);
+            scanSeries(row, static_cast<NodeStructure::expected_t>(thisSimNode.getBrC()));
 
             Parameters::CutType cutType = thisNode.getChildren().size() >= 2 ? thisNode.getCutType() : Parameters::SIMPLE;
+            if (cutType == Parameters::SIMPLE) continue; // already done
+            // rows of the branch series buffer: combined series of the cut, then one series for each child
+            const NodeStructure::ChildContainer_t& children(thisNode.getChildren());
+            if (_branch_series.size() < (children.size() + 2) * intervals)
+                _branch_series.resize((children.size() + 2) * intervals);
+            NodeStructure::count_t * combined = _branch_series.data(), * combined2 = combined + intervals, * childSeries = combined2 + intervals;
+            for (size_t c=0; c < children.size(); ++c)
+                _treeSimNodes[children[c]->getID()].copyBrC_C(childSeries + c * intervals);
+            auto childSum = [&](size_t c) { return static_cast<NodeStructure::expected_t>(_treeSimNodes[children[c]->getID()].getBrC()); };
             switch (cutType) {
-                case Parameters::SIMPLE: break; // already done
                 case Parameters::ORDINAL:
                     // Ordinal cuts: ABCD -> AB, ABC, ABCD, BC, BCD, CD
-                    iMaxEndWindow = std::min(endWindow.getEnd(), startWindow.getEnd() + window->maximum());
-                    for (iWindowEnd=endWindow.getStart(); iWindowEnd <= iMaxEndWindow; ++iWindowEnd) {
-                        window->windowstart(startWindow, iWindowEnd, iMinWindowStart, iWindowStart);
-                        for (; iWindowStart >= iMinWindowStart; --iWindowStart) {
-                            for (size_t i=0; i < thisNode.getChildren().size() - 1; ++i) {
-                                const SimulationNode& firstSimChildNode(_treeSimNodes[thisNode.getChildren()[i]->getID()]);
-                                NodeStructure::count_t branchWindow = firstSimChildNode.getBrC_C()[iWindowStart] - firstSimChildNode.getBrC_C()[iWindowEnd + 1];
-                                NodeStructure::expected_t branchSum = static_cast<NodeStructure::expected_t>(firstSimChildNode.getBrC());
-                                for (size_t j=i+1; j < thisNode.getChildren().size(); ++j) {
-                                    const SimulationNode& childSimNode(_treeSimNodes[thisNode.getChildren()[j]->getID()]);
-                                    branchWindow += childSimNode.getBrC_C()[iWindowStart] - childSimNode.getBrC_C()[iWindowEnd + 1];
-                                    branchSum += static_cast<NodeStructure::expected_t>(childSimNode.getBrC());
-                                    if (branchWindow >= minimum_cases)
-                                        simLogLikelihood = std::max(simLogLikelihood,
-                                            _loglikelihood->LogLikelihood(branchWindow, branchSum, getWindowLength(iWindowStart, iWindowEnd))
-                                        );
-                                }
-                            }
+                    for (size_t i=0; i < children.size() - 1; ++i) {
+                        std::copy(childSeries + i * intervals, childSeries + (i + 1) * intervals, combined);
+                        NodeStructure::expected_t branchSum = childSum(i);
+                        for (size_t j=i+1; j < children.size(); ++j) {
+                            addSeries(combined, childSeries + j * intervals, combined);
+                            branchSum += childSum(j);
+                            scanSeries(combined, branchSum);
                         }
                     }
                     break;
                 case Parameters::PAIRS:
                     // Pair cuts: ABCD -> AB, AC, AD, BC, BD, CD
-                    iMaxEndWindow = std::min(endWindow.getEnd(), startWindow.getEnd() + window->maximum());
-                    for (iWindowEnd=endWindow.getStart(); iWindowEnd <= iMaxEndWindow; ++iWindowEnd) {
-                        window->windowstart(startWindow, iWindowEnd, iMinWindowStart, iWindowStart);
-                        for (; iWindowStart >= iMinWindowStart; --iWindowStart) {
-                            for (size_t i=0; i < thisNode.getChildren().size() - 1; ++i) {
-                                const SimulationNode& startSimChildNode(_treeSimNodes[thisNode.getChildren()[i]->getID()]);
-                                NodeStructure::count_t startBranchWindow = startSimChildNode.getBrC_C()[iWindowStart] - startSimChildNode.getBrC_C()[iWindowEnd + 1];
-                                NodeStructure::expected_t startBranchSum = static_cast<NodeStructure::expected_t>(startSimChildNode.getBrC());
-                                for (size_t j=i+1; j < thisNode.getChildren().size(); ++j) {
-                                    const SimulationNode& stopSimChildNode(_treeSimNodes[thisNode.getChildren()[j]->getID()]);
-                                    branchSum = startBranchWindow + (stopSimChildNode.getBrC_C()[iWindowStart] - stopSimChildNode.getBrC_C()[iWindowEnd + 1]);
-                                    if (branchSum >= minimum_cases)
-                                        simLogLikelihood = std::max(simLogLikelihood,
-                                            _loglikelihood->LogLikelihood(branchSum, startBranchSum + static_cast<NodeStructure::expected_t>(stopSimChildNode.getBrC()), getWindowLength(iWindowStart, iWindowEnd))
-                                        );
-                                }
-                            }
+                    for (size_t i=0; i < children.size() - 1; ++i) {
+                        for (size_t j=i+1; j < children.size(); ++j) {
+                            addSeries(childSeries + i * intervals, childSeries + j * intervals, combined);
+                            scanSeries(combined, childSum(i) + childSum(j));
                         }
                     }
                     break;
                 case Parameters::TRIPLETS:
                     // Triple cuts: ABCD -> AB, AC, ABC, AD, ABD, ACD, BC, BD, BCD, CD
-                    iMaxEndWindow = std::min(endWindow.getEnd(), startWindow.getEnd() + window->maximum());
-                    for (iWindowEnd=endWindow.getStart(); iWindowEnd <= iMaxEndWindow; ++iWindowEnd) {
-                        window->windowstart(startWindow, iWindowEnd, iMinWindowStart, iWindowStart);
-                        for (; iWindowStart >= iMinWindowStart; --iWindowStart) {
-                            for (size_t i=0; i < thisNode.getChildren().size() - 1; ++i) {
-                                const SimulationNode& startSimChildNode(_treeSimNodes[thisNode.getChildren()[i]->getID()]);
-                                NodeStructure::count_t startBranchWindow = startSimChildNode.getBrC_C()[iWindowStart] - startSimChildNode.getBrC_C()[iWindowEnd + 1];
-                                NodeStructure::expected_t startBranchSum = static_cast<NodeStructure::expected_t>(startSimChildNode.getBrC());
-                                for (size_t j=i+1; j < thisNode.getChildren().size(); ++j) {
-                                    const SimulationNode& stopSimChildNode(_treeSimNodes[thisNode.getChildren()[j]->getID()]);
-                                    branchSum = startBranchWindow + (stopSimChildNode.getBrC_C()[iWindowStart] - stopSimChildNode.getBrC_C()[iWindowEnd + 1]);
-                                    if (branchSum >= minimum_cases)
-                                        simLogLikelihood = std::max(simLogLikelihood,
-                                            _loglikelihood->LogLikelihood(branchSum, startBranchSum + static_cast<NodeStructure::expected_t>(stopSimChildNode.getBrC()), getWindowLength(iWindowStart, iWindowEnd))
-                                        );
-                                    for (size_t k=i+1; k < j; ++k) {
-                                        const SimulationNode& middleSimChildNode(_treeSimNodes[thisNode.getChildren()[k]->getID()]);
-                                        branchSum2 = branchSum + (middleSimChildNode.getBrC_C()[iWindowStart] - middleSimChildNode.getBrC_C()[iWindowEnd + 1]);
-                                        if (branchSum2 >= minimum_cases)
-                                            simLogLikelihood = std::max(simLogLikelihood,
-                                                _loglikelihood->LogLikelihood(branchSum2,
-                                                    startBranchSum + static_cast<NodeStructure::expected_t>(middleSimChildNode.getBrC()) + static_cast<NodeStructure::expected_t>(stopSimChildNode.getBrC()),
-                                                    getWindowLength(iWindowStart, iWindowEnd)
-                                                )
-                                            );
-                                    }
-                                }
+                    for (size_t i=0; i < children.size() - 1; ++i) {
+                        for (size_t j=i+1; j < children.size(); ++j) {
+                            addSeries(childSeries + i * intervals, childSeries + j * intervals, combined);
+                            scanSeries(combined, childSum(i) + childSum(j));
+                            for (size_t k=i+1; k < j; ++k) {
+                                addSeries(combined, childSeries + k * intervals, combined2);
+                                scanSeries(combined2, childSum(i) + childSum(k) + childSum(j));
                             }
                         }
                     }
                     break;
-                case Parameters::COMBINATORIAL: default: throw prg_error("Unknown cut type (%d).", "scanTree()", cutType);
+                case Parameters::COMBINATORIAL: default: throw prg_error("Unknown cut type (%d).", "scanTreeTemporalConditionNode()", cutType);
             };
-         }
+        }
     } // for i<nNodes
-    return std::make_pair(simLogLikelihood,TotalSimC);
+    return std::make_pair(simLogLikelihood, TotalSimC);
 }
 
 
@@ -643,10 +619,10 @@ MCSimSuccessiveFunctor::successful_result_type MCSimSuccessiveFunctor::scanTreeT
 
 /* Constructor */
 SequentialMCSimSuccessiveFunctor::SequentialMCSimSuccessiveFunctor(boost::mutex& mutex, const ScanRunner& scanner, std::shared_ptr<SequentialScanLoglikelihoodRatioWriter> writer) 
-    : _mutex(mutex), _scanRunner(scanner), _sequential_writer(writer) {
+    : _mutex(mutex), _scanRunner(scanner), _random_number_generator(RandomNumberGenerator::glDefaultSeed, AbstractRandomizer::getEngineType(scanner.getParameters())), _sequential_writer(writer) {
     // This will need refactoring if we ever implement multiple data time ranges.
     const Parameters& parameters = _scanRunner.getParameters();
-    _treeSimNode.reset(new SimulationNode(parameters.getDataTimeRangeSet().getTotalDaysAcrossRangeSets() + 1, 1, 0));
+    _treeSimNode.emplace_back(parameters.getDataTimeRangeSet().getTotalDaysAcrossRangeSets() + 1, 1, 0);
 
     // This will need refactoring if we ever implement multiple data time ranges.
     DataTimeRange min_max = parameters.getDataTimeRangeSet().getMinMax();
@@ -678,31 +654,32 @@ SequentialMCSimSuccessiveFunctor::result_type SequentialMCSimSuccessiveFunctor::
         _random_number_generator.SetSeedOffset(param);
 
         // clear data from last simulation
-        _treeSimNode->clear();
+        SimulationNode& simNode(_treeSimNode[0]);
+        _treeSimNode.reset();
 
         // First assign cases up to the minimum signal.
         for (unsigned int cases=0; cases < min_cases_to_signal - 1; ++cases) {
             DataTimeRange::index_t idx = static_cast<DataTimeRange::index_t>(Equilikely(static_cast<long>(_range.getStart()), static_cast<long>(_range.getEnd()), _random_number_generator));
-            ++(_treeSimNode->refBrC_C()[idx]);
+            ++(simNode.refBrC_C()[idx]);
             ++total_cases;
         }
-        _treeSimNode->setCumulative();
+        simNode.setCumulative();
         // Once at the minimum number of cases, start adding cases one at a time -- calculating log likelihood ratio and keeping maximum.
         for (unsigned int cases=min_cases_to_signal; cases <= total_sequential_cases; ++cases) {
             DataTimeRange::index_t idx = static_cast<DataTimeRange::index_t>(Equilikely(static_cast<long>(_range.getStart()), static_cast<long>(_range.getEnd()), _random_number_generator));
             // add new case to cumulative collection
             for (size_t w=idx; ; --w) {
-                ++(_treeSimNode->refBrC_C()[w]);
+                ++(simNode.refBrC_C()[w]);
                 if (w == 0) break;
             }
             ++total_cases;
             // Now calculate the maximum log likelihood for current number of cases.
-            NodeStructure::expected_t branchSum = static_cast<NodeStructure::expected_t>(_treeSimNode->getBrC());
+            NodeStructure::expected_t branchSum = static_cast<NodeStructure::expected_t>(simNode.getBrC());
             iMaxEndWindow = std::min(_endWindow.getEnd(), _startWindow.getEnd() + _window->maximum());
             for (iWindowEnd=_endWindow.getStart(); iWindowEnd <= iMaxEndWindow; ++iWindowEnd) {
                 _window->windowstart(_startWindow, iWindowEnd, iMinWindowStart, iWindowStart);
                 for (; iWindowStart >= iMinWindowStart; --iWindowStart) {
-                    NodeStructure::count_t branchWindow = _treeSimNode->getBrC_C()[iWindowStart] - _treeSimNode->getBrC_C()[iWindowEnd + 1];
+                    NodeStructure::count_t branchWindow = simNode.getBrC_C()[iWindowStart] - simNode.getBrC_C()[iWindowEnd + 1];
                     simLogLikelihood = std::max(simLogLikelihood, _loglikelihood->LogLikelihood(branchWindow, branchSum, iWindowEnd - iWindowStart + 1));
                 }
             }
@@ -739,6 +716,12 @@ SequentialMCSimSuccessiveFunctor::result_type SequentialMCSimSuccessiveFunctor::
     return temp_result;
 }
 
+/* Runs replicas [first, last), appending their results. */
+void SequentialMCSimSuccessiveFunctor::operator() (SequentialMCSimSuccessiveFunctor::param_type first, SequentialMCSimSuccessiveFunctor::param_type last, SequentialMCSimSuccessiveFunctor::block_result_type& results) {
+    for (param_type param=first; param < last; ++param)
+        results.push_back(std::make_pair(param, (*this)(param)));
+}
+
 /////////////////////////// SequentialReadMCSimSuccessiveFunctor //////////////////////////////////////
 
 /** Constructor */
@@ -782,4 +765,10 @@ SequentialReadMCSimSuccessiveFunctor::result_type SequentialReadMCSimSuccessiveF
         temp_result.Exception.addTrace("operator()", "SequentialReadMCSimSuccessiveFunctor");
     }
     return temp_result;
+}
+
+/* Runs replicas [first, last), appending their results. */
+void SequentialReadMCSimSuccessiveFunctor::operator() (SequentialReadMCSimSuccessiveFunctor::param_type first, SequentialReadMCSimSuccessiveFunctor::param_type last, SequentialReadMCSimSuccessiveFunctor::block_result_type& results) {
+    for (param_type param=first; param < last; ++param)
+        results.push_back(std::make_pair(param, (*this)(param)));
 }
\ No newline at end of file
@@ -8,6 +8,9 @@
 #include "MCSimJobSource.h"
 #include "Randomization.h"
 #include "WindowLength.h"
+#include "SignedRankCutScan.h"
+
+class SignedRankRandomizer;
 
 /* Abstract base measure list class. */
 class AbstractMeasureList {
@@ -17,6 +20,25 @@ class AbstractMeasureList {
 
         const ScanRunner& _scanRunner;
         Loglikelihood_t _loglikelihood;
+        std::vector<int> _candidate_cases;              // cases and measures of the cuts to calculate log likelihoods for, gathered for one batch
+        list_container_t _candidate_measures;
+        list_container_t _candidate_loglikelihoods;
+
+        void addCandidate(list_container_t::size_type c, double n) {
+            _candidate_cases.push_back(static_cast<int>(c));
+            _candidate_measures.push_back(n);
+        }
+        /* Calculates the log likelihoods of the gathered cuts in one batch, returning the maximum and clearing the cuts. */
+        double maximumCandidateLogLikelihood() {
+            double simLogLikelihood = -std::numeric_limits<double>::max();
+            _candidate_loglikelihoods.resize(_candidate_cases.size());
+            _loglikelihood->LogLikelihoods(_candidate_cases.data(), _candidate_measures.data(), 1, _candidate_cases.size(), _candidate_loglikelihoods.data());
+            for (double loglikelihood : _candidate_loglikelihoods)
+                simLogLikelihood = std::max(simLogLikelihood, loglikelihood);
+            _candidate_cases.clear();
+            _candidate_measures.clear();
+            return simLogLikelihood;
+        }
 
         void initializeMeasure(list_container_t& measure) {
             if (_scanRunner.getParameters().getModelType() == Parameters::BERNOULLI_TREE) {
@@ -60,7 +82,7 @@ class MinimumMeasureList : public AbstractMeasureList {
             initializeMeasure(*_min_measure);
         }
         virtual double loglikelihood() {
-            double simLogLikelihood = -std::numeric_limits<double>::max(),  max_excess(0);
+            double max_excess(0);
             list_container_t::size_type iListSize = static_cast<list_container_t::size_type>(_scanRunner.getTotalC()),
                                         iHalfListSize = static_cast<list_container_t::size_type>(iListSize/2);
             /* Don't want to consider simulations with cases less than minimum. */
@@ -73,14 +95,14 @@ class MinimumMeasureList : public AbstractMeasureList {
                 for (; i < iHalfListSize; ++i) {
                     if (static_cast<double>(i) - measure[i] * risk > max_excess) {
                         max_excess = static_cast<double>(i) - measure[i] * risk;
-                        simLogLikelihood = std::max(simLogLikelihood, _loglikelihood->LogLikelihood(static_cast<int>(i), measure[i]));
+                        addCandidate(i, measure[i]);
                     }
                 }
                 /* Calculate LLR for remaining half - trick not valid when number of cases is greater than or equal half. */
                 i=std::max(iHalfListSize, static_cast<list_container_t::size_type>(_scanRunner.getParameters().getMinimumHighRateNodeCases()));
                 for (; i <= iListSize; ++i) {
                     if (measure[i] != 0.0 && static_cast<double>(i) * total_measure > measure[i] * static_cast<double>(iListSize)) {
-                        simLogLikelihood = std::max(simLogLikelihood, _loglikelihood->LogLikelihood(static_cast<int>(i), measure[i]));
+                        addCandidate(i, measure[i]);
                     }
                 }
             } else {
@@ -88,18 +110,18 @@ class MinimumMeasureList : public AbstractMeasureList {
                 for (; i < iHalfListSize; ++i) {
                     if (static_cast<double>(i) - measure[i] > max_excess) {
                         max_excess = static_cast<double>(i) - measure[i];
-                        simLogLikelihood = std::max(simLogLikelihood, _loglikelihood->LogLikelihood(static_cast<int>(i), measure[i]));
+                        addCandidate(i, measure[i]);
                     }
                 }
                 /* Calculate LLR for remaining half - trick not valid when number of cases is greater than or equal half. */
                 i=std::max(iHalfListSize, static_cast<list_container_t::size_type>(_scanRunner.getParameters().getMinimumHighRateNodeCases()));
                 for (; i <= iListSize; ++i) {
                     if (measure[i] != 0.0 && static_cast<double>(i) > measure[i]) {
-                        simLogLikelihood = std::max(simLogLikelihood, _loglikelihood->LogLikelihood(static_cast<int>(i), measure[i]));
+                        addCandidate(i, measure[i]);
                     }
                 }
             }
-            return simLogLikelihood;
+            return maximumCandidateLogLikelihood();
         }
 };
 
@@ -123,7 +145,6 @@ public:
         initializeMeasure(*_max_measure);
     }
     virtual double loglikelihood() {
-        double simLogLikelihood = -std::numeric_limits<double>::max();
         list_container_t::size_type iListSize = static_cast<list_container_t::size_type>(_scanRunner.getTotalC());
         /** Don't want to consider simulations with cases less than minimum. */
         list_container_t::size_type i = static_cast<list_container_t::size_type>(_scanRunner.getParameters().getMinimumLowRateNodeCases());
@@ -133,17 +154,17 @@ public:
             double total_measure(_scanRunner.getTotalN());
             for (; i <= iListSize; ++i) {
                 if (measure[i] != 0.0 && static_cast<double>(i) * total_measure < measure[i] * static_cast<double>(iListSize)) {
-                    simLogLikelihood = std::max(simLogLikelihood, _loglikelihood->LogLikelihood(static_cast<int>(i), measure[i]));
+                    addCandidate(i, measure[i]);
                 }
             }
         } else {
             for (; i <= iListSize; ++i) {
                 if (measure[i] != 0.0 && static_cast<double>(i) < measure[i]) {
-                    simLogLikelihood = std::max(simLogLikelihood, _loglikelihood->LogLikelihood(static_cast<int>(i), measure[i]));
+                    addCandidate(i, measure[i]);
                 }
             }
         }
-        return simLogLikelihood;
+        return maximumCandidateLogLikelihood();
     }
 };
 
@@ -172,7 +193,7 @@ public:
         initializeMeasure(*_max_measure);
     }
     virtual double loglikelihood() {
-        double simLogLikelihood = -std::numeric_limits<double>::max(), max_excess(0);
+        double max_excess(0);
         list_container_t::size_type i, iListSize = static_cast<list_container_t::size_type>(_scanRunner.getTotalC()),
                                     iHalfListSize = static_cast<list_container_t::size_type>(iListSize / 2);
         // Start case index at specified minimum number of cases.
@@ -188,19 +209,19 @@ public:
             for (i=std::min(iL, iH); i < iHalfListSize; ++i) {
                 if (i >= iH && static_cast<double>(i) - minmeasure[i] * risk > max_excess) {
                     max_excess = static_cast<double>(i) - minmeasure[i] * risk;
-                    simLogLikelihood = std::max(simLogLikelihood, _loglikelihood->LogLikelihood(static_cast<int>(i), minmeasure[i]));
+                    addCandidate(i, minmeasure[i]);
                 }
                 if (i >= iL && maxmeasure[i] != 0.0 && static_cast<double>(i) * total_measure < maxmeasure[i] * static_cast<double>(iListSize)) {
-                    simLogLikelihood = std::max(simLogLikelihood, _loglikelihood->LogLikelihood(static_cast<int>(i), maxmeasure[i]));
+                    addCandidate(i, maxmeasure[i]);
                 }
             }
             // Calculate LLR for remaining half - trick not valid when number of cases is greater than or equal half.
             for (i = std::max(std::min(iL, iH), iHalfListSize); i <= iListSize; ++i) {
                 if (i >= iH && minmeasure[i] != 0 && static_cast<double>(i) * total_measure > minmeasure[i] * static_cast<double>(iListSize)) {
-                    simLogLikelihood = std::max(simLogLikelihood, _loglikelihood->LogLikelihood(static_cast<int>(i), minmeasure[i]));
+                    addCandidate(i, minmeasure[i]);
                 }
                 if (i >= iL && maxmeasure[i] != 0 && static_cast<double>(i) * total_measure < maxmeasure[i] * static_cast<double>(iListSize)) {
-                    simLogLikelihood = std::max(simLogLikelihood, _loglikelihood->LogLikelihood(static_cast<int>(i), maxmeasure[i]));
+                    addCandidate(i, maxmeasure[i]);
                 }
             }
         } else {
@@ -210,23 +231,23 @@ public:
             for (i = std::min(iL, iH); i < iHalfListSize; ++i) {
                 if (i >= iH && static_cast<double>(i) - minmeasure[i] > max_excess) {
                     max_excess = static_cast<double>(i) - minmeasure[i];
-                    simLogLikelihood = std::max(simLogLikelihood, _loglikelihood->LogLikelihood(static_cast<int>(i), minmeasure[i]));
+                    addCandidate(i, minmeasure[i]);
                 }
                 if (i >= iL && maxmeasure[i] != 0.0 && static_cast<double>(i) < maxmeasure[i]) {
-                    simLogLikelihood = std::max(simLogLikelihood, _loglikelihood->LogLikelihood(static_cast<int>(i), maxmeasure[i]));
+                    addCandidate(i, maxmeasure[i]);
                 }
             }
             // Calculate LLR for remaining half - trick not valid when number of cases is greater than or equal half.
             for (i = std::max(std::min(iL, iH), iHalfListSize); i <= iListSize; ++i) {
                 if (i >= iH && minmeasure[i] != 0 && static_cast<double>(i) > minmeasure[i]) {
-                    simLogLikelihood = std::max(simLogLikelihood, _loglikelihood->LogLikelihood(static_cast<int>(i), minmeasure[i]));
+                    addCandidate(i, minmeasure[i]);
                 }
                 if (i >= iL && maxmeasure[i] != 0 && static_cast<double>(i) < maxmeasure[i]) {
-                    simLogLikelihood = std::max(simLogLikelihood, _loglikelihood->LogLikelihood(static_cast<int>(i), maxmeasure[i]));
+                    addCandidate(i, maxmeasure[i]);
                 }
             }
         }
-        return simLogLikelihood;
+        return maximumCandidateLogLikelihood();
     }
 };
 
@@ -237,6 +258,7 @@ public:
     typedef unsigned int param_type;
     typedef MCSimJobSource::result_type result_type;
     typedef MCSimJobSource::successful_result_type successful_result_type;
+    typedef std::vector<std::pair<param_type, result_type> > block_result_type;
     
 protected:
     boost::mutex& _mutex;
@@ -245,9 +267,26 @@ protected:
     std::shared_ptr<AbstractRandomizer> _randomizer;
     const ScanRunner& _scanRunner;
     std::shared_ptr<AbstractMeasureList> _measure_list;
+    bool _scan_tree_blocks;                                   // whether blocks of replicas are scanned together (Poisson and Bernoulli tree-only)
+    std::vector<NodeStructure::count_t> _block_branch_counts; // branch counts of a block of replicas, node by replica
+    std::vector<char> _block_evaluated;                       // whether the current node is evaluated, per replica of block
+    std::vector<NodeStructure::count_t> _block_sums;          // case sums of the current cut, per replica of block
+    std::vector<double> _block_loglikelihoods;                // log likelihoods of the current cut, per replica of block
+    std::vector<successful_result_type> _block_results;
+    std::shared_ptr<const TemporalWindowScan> _window_scan;    // windows of the uniform temporal scan conditioned on the node
+    std::vector<NodeStructure::count_t> _window_counts;       // cases of the current cut, per window
+    std::vector<double> _window_loglikelihoods;               // log likelihoods of the current cut, per window
+    std::vector<NodeStructure::count_t> _branch_series;       // cumulative branch series of the current cut and its node's children
+    SignedRankRandomizer * _signed_rank_randomizer;           // set when randomizer is the signed rank randomizer
+    std::shared_ptr<const SignedRankCutScan> _signed_rank_cuts; // ranks of the signed rank cuts, when replicas only flip sample sites
+    std::vector<SignedRankCutScan::word_t> _sample_site_flips; // sample sites flipped in the current replica
+    std::vector<double> _cut_differences;                     // sample site differences of the current signed rank cut
 
     bool isEvaluated(const NodeStructure& node, const SimulationNode& simNode) const;
+    void retainBlockLogLikelihoods(const NodeStructure::count_t * c, double n, std::vector<successful_result_type>& results, double minimum_cases);
     successful_result_type scanTree(param_type const & param);
+    void scanTree(param_type first, param_type last, std::vector<successful_result_type>& results);
+    template <typename Evaluate> void scanSignedRankCuts(Evaluate evaluate);
     successful_result_type scanTreeSignedRank(param_type const& param);
     successful_result_type scanTreeTemporalConditionNode(param_type const & param);
     successful_result_type scanTreeTemporalConditionNodeCensored(param_type const & param);
@@ -257,6 +296,7 @@ public:
     MCSimSuccessiveFunctor(boost::mutex& mutex, std::shared_ptr<AbstractRandomizer> randomizer, const ScanRunner& scanRunner);
     //~MCSimSuccessiveFunctor() {}
     result_type operator() (param_type const & param);
+    void operator() (param_type first, param_type last, block_result_type& results);
 };
 
 /** Runs jobs for the "successive" algorithm for the sequential purely temporal scan */
@@ -265,10 +305,11 @@ public:
     typedef unsigned int param_type;
     typedef MCSimJobSource::result_type result_type;
     typedef MCSimJobSource::successful_result_type successful_result_type;
+    typedef std::vector<std::pair<param_type, result_type> > block_result_type;
     
 private:
     boost::mutex & _mutex;
-    std::shared_ptr<SimulationNode> _treeSimNode;
+    SimNodeContainer_t _treeSimNode;
    Loglikelihood_t _loglikelihood;
     const ScanRunner & _scanRunner;
     RandomNumberGenerator _random_number_generator;  // generates random numbers
@@ -281,6 +322,7 @@ private:
 public:
     SequentialMCSimSuccessiveFunctor(boost::mutex& mutex, const ScanRunner& scanner, std::shared_ptr<SequentialScanLoglikelihoodRatioWriter> writer);
     result_type operator() (param_type const & param);
+    void operator() (param_type first, param_type last, block_result_type& results);
 };
 
 class SequentialFileDataSource;
@@ -291,6 +333,7 @@ public:
     typedef unsigned int param_type;
     typedef MCSimJobSource::result_type result_type;
     typedef MCSimJobSource::successful_result_type successful_result_type;
+    typedef std::vector<std::pair<param_type, result_type> > block_result_type;
     
 private:
     boost::mutex & _mutex;
@@ -300,6 +343,7 @@ private:
 public:
     SequentialReadMCSimSuccessiveFunctor(boost::mutex& mutex, const ScanRunner& scanner, std::shared_ptr<SequentialFileDataSource> source);
     result_type operator() (param_type const & param);
+    void operator() (param_type first, param_type last, block_result_type& results);
 };
 //******************************************************************************
 #endif
@@ -81,9 +81,11 @@ long BinomialGenerator::GetBinomialDistributedVariable(long n, float pp, RandomN
    p=(pp <= 0.5 ? pp : 1.0-pp);
    am=n*p;
    if (n < 25) {
+      double uniforms[25];
       bnl=0.0;
-      for (j=1;j<=n;j++)
-         if (rng.GetRandomDouble() < p) bnl += 1.0;
+      if (n > 0) rng.GetRandomDoubles(uniforms, static_cast<size_t>(n));
+      for (j=0;j<n;j++)
+         if (uniforms[j] < p) bnl += 1.0;
    } else if (am < 1.0) {
       g=exp(-am);
       t=1.0;
@@ -17,9 +17,17 @@
          Communications of the ACM, October, 1988
  **********************************************************************/
 
-/** Lehmer generator which returns a pseudo-random real number uniformly
-    distributed between 0 and 1. */
-double RandomNumberGenerator::GetRandomDouble() {
+/** Multipliers and key increments of the Philox4x32 rounds. */
+static const uint32_t PHILOX_M0 = 0xD2511F53, PHILOX_M1 = 0xCD9E8D57, PHILOX_W0 = 0x9E3779B9, PHILOX_W1 = 0xBB67AE85;
+
+/** Returns a double uniformly distributed in (0,1) from the upper 52 bits of two 32-bit words. */
+static inline double ToUniform(uint32_t high, uint32_t low) {
+  uint64_t bits = ((static_cast<uint64_t>(high) << 32) | low) >> 12;
+  return (static_cast<double>(bits) + 0.5) / 4503599627370496.0;
+}
+
+/** Advances the Lehmer generator seed. */
+void RandomNumberGenerator::NextLehmerSeed() {
   long  t;
 
   t = glA * (glSeed % (glM / glA)) - (glM % glA) * (glSeed / (glM / glA));
@@ -27,29 +35,103 @@ double RandomNumberGenerator::GetRandomDouble() {
     glSeed = t;
   else
     glSeed = t + glM;
-  return (double) glSeed /  (double) glM;
 }
 
-/** Lehmer generator which returns a pseudo-random real number uniformly
-    distributed between 0 and 1. */
+/** Returns a pseudo-random real number uniformly distributed between 0 and 1. */
+double RandomNumberGenerator::GetRandomDouble() {
+  if (geEngine == LEHMER) {
+    NextLehmerSeed();
+    return (double) glSeed /  (double) glM;
+  }
+  if (giBlockPosition == BLOCK_SIZE) {
+    GenerateBlock(gBlock);
+    giBlockPosition = 0;
+  }
+  return gBlock[giBlockPosition++];
+}
+
+/** Fills values with the next 'count' pseudo-random real numbers uniformly distributed between 0 and 1 --
+    the same numbers as 'count' calls to GetRandomDouble(). */
+void RandomNumberGenerator::GetRandomDoubles(double * values, size_t count) {
+  size_t i=0;
+  if (geEngine == PHILOX) {
+    // use up the current block, then generate whole blocks directly into values
+    for (; i < count && giBlockPosition < BLOCK_SIZE; ++i)
+      values[i] = gBlock[giBlockPosition++];
+    for (; count - i >= BLOCK_SIZE; i += BLOCK_SIZE)
+      GenerateBlock(values + i);
+  }
+  for (; i < count; ++i)
+    values[i] = GetRandomDouble();
+}
+
+/** Returns a pseudo-random real number uniformly distributed between 0 and 1. */
 float RandomNumberGenerator::GetRandomFloat() {
-  long  t;
+  if (geEngine == LEHMER) {
+    NextLehmerSeed();
+    return (float) glSeed / (float) glM;
+  }
+  return static_cast<float>(GetRandomDouble());
+}
 
-  t = glA * (glSeed % (glM / glA)) - (glM % glA) * (glSeed / (glM / glA));
-  if (t > 0)
-    glSeed = t;
-  else
-    glSeed = t + glM;
-  return (float) glSeed / (float) glM;
+/** Philox4x32-10 block function -- encrypts counter with key, returning four 32-bit random words in result. */
+void RandomNumberGenerator::Philox(const uint32_t counter[4], const uint32_t key[2], uint32_t result[4]) {
+  uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3], k0 = key[0], k1 = key[1];
+
+  for (int round=0; round < 10; ++round) {
+    uint64_t product0 = static_cast<uint64_t>(PHILOX_M0) * c0, product1 = static_cast<uint64_t>(PHILOX_M1) * c2;
+    c0 = static_cast<uint32_t>(product1 >> 32) ^ c1 ^ k0;
+    c1 = static_cast<uint32_t>(product1);
+    c2 = static_cast<uint32_t>(product0 >> 32) ^ c3 ^ k1;
+    c3 = static_cast<uint32_t>(product0);
+    k0 += PHILOX_W0;
+    k1 += PHILOX_W1;
+  }
+  result[0] = c0; result[1] = c1; result[2] = c2; result[3] = c3;
+}
+
+/** Generates the next BLOCK_SIZE uniforms of the counter-based engine into values, advancing the counter. */
+void RandomNumberGenerator::GenerateBlock(double * values) {
+  uint32_t words[4];
+
+  for (unsigned int i=0; i < BLOCK_SIZE; i += 2) {
+    Philox(gCounter, gKey, words);
+    values[i] = ToUniform(words[0], words[1]);
+    values[i + 1] = ToUniform(words[2], words[3]);
+    if (++gCounter[0] == 0) ++gCounter[1];
+  }
+}
+
+/** Sets the counter-based engine key, restarting at the beginning of the first stream. */
+void RandomNumberGenerator::SetKey(long lSeed, unsigned int offset) {
+  gKey[0] = static_cast<uint32_t>(lSeed);
+  gKey[1] = static_cast<uint32_t>(offset);
+  gCounter[3] = 0;
+  SetStream(0);
+}
+
+/** Restarts the counter-based engine at the beginning of 'stream' -- e.g. a node of the simulation.
+    The Lehmer generator has a single stream, so it is left unchanged. */
+void RandomNumberGenerator::SetStream(unsigned int stream) {
+  if (geEngine == LEHMER) return;
+  gCounter[0] = gCounter[1] = 0;
+  gCounter[2] = static_cast<uint32_t>(stream);
+  giBlockPosition = BLOCK_SIZE;
 }
 
 /** Sets the random number generator seed.  Note: 0 < lSeed < glM */
 void RandomNumberGenerator::SetSeed(long lSeed) {
   glSeed = ((0 < lSeed && lSeed < glM) ? lSeed : glDefaultSeed);
+  SetKey(glSeed, 0);
 }
 
-/** Set the seed -- checking that casted value is within numeric limits considering offset from initial seed. */
+/** Set the seed -- checking that casted value is within numeric limits considering offset from initial seed.
+    The counter-based engine is keyed on the initial seed and offset, so any offset is valid. */
 void RandomNumberGenerator::SetSeedOffset(unsigned int offset) {
+    if (geEngine == PHILOX) {
+        SetKey(GetInitialSeed(), offset);
+        return;
+    }
     try {
         // calculate seed as unsigned long
         unsigned long ulSeed = static_cast<unsigned long>(GetInitialSeed()) + static_cast<unsigned long>(offset);
@@ -66,9 +148,10 @@ void RandomNumberGenerator::SetSeedOffset(unsigned int offset) {
 /** Sets initial value for the random number generator seed.  Note: 0 < lSeed < glM */
 void RandomNumberGenerator::SetInitialSeed(long lSeed) {
   glSeed = glInitialSeed = ((0 < lSeed && lSeed < glM) ? lSeed : glDefaultSeed);
+  SetKey(glInitialSeed, 0);
 }
 
-/** Tests for a correct implementation.
+/** Tests for a correct implementation of the Lehmer generator.
     Return value: 1 = Correct
                   0 = incorrect         */
 int RandomNumberGenerator::Test() {
@@ -76,6 +159,6 @@ int RandomNumberGenerator::Test() {
 
   SetSeed(1);
   for (l=1; l <= 10000; l++)
-     GetRandomDouble();
+     NextLehmerSeed();
   return (GetSeed() == glCheck);
 }
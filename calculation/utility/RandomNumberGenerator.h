@@ -2,6 +2,8 @@
 #ifndef __RANDOMNUMBERGENERATOR_H
 #define __RANDOMNUMBERGENERATOR_H
 //*****************************************************************************
+#include <cstdint>
+#include <cstddef>
 
 /**********************************************************************
  file: RandomNumberGenerator.h
@@ -19,15 +21,39 @@
          Communications of the ACM, October, 1988
  **********************************************************************/
 
+/**********************************************************************
+ The generator can alternatively run a counter-based engine, Philox4x32-10:
+   "Parallel Random Numbers: As Easy as 1, 2, 3"
+               John Salmon, Mark Moraes, Ron Dror & David Shaw
+         Proceedings of SC11, November 2011
+ Its stream of numbers is a pure function of (seed, offset, stream), so any
+ simulation replica -- or node within it -- can be generated independently,
+ without the sequential state of the Lehmer generator and without the limit
+ it puts on the seed plus offset.
+ **********************************************************************/
+
 class RandomNumberGenerator {
+  public:
+    enum EngineType {LEHMER=0, PHILOX};                 // Lehmer is the legacy engine
+
   private:
+    static const unsigned int BLOCK_SIZE = 8;           // number of uniforms generated at a time by counter-based engine
+
+    EngineType          geEngine;                       // engine generating numbers
     long                glSeed;                         // current randomization seed
     long                glInitialSeed;                  // initial seed at construction
+    uint32_t            gKey[2];                        // counter-based engine key -- (seed, offset)
+    uint32_t            gCounter[4];                    // counter-based engine counter -- (position low, position high, stream, 0)
+    double              gBlock[BLOCK_SIZE];             // uniforms generated by counter-based engine and not yet returned
+    unsigned int        giBlockPosition;                // position of next uniform in gBlock
 
+    void                GenerateBlock(double * values);
+    void                NextLehmerSeed();
     void                SetInitialSeed(long lSeed);
+    void                SetKey(long lSeed, unsigned int offset);
 
   public:
-    RandomNumberGenerator(long lInitialSeed=glDefaultSeed) {SetInitialSeed(lInitialSeed);}
+    RandomNumberGenerator(long lInitialSeed=glDefaultSeed, EngineType eEngine=LEHMER) : geEngine(eEngine) {SetInitialSeed(lInitialSeed);}
     ~RandomNumberGenerator() {}
 
     static const long   glDefaultSeed = 12345678;       // default seed
@@ -35,13 +61,19 @@ class RandomNumberGenerator {
     static const long   glM           = 2147483647;     // fixed prime modulus, 2^31 - 1
     static const long   glA           = 48271;          // multiplier
 
+    static void         Philox(const uint32_t counter[4], const uint32_t key[2], uint32_t result[4]);
+
+    EngineType          GetEngine() const {return geEngine;}
     long                GetInitialSeed() const {return glInitialSeed;}
     long                GetMaxSeed() const {return glM;}
     double              GetRandomDouble();
+    void                GetRandomDoubles(double * values, size_t count);
     float               GetRandomFloat();
     long                GetSeed() const {return glSeed;}
+    bool                IsCounterBased() const {return geEngine != LEHMER;}
     void                SetSeed(long lSeed);
     void                SetSeedOffset(unsigned int offset);
+    void                SetStream(unsigned int stream);
     int                 Test();
 };
 #endif
@@ -0,0 +1,220 @@
+#include "TreeScan.h"
+#pragma hdrstop
+#include "RandomSampler.h"
+#include <algorithm>
+#include <cmath>
+
+/** Returns the Stirling series correction, log(k!) - [(k + 1/2)log(k + 1) - (k + 1) + log(2 pi)/2]. */
+static double stirlingCorrection(long k) {
+    static const double table[10] = {0.08106146679532726, 0.04134069595540929, 0.02767792568499834, 0.02079067210376509, 0.01664469118982119,
+                                     0.01387612882307075, 0.01189670994589177, 0.01041126526197209, 0.009255462182712733, 0.008330563433362871};
+    if (k < 10) return table[k];
+    double kp1 = static_cast<double>(k) + 1.0, kp1sq = kp1 * kp1;
+    return (1.0 / 12.0 - (1.0 / 360.0 - 1.0 / 1260.0 / kp1sq) / kp1sq) / kp1;
+}
+
+//////////////////////////////// PoissonSampler ////////////////////////////////
+
+/** Sets up the sampling constants for lambda. */
+void PoissonSampler::setup(double lambda) {
+    _lambda = lambda;
+    _rejection = lambda >= 10.0;
+    if (_rejection) {
+        double sqrt_lambda = std::sqrt(lambda);
+        _log_lambda = std::log(lambda);
+        _b = 0.931 + 2.53 * sqrt_lambda;
+        _a = -0.059 + 0.02483 * _b;
+        _log_alpha = std::log(1.1239 + 1.1328 / (_b - 3.4));
+        _vr = 0.9277 - 3.6224 / (_b - 2.0);
+    } else
+        _exp_lambda = std::exp(-lambda);
+}
+
+/** Returns a Poisson(lambda) distributed variable. */
+long PoissonSampler::sample(double lambda, RandomNumberGenerator& rng) {
+    if (lambda <= 0.0) return 0;
+    if (lambda != _lambda) setup(lambda);
+
+    while (!_rejection) {
+        // inversion by sequential search from zero
+        long k = 0;
+        double u = rng.GetRandomDouble(), probability = _exp_lambda;
+        while (u > probability && probability > 0.0) {
+            u -= probability;
+            ++k;
+            probability *= lambda / static_cast<double>(k);
+        }
+        if (probability > 0.0) return k; // otherwise exhausted by rounding, start over
+    }
+    // transformed rejection with squeeze
+    while (true) {
+        double u = rng.GetRandomDouble() - 0.5, v = rng.GetRandomDouble(), us = 0.5 - std::fabs(u);
+        double k = std::floor((2.0 * _a / us + _b) * u + lambda + 0.43);
+        if (us >= 0.07 && v <= _vr) return static_cast<long>(k);
+        if (k < 0.0 || (us < 0.013 && v > us)) continue;
+        if (std::log(v) + _log_alpha - std::log(_a / (us * us) + _b) <= -lambda + k * _log_lambda - std::lgamma(k + 1.0))
+            return static_cast<long>(k);
+    }
+}
+
+//////////////////////////////// BinomialSampler ////////////////////////////////
+
+/** Sets up the sampling constants for n and p. */
+void BinomialSampler::setup(long n, double p) {
+    _n = n;
+    _p = p;
+    _complement = p > 0.5;
+    _ps = _complement ? 1.0 - p : p;
+    _qs = 1.0 - _ps;
+    _rejection = static_cast<double>(n) * _ps >= 10.0;
+    if (_rejection) {
+        double spq;
+        _m = static_cast<long>(std::floor(static_cast<double>(n + 1) * _ps));
+        _r = _ps / _qs;
+        _nr = static_cast<double>(n + 1) * _r;
+        _npq = static_cast<double>(n) * _ps * _qs;
+        spq = std::sqrt(_npq);
+        _b = 1.15 + 2.53 * spq;
+        _a = -0.0873 + 0.0248 * _b + 0.01 * _ps;
+        _c = static_cast<double>(n) * _ps + 0.5;
+        _alpha = (2.83 + 5.1 / _b) * spq;
+        _vr = 0.92 - 4.2 / _b;
+        _urvr = 0.86 * _vr;
+        double nm = static_cast<double>(n - _m + 1);
+        _h = (static_cast<double>(_m) + 0.5) * std::log((static_cast<double>(_m) + 1.0) / (_r * nm)) + stirlingCorrection(_m) + stirlingCorrection(n - _m);
+    } else {
+        _s = _ps / _qs;
+        _inv_a = static_cast<double>(n + 1) * _s;
+        _inv_r = std::pow(_qs, static_cast<double>(n));
+    }
+}
+
+/** Returns a binomial(n, p) distributed variable. */
+long BinomialSampler::sample(long n, double p, RandomNumberGenerator& rng) {
+    if (n <= 0 || p <= 0.0) return 0;
+    if (p >= 1.0) return n;
+    if (n != _n || p != _p) setup(n, p);
+    long k = _rejection ? sampleRejection(rng) : sampleInversion(rng);
+    return _complement ? n - k : k;
+}
+
+/** Returns a binomial(n, min(p, 1 - p)) distributed variable by inversion -- sequential search from zero. */
+long BinomialSampler::sampleInversion(RandomNumberGenerator& rng) const {
+    while (true) {
+        long k = 0;
+        double u = rng.GetRandomDouble(), probability = _inv_r;
+        while (u > probability && k <= _n) {
+            u -= probability;
+            ++k;
+            probability *= _inv_a / static_cast<double>(k) - _s;
+        }
+        if (k <= _n) return k; // otherwise exhausted by rounding, start over
+    }
+}
+
+/** Returns a binomial(n, min(p, 1 - p)) distributed variable by transformed rejection with decomposition (BTRD). */
+long BinomialSampler::sampleRejection(RandomNumberGenerator& rng) const {
+    while (true) {
+        double u, v = rng.GetRandomDouble();
+        if (v <= _urvr) {
+            u = v / _vr - 0.43;
+            return static_cast<long>(std::floor((2.0 * _a / (0.5 - std::fabs(u)) + _b) * u + _c));
+        }
+        if (v >= _vr)
+            u = rng.GetRandomDouble() - 0.5;
+        else {
+            u = v / _vr - 0.93;
+            u = (u < 0.0 ? -0.5 : 0.5) - u;
+            v = rng.GetRandomDouble() * _vr;
+        }
+        double us = 0.5 - std::fabs(u), kd = std::floor((2.0 * _a / us + _b) * u + _c);
+        if (kd < 0.0 || kd > static_cast<double>(_n)) continue;
+        long k = static_cast<long>(kd), km = std::labs(k - _m);
+        v = v * _alpha / (_a / (us * us) + _b);
+        if (km <= 15) {
+            // recursive evaluation of f(k)
+            double f = 1.0;
+            if (_m < k) {
+                for (long i=_m + 1; i <= k; ++i) f *= _nr / static_cast<double>(i) - _r;
+            } else if (_m > k) {
+                for (long i=k + 1; i <= _m; ++i) v *= _nr / static_cast<double>(i) - _r;
+            }
+            if (v <= f) return k;
+            continue;
+        }
+        // squeeze acceptance or rejection
+        double dkm = static_cast<double>(km);
+        v = std::log(v);
+        double rho = (dkm / _npq) * (((dkm / 3.0 + 0.625) * dkm + 1.0 / 6.0) / _npq + 0.5), t = -dkm * dkm / (2.0 * _npq);
+        if (v < t - rho) return k;
+        if (v > t + rho) continue;
+        // final acceptance or rejection
+        double nk = static_cast<double>(_n - k + 1);
+        if (v <= _h + static_cast<double>(_n + 1) * std::log(static_cast<double>(_n - _m + 1) / nk) +
+                  (static_cast<double>(k) + 0.5) * std::log(nk * _r / (static_cast<double>(k) + 1.0)) - stirlingCorrection(k) - stirlingCorrection(_n - k))
+            return k;
+    }
+}
+
+//////////////////////////////// HypergeometricSampler ////////////////////////////////
+
+/** Returns log(k!). */
+static double logFactorial(long k) {
+    return std::lgamma(static_cast<double>(k) + 1.0);
+}
+
+/** Returns the number of successes among 'draws' drawn without replacement from 'successes' successes and 'failures' failures. */
+long HypergeometricSampler::sample(long successes, long failures, long draws, RandomNumberGenerator& rng) const {
+    if (draws <= 0 || successes <= 0) return 0;
+    if (failures <= 0) return std::min(draws, successes);
+    long population = successes + failures;
+    if (draws >= population) return successes;
+    // by symmetry, sample the lesser of successes and failures among the lesser of those drawn and those not drawn
+    long good = std::min(successes, failures), bad = population - good, n = std::min(draws, population - draws);
+    long k = static_cast<double>(n) * static_cast<double>(good) / static_cast<double>(population) < 10.0 ?
+             sampleInversion(good, bad, n, rng) : sampleRatioOfUniforms(good, bad, n, rng);
+    if (successes > failures) k = n - k;
+    if (n < draws) k = successes - k;
+    return k;
+}
+
+/** Returns the number of good among 'draws' from 'good' and 'bad', by inversion -- sequential search from zero. Expects good <= bad and
+    draws at most half the population. */
+long HypergeometricSampler::sampleInversion(long good, long bad, long draws, RandomNumberGenerator& rng) const {
+    long population = good + bad, limit = std::min(good, draws);
+    double none = std::exp(logFactorial(bad) - logFactorial(bad - draws) + logFactorial(population - draws) - logFactorial(population));
+    while (true) {
+        long k = 0;
+        double u = rng.GetRandomDouble(), probability = none;
+        while (u > probability && k < limit) {
+            u -= probability;
+            probability *= static_cast<double>(good - k) * static_cast<double>(draws - k) / (static_cast<double>(k + 1) * static_cast<double>(bad - draws + k + 1));
+            ++k;
+        }
+        if (u <= probability) return k; // otherwise exhausted by rounding, start over
+    }
+}
+
+/** Returns the number of good among 'draws' from 'good' and 'bad', by ratio of uniforms (HRUA). Expects good <= bad and draws at most
+    half the population. */
+long HypergeometricSampler::sampleRatioOfUniforms(long good, long bad, long draws, RandomNumberGenerator& rng) const {
+    const double d1 = 1.7155277699214135, d2 = 0.8989161620588988; // 2 * sqrt(2 / e) and 3 - 2 * sqrt(3 / e)
+    double population = static_cast<double>(good + bad), p = static_cast<double>(good) / population, q = static_cast<double>(bad) / population;
+    double a = static_cast<double>(draws) * p + 0.5;
+    double c = std::sqrt((population - static_cast<double>(draws)) * static_cast<double>(draws) * p * q / (population - 1.0) + 0.5);
+    double h = d1 * c + d2;
+    long m = static_cast<long>(std::floor(static_cast<double>(draws + 1) * static_cast<double>(good + 1) / (population + 2.0)));
+    double g = logFactorial(m) + logFactorial(good - m) + logFactorial(draws - m) + logFactorial(bad - draws + m);
+    double b = std::min(static_cast<double>(std::min(draws, good) + 1), std::floor(a + 16.0 * c));
+    while (true) {
+        double u = rng.GetRandomDouble(), v = rng.GetRandomDouble();
+        if (u <= 0.0) continue;
+        double x = a + h * (v - 0.5) / u;
+        if (x < 0.0 || x >= b) continue;
+        long k = static_cast<long>(std::floor(x));
+        double t = g - (logFactorial(k) + logFactorial(good - k) + logFactorial(draws - k) + logFactorial(bad - draws + k));
+        if (u * (4.0 - u) - 3.0 <= t) return k;     // squeeze acceptance
+        if (u * (u - t) >= 1.0) continue;           // squeeze rejection
+        if (2.0 * std::log(u) <= t) return k;
+    }
+}
@@ -0,0 +1,126 @@
+//*****************************************************************************
+#ifndef __RANDOMSAMPLER_H
+#define __RANDOMSAMPLER_H
+//*****************************************************************************
+#include "RandomNumberGenerator.h"
+
+/**********************************************************************
+ file: RandomSampler.h
+ Header file for RandomSampler.cpp
+ Samplers of Poisson and binomial variates in expected constant time,
+ using the transformed rejection methods of -
+   "The transformed rejection method for generating Poisson random variables"
+               Wolfgang Hormann
+         Insurance: Mathematics and Economics 12, 1993 (PTRS)
+   "The generation of binomial random variates"
+               Wolfgang Hormann
+         Journal of Statistical Computation and Simulation 46, 1993 (BTRD)
+ Small means are sampled by inversion. The constants of a sampler depend
+ only on the distribution parameters, so a sampler is kept per node and
+ set up again only when those parameters change. Multinomial counts are
+ drawn as a sequence of conditional binomials. Hypergeometric variates
+ are drawn by ratio of uniforms, for conditional case splits.
+ **********************************************************************/
+
+/** Generates Poisson(lambda) distributed variables. */
+class PoissonSampler {
+  private:
+    double      _lambda;            // lambda constants are set up for
+    bool        _rejection;         // whether sampling by transformed rejection (PTRS) rather than inversion
+    double      _exp_lambda;        // inversion: exp(-lambda)
+    double      _log_lambda;        // PTRS constants
+    double      _a;
+    double      _b;
+    double      _vr;
+    double      _log_alpha;
+
+    void        setup(double lambda);
+
+  public:
+    PoissonSampler() : _lambda(-1.0) {}
+
+    long        sample(double lambda, RandomNumberGenerator& rng);
+};
+
+/** Generates binomial(n, p) distributed variables. */
+class BinomialSampler {
+  private:
+    long        _n;                 // n and p constants are set up for
+    double      _p;
+    bool        _complement;        // whether sampling n - binomial(n, 1 - p)
+    bool        _rejection;         // whether sampling by transformed rejection (BTRD) rather than inversion
+    double      _ps;                // probability sampled, min(p, 1 - p), and its complement
+    double      _qs;
+    double      _s;                 // inversion constants
+    double      _inv_a;
+    double      _inv_r;
+    long        _m;                 // BTRD constants
+    double      _r;
+    double      _nr;
+    double      _npq;
+    double      _a;
+    double      _b;
+    double      _c;
+    double      _alpha;
+    double      _vr;
+    double      _urvr;
+    double      _h;
+
+    void        setup(long n, double p);
+    long        sampleInversion(RandomNumberGenerator& rng) const;
+    long        sampleRejection(RandomNumberGenerator& rng) const;
+
+  public:
+    BinomialSampler() : _n(-1), _p(-1.0) {}
+
+    long        sample(long n, double p, RandomNumberGenerator& rng);
+};
+
+/** Generates hypergeometric variables -- the number of successes in draws without replacement from a population of successes and failures.
+    Uses inversion by sequential search from zero for small means, otherwise the ratio of uniforms method of -
+      "Sampling from Poisson, binomial and hypergeometric distributions: ratio of uniforms as a simple and fast alternative"
+                  Ernst Stadlober, Berichte der Mathematisch-Statistischen Sektion, Graz 303, 1989 (HRUA) */
+class HypergeometricSampler {
+  private:
+    long        sampleInversion(long good, long bad, long draws, RandomNumberGenerator& rng) const;
+    long        sampleRatioOfUniforms(long good, long bad, long draws, RandomNumberGenerator& rng) const;
+
+  public:
+    long        sample(long successes, long failures, long draws, RandomNumberGenerator& rng) const;
+};
+
+/** Distributes cases over the indexes [0, size) multinomially, in proportion to weights given by their cumulative function -- cumulative(k)
+    being the total weight of the indexes before k. The indexes are split in half recursively, the cases of the lower half drawn from a
+    binomial, and only halves holding cases are split further. So a draw takes at most 2 * size binomial variates, or about log2(size) per
+    case when the cases are few, rather than a uniform variate and search per case. */
+class MultinomialSampler {
+  private:
+    BinomialSampler _binomial;
+
+    template <typename Cumulative, typename Assign>
+    void        split(long n, size_t first, size_t last, Cumulative& cumulative, Assign& assign, RandomNumberGenerator& rng) {
+        while (last - first > 1) {
+            size_t middle = first + (last - first) / 2;
+            double lower = cumulative(middle) - cumulative(first), total = lower + (cumulative(last) - cumulative(middle));
+            long cases = _binomial.sample(n, lower / total, rng);
+            if (cases) split(cases, first, middle, cumulative, assign, rng);
+            if ((n -= cases) == 0) return;
+            first = middle;
+        }
+        assign(first, n);
+    }
+
+  public:
+    /* Calls assign(index, cases) for each index drawing any of the 'n' cases. */
+    template <typename Cumulative, typename Assign>
+    void        sample(long n, size_t size, Cumulative cumulative, Assign assign, RandomNumberGenerator& rng) {
+        if (n > 0 && size) split(n, 0, size, cumulative, assign, rng);
+    }
+    /* Calls assign(index, cases) for each index drawing any of the 'n' cases, the indexes being equally likely. */
+    template <typename Assign>
+    void        sampleUniform(long n, size_t size, Assign assign, RandomNumberGenerator& rng) {
+        sample(n, size, [](size_t k) { return static_cast<double>(k); }, assign, rng);
+    }
+};
+//*****************************************************************************
+#endif
@@ -0,0 +1,54 @@
+//******************************************************************************
+#ifndef __TopValues_H
+#define __TopValues_H
+//******************************************************************************
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+/** The 'capacity' best values added, as ordered by 'Better', kept as a heap with the worst of them at the front. A value is compared
+    against the worst value kept and, when better, replaces it in logarithmic time -- where a sorted list shifts every value after the
+    insertion point. 'Better' must be a strict weak ordering; values which are unordered with every value (e.g. not a number) are only
+    added while fewer than capacity values are kept. */
+template <typename T, typename Better=std::greater<T> >
+class TopValues {
+    public:
+        typedef std::vector<T> container_t;
+
+    private:
+        size_t      _capacity;
+        Better      _better;
+        container_t _heap;
+
+    public:
+        TopValues(size_t capacity=0, Better better=Better()) : _capacity(capacity), _better(better) { _heap.reserve(capacity); }
+
+        size_t      capacity() const { return _capacity; }
+        size_t      size() const { return _heap.size(); }
+        bool        full() const { return _heap.size() == _capacity; }
+
+        /* Adds 'value' if fewer than capacity values are kept or it is better than the worst value kept. Returns whether added. */
+        bool add(const T& value) {
+            if (_heap.size() < _capacity) {
+                _heap.push_back(value);
+                std::push_heap(_heap.begin(), _heap.end(), _better);
+                return true;
+            }
+            if (_heap.empty() || !_better(value, _heap.front())) return false;
+            std::pop_heap(_heap.begin(), _heap.end(), _better);
+            _heap.back() = value;
+            std::push_heap(_heap.begin(), _heap.end(), _better);
+            return true;
+        }
+        /* Returns the worst value kept -- there must be at least one. */
+        const T & worst() const { return _heap.front(); }
+        /* Returns the values kept, best first. */
+        container_t getSorted() const {
+            container_t sorted(_heap);
+            std::sort_heap(sorted.begin(), sorted.end(), _better);
+            return sorted;
+        }
+        void clear() { _heap.clear(); }
+};
+//******************************************************************************
+#endif
@@ -5,7 +5,10 @@
 //---------------------------------------------------------------------------
 #include <vector>
 #include <algorithm>
+#include <atomic>
+#include <map>
 #include "boost/thread/thread.hpp"
+#include "boost/thread/mutex.hpp"
 #include "boost/thread/recursive_mutex.hpp"
 #include "boost/dynamic_bitset.hpp"
 #include "PrjException.h"
@@ -157,6 +160,158 @@ public:
 };
 
 
+/** A contractor that hands out consecutive chunks of job parameters through an atomic counter, so that acquiring work takes no lock.
+    Subcontractors run a whole chunk, buffering its results, and register the chunk at once. Chunks are passed on to the job source
+    strictly in job order, so the job source sees the same acquire/register sequence as with a single subcontractor -- which keeps
+    ordered reporting and early termination intact. Job ids are expected to be the consecutive values 1..job_count. */
+template <typename JobSource>
+class chunked_contractor
+{
+public:
+  typedef typename JobSource::param_type job_param_type;
+  typedef typename JobSource::result_type job_result_type;
+  typedef std::vector<std::pair<job_param_type, job_result_type> > chunk_results_type;
+
+private:
+  typedef boost::mutex access_mutex_t;
+  typedef std::map<job_param_type, chunk_results_type> pending_chunks_type;
+
+  JobSource & m_jobs;
+  const job_param_type m_job_count;
+  const job_param_type m_chunk_size;
+  std::atomic<job_param_type> m_next_job;  // first job of the next chunk to hand out
+  std::atomic<bool> m_stopped;             // set once the job source is exhausted or an unhandled exception occurred
+  job_param_type m_next_registration;      // first job of the next chunk to pass on to the job source
+  pending_chunks_type m_pending_chunks;    // completed chunks waiting on an earlier chunk
+  mutable access_mutex_t m_access_mutex;
+
+  void register_chunk(chunk_results_type const & results) {
+    for (auto const & job: results) {
+      if (m_jobs.is_exhausted()) break; // remaining results would have been ignored by the job source
+      typename JobSource::job_id_type job_id;
+      job_param_type job_param;
+      m_jobs.acquire(job_id, job_param);
+      if (job_param != job.first)
+        throw prg_error("Registering job %u out of order, expected job %u.", "chunked_contractor::register_chunk()", job.first, job_param);
+      m_jobs.register_result(job_id, job_param, job.second);
+    }
+  }
+
+public:
+  treescan::unhandled_exception m_unhandled_exception;
+
+public:
+  chunked_contractor(JobSource & jobs, job_param_type job_count, unsigned int num_subcontractors)
+   : m_jobs(jobs)
+   , m_job_count(job_count)
+   // Several chunks per subcontractor balance the load; capping the size bounds the work discarded after early termination.
+   , m_chunk_size(std::max<job_param_type>(1, std::min<job_param_type>(32, job_count / (std::max(1u, num_subcontractors) * 8))))
+   , m_next_job(1)
+   , m_stopped(false)
+   , m_next_registration(1)
+  {
+    m_unhandled_exception.bUnExceptional = true;
+  }
+
+  void set_unhandled_exception(const prg_exception &e, treescan::unhandled_exception::exception_type except_type) {
+      access_mutex_t::scoped_lock lcl_lock(m_access_mutex);
+      m_unhandled_exception.eException_type = except_type;
+      m_unhandled_exception.Exception = e;
+      m_unhandled_exception.bUnExceptional = false;
+      m_stopped = true;
+  }
+
+  void throw_unhandled_exception() const {
+      access_mutex_t::scoped_lock lcl_lock(m_access_mutex);
+      if (!m_unhandled_exception.bUnExceptional) {
+          switch (m_unhandled_exception.eException_type) {
+              case treescan::unhandled_exception::memory  : throw memory_exception(m_unhandled_exception.Exception.what());
+              case treescan::unhandled_exception::std     :
+              case treescan::unhandled_exception::prg     :
+              case treescan::unhandled_exception::unknown :
+              default                                    : throw m_unhandled_exception.Exception;
+          }
+      }
+  }
+
+  bool is_finished() const { return m_stopped || m_next_job > m_job_count; }
+
+  job_param_type chunk_size() const { return m_chunk_size; }
+
+  /* Claims the next chunk of jobs [first, last), returning false once there is nothing left to claim. */
+  bool chunk_acquired(job_param_type & first, job_param_type & last) {
+    if (m_stopped) return false;
+    job_param_type start = m_next_job.fetch_add(m_chunk_size);
+    if (start > m_job_count) return false;
+    first = start;
+    last = std::min<job_param_type>(start + m_chunk_size, m_job_count + 1);
+    return true;
+  }
+
+  /* Registers the results of a claimed chunk, passing them on to the job source once all earlier chunks have been registered. */
+  void register_results(chunk_results_type & results) {
+    if (results.empty()) return;
+    access_mutex_t::scoped_lock lcl_lock(m_access_mutex);
+    if (results.front().first != m_next_registration) {
+      m_pending_chunks[results.front().first].swap(results);
+      return;
+    }
+    register_chunk(results);
+    m_next_registration += static_cast<job_param_type>(results.size());
+    typename pending_chunks_type::iterator itr = m_pending_chunks.begin();
+    while (itr != m_pending_chunks.end() && itr->first == m_next_registration) {
+      register_chunk(itr->second);
+      m_next_registration += static_cast<job_param_type>(itr->second.size());
+      itr = m_pending_chunks.erase(itr);
+    }
+    if (m_jobs.is_exhausted()) m_stopped = true;
+  }
+};
+
+
+/** Runs jobs of a chunked_contractor, a chunk at a time, until the contractor is finished. The function is called once per chunk,
+    as function(first, last, results), appending the results of jobs [first, last) -- so it can run a chunk of jobs together. */
+template <typename ContractorType, typename Function>
+class chunked_subcontractor
+{
+  ContractorType & m_contractor;
+  Function m_function;
+
+public:
+  chunked_subcontractor(ContractorType & contractor, Function function)
+   : m_contractor(contractor)
+   , m_function(function)
+  {}
+
+  void operator() ()
+  {
+    try {
+        typename ContractorType::chunk_results_type results;
+        results.reserve(m_contractor.chunk_size());
+        typename ContractorType::job_param_type first, last;
+        while (m_contractor.chunk_acquired(first, last))
+        {
+            results.clear();
+            m_function(first, last, results);
+            m_contractor.register_results(results);
+        }
+    } catch (memory_exception & e) {
+      prg_exception x(e.what(), "chunked_subcontractor::operator()");
+      m_contractor.set_unhandled_exception(x, treescan::unhandled_exception::memory);
+    } catch (prg_exception & e) {
+      m_contractor.set_unhandled_exception(e, treescan::unhandled_exception::prg);
+    } catch (std::exception & e) {
+      prg_exception x(e.what(), "chunked_subcontractor::operator()");
+      m_contractor.set_unhandled_exception(x, treescan::unhandled_exception::std);
+    } catch (...) {
+      prg_exception x("(...) -- unknown error", "chunked_subcontractor::operator()");
+      m_contractor.set_unhandled_exception(x, treescan::unhandled_exception::unknown);
+    }
+  }
+
+};
+
+
 template <typename ParamType, typename ResultType>
 class null_jobsource_continuation_policy
 {
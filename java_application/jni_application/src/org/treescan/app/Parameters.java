@@ -31,6 +31,10 @@ public class Parameters implements Cloneable {
     public enum TemporalGraphReportType {MLC_ONLY, X_MCL_ONLY, SIGNIFICANT_ONLY}    
     /** p-values reporting type */
     public enum PValueReportingType { STANDARD_PVALUE, TERMINATION_PVALUE };
+    /** random number generator type */
+    public enum RandomNumberGeneratorType { LEHMER_RNG, PHILOX_RNG };
+    /** Poisson and binomial sampler type */
+    public enum SamplerType { LEGACY_SAMPLER, REJECTION_SAMPLER };
     public class CreationVersion {
     	public int _major;
     	public int _minor;
@@ -124,6 +128,8 @@ public class Parameters implements Cloneable {
     /* PValue Reporting variables */
     private PValueReportingType _pvalue_reporting_type=PValueReportingType.STANDARD_PVALUE; /** PValue reporting type */
     private int _early_term_threshold=50; /** early termination threshold */
+    private RandomNumberGeneratorType _random_number_generator_type=RandomNumberGeneratorType.LEHMER_RNG; /** random number generator engine */
+    private SamplerType _sampler_type=SamplerType.LEGACY_SAMPLER; /** Poisson, binomial and multinomial sampler */
     private boolean _report_data_as_percentage=false;
     private String _results_title="";
     
@@ -237,6 +243,8 @@ public class Parameters implements Cloneable {
           if (_include_identical_parent_cuts != rhs._include_identical_parent_cuts) return false;
           if (_pvalue_reporting_type != rhs._pvalue_reporting_type) return false;
           if (_early_term_threshold != rhs._early_term_threshold) return false;
+          if (_random_number_generator_type != rhs._random_number_generator_type) return false;
+          if (_sampler_type != rhs._sampler_type) return false;
           if (_report_data_as_percentage != rhs._report_data_as_percentage) return false;
           if (!_results_title.equals(rhs._results_title)) return false;
               
@@ -263,6 +271,10 @@ public class Parameters implements Cloneable {
     public void setPValueReportingType(int ord){try {_pvalue_reporting_type = PValueReportingType.values()[ord];} catch (ArrayIndexOutOfBoundsException e) {ThrowEnumException(ord, PValueReportingType.values());}}
     public int getEarlyTermThreshold() { return _early_term_threshold; }
     public void setEarlyTermThreshold(int i) { _early_term_threshold = i; }
+    public RandomNumberGeneratorType getRandomNumberGeneratorType() { return _random_number_generator_type; }
+    public void setRandomNumberGeneratorType(int ord){try {_random_number_generator_type = RandomNumberGeneratorType.values()[ord];} catch (ArrayIndexOutOfBoundsException e) {ThrowEnumException(ord, RandomNumberGeneratorType.values());}}
+    public SamplerType getSamplerType() { return _sampler_type; }
+    public void setSamplerType(int ord){try {_sampler_type = SamplerType.values()[ord];} catch (ArrayIndexOutOfBoundsException e) {ThrowEnumException(ord, SamplerType.values());}}
     public boolean getRelaxedStudyDataPeriodChecking() { return _relaxed_study_data_period_checking; }
     public void setRelaxedStudyDataPeriodChecking(boolean b) { _relaxed_study_data_period_checking = b; }
     public boolean getDataOnlyOnLeaves() { return _data_only_on_leaves; }
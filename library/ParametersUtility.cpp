@@ -567,6 +567,12 @@ jobject& ParametersUtility::copyCParametersToJParameters(JNIEnv& Env, Parameters
   mid = _getMethodId_Checked(Env, clazz, "setEarlyTermThreshold", "(I)V");
   Env.CallVoidMethod(jParameters, mid, (jint)parameters.getEarlyTermThreshold());
   jni_error::_detectError(Env);
+  mid = _getMethodId_Checked(Env, clazz, "setRandomNumberGeneratorType", "(I)V");
+  Env.CallVoidMethod(jParameters, mid, (jint)parameters.getRandomNumberGeneratorType());
+  jni_error::_detectError(Env);
+  mid = _getMethodId_Checked(Env, clazz, "setSamplerType", "(I)V");
+  Env.CallVoidMethod(jParameters, mid, (jint)parameters.getSamplerType());
+  jni_error::_detectError(Env);
 
   mid = _getMethodId_Checked(Env, clazz, "setRptDataAsPct", "(Z)V");
   Env.CallVoidMethod(jParameters, mid, (jboolean)parameters.getRptDataAsPct());
@@ -1049,6 +1055,8 @@ Parameters& ParametersUtility::copyJParametersToCParameters(JNIEnv& Env, jobject
   mid = _getMethodId_Checked(Env, clazz, "getEarlyTermThreshold", "()I");
   parameters.setEarlyTermThreshold(static_cast<unsigned int>(Env.CallIntMethod(jParameters, mid)));
   jni_error::_detectError(Env);
+  parameters.setRandomNumberGeneratorType((Parameters::RandomNumberGeneratorType)getEnumTypeOrdinalIndex(Env, jParameters, "getRandomNumberGeneratorType", "Lorg/treescan/app/Parameters$RandomNumberGeneratorType;"));
+  parameters.setSamplerType((Parameters::SamplerType)getEnumTypeOrdinalIndex(Env, jParameters, "getSamplerType", "Lorg/treescan/app/Parameters$SamplerType;"));
 
   mid = _getMethodId_Checked(Env, clazz, "getRptDataAsPct", "()Z");
   parameters.setRptDataAsPct(static_cast<bool>(Env.CallBooleanMethod(jParameters, mid)));
@@ -64,7 +64,9 @@ public:
         return read(filename, simulation, treeNodes, treeSimNodes, mutex);
     }
     void invoke_write(const std::string& filename, const SimNodeContainer_t& treeSimNodes) {
-        write(filename, treeSimNodes);
+        setWriting(filename);
+        write(1, treeSimNodes);
+        closeWriting();
     }
 };
 
@@ -0,0 +1,50 @@
+// Boost unit test header
+#include <boost/test/unit_test.hpp>
+#include "AsynchronousOrderedWriter.h"
+#include "PrjException.h"
+#include <sstream>
+
+/** Test Suite for the AsynchronousOrderedWriter class. */
+BOOST_AUTO_TEST_SUITE( test_asynchronous_ordered_writer_suite )
+
+/* Records submitted out of order, from several threads, are written in sequence order. */
+BOOST_AUTO_TEST_CASE( test_ordered_writes ) {
+    std::stringstream stream;
+    AsynchronousOrderedWriter writer(stream, "stream", 1, 4);
+    boost::thread_group threads;
+    for (unsigned int t=0; t < 4; ++t) {
+        threads.create_thread([&writer, t]() {
+            for (unsigned int s=1000 - t; s > 0 && s <= 1000; s -= 4) {
+                std::string record;
+                AsynchronousOrderedWriter::append(record, static_cast<int>(s)).append(" ");
+                writer.write(s, std::move(record));
+            }
+        });
+    }
+    threads.join_all();
+    writer.close();
+
+    unsigned int value, expected=1;
+    while (stream >> value) BOOST_CHECK_EQUAL( value, expected++ );
+    BOOST_CHECK_EQUAL( expected, 1001 );
+    BOOST_CHECK_THROW( writer.write(1001, std::string("x")), prg_error );
+}
+
+/* Values are formatted as a default std::ostream would. */
+BOOST_AUTO_TEST_CASE( test_append ) {
+    const double reals[] = {0.0, -1.25, 3.0, 1.0 / 3.0, 12345678.9, 1e-7};
+    const int integers[] = {0, -7, 2147483647};
+    std::stringstream stream;
+    std::string s;
+    for (double v : reals) {
+        stream << v << " ";
+        AsynchronousOrderedWriter::append(s, v).append(" ");
+    }
+    for (int v : integers) {
+        stream << v << " ";
+        AsynchronousOrderedWriter::append(s, v).append(" ");
+    }
+    BOOST_CHECK_EQUAL( s, stream.str() );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
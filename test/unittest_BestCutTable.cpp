@@ -0,0 +1,68 @@
+// Boost unit test header
+#include <boost/test/unit_test.hpp>
+#include "ScanRunner.h"
+
+/** Test Suite for the BestCutTable class. */
+BOOST_AUTO_TEST_SUITE( test_best_cut_table_suite )
+
+/* Each node keeps its first cut unless a later cut is better -- a replacing cut losing the children of the cut replaced -- and the
+   cuts are released by descending node index. */
+BOOST_AUTO_TEST_CASE( test_best_cut_by_node ) {
+    Parameters parameters;
+    BestCutTable table(4, parameters);
+    CutStructure * cut = table.update(2, 0, -1.0);
+    BOOST_REQUIRE( cut );
+    cut->setID(2);
+    cut->addCutChild(5);
+    BOOST_CHECK( table.update(2, 0, -1.0) == 0 );
+    BOOST_CHECK( table.update(2, 0, -2.0) == 0 );
+    BOOST_CHECK( table.update(2, 0, 3.0) == cut );
+    BOOST_CHECK( cut->getCutChildren().empty() );
+    BOOST_CHECK_EQUAL( cut->getLogLikelihood(), 3.0 );
+    table.update(0, 0, 1.0)->setID(0);
+    table.update(3, 0, 2.0)->setID(3);
+
+    ptr_vector<CutStructure> cuts;
+    table.release(cuts);
+    BOOST_REQUIRE_EQUAL( cuts.size(), 3U );
+    BOOST_CHECK_EQUAL( cuts[0]->getID(), 3 );
+    BOOST_CHECK_EQUAL( cuts[1]->getID(), 2 );
+    BOOST_CHECK_EQUAL( cuts[2]->getID(), 0 );
+}
+
+/* Signed rank cuts of the low rate compare by lower log likelihood, those of both rates by absolute log likelihood. */
+BOOST_AUTO_TEST_CASE( test_best_cut_signed_rank ) {
+    Parameters parameters;
+    parameters.setModelType(Parameters::SIGNED_RANK);
+    parameters.setScanRateType(Parameters::LOWRATE);
+    BestCutTable low(1, parameters);
+    low.update(0, 0, -2.0);
+    BOOST_CHECK( low.update(0, 0, -1.0) == 0 );
+    BOOST_CHECK( low.update(0, 0, -3.0) != 0 );
+
+    parameters.setScanRateType(Parameters::HIGHORLOWRATE);
+    BestCutTable both(1, parameters);
+    both.update(0, 0, 2.0);
+    BOOST_CHECK( both.update(0, 0, -1.0) == 0 );
+    BOOST_CHECK( both.update(0, 0, -3.0) != 0 );
+}
+
+/* Time-only scans keep the best cut of each window end index, released by ascending end index. */
+BOOST_AUTO_TEST_CASE( test_best_cut_by_end_index ) {
+    Parameters parameters;
+    parameters.setScanType(Parameters::TIMEONLY);
+    BestCutTable table(1, parameters);
+    table.update(0, 7, 1.0)->setEndIdx(7);
+    table.update(0, 2, 1.0)->setEndIdx(2);
+    BOOST_CHECK( table.update(0, 7, 0.5) == 0 );
+    BOOST_CHECK( table.update(0, 7, 1.5) != 0 );
+
+    ptr_vector<CutStructure> cuts;
+    table.release(cuts);
+    BOOST_REQUIRE_EQUAL( cuts.size(), 2U );
+    BOOST_CHECK_EQUAL( cuts[0]->getEndIdx(), 2 );
+    BOOST_CHECK_EQUAL( cuts[1]->getEndIdx(), 7 );
+    BOOST_CHECK_EQUAL( cuts[1]->getLogLikelihood(), 1.5 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,71 @@
+// Boost unit test header
+#include <boost/test/unit_test.hpp>
+#include "ScanRunner.h"
+
+/* Creates tree nodes from (child, parent) index pairs -- node data is a single interval. */
+static void buildNodes(ptr_vector<NodeStructure>& nodes, size_t num_nodes, const std::vector<std::pair<size_t, size_t> >& edges) {
+    Parameters parameters;
+    for (size_t i=0; i < num_nodes; ++i) {
+        nodes.push_back(new NodeStructure(std::to_string(i), parameters, 1));
+        nodes.back()->setID(static_cast<int>(i));
+    }
+    for (const auto& edge: edges)
+        nodes[edge.first]->addAsParent(*nodes[edge.second], "");
+}
+
+/* Applies the aggregation steps to the nodes' own values, returning the branch totals. */
+static std::vector<int> aggregate(const BranchAggregation& aggregation, const std::vector<int>& own) {
+    std::vector<int> branch(own.size(), -1);
+    for (const auto& step: aggregation.getSteps()) {
+        if (step._from_children) {
+            branch[step._node] = own[step._node];
+            for (size_t s=step._begin; s < step._end; ++s) {
+                BOOST_REQUIRE( branch[aggregation.getSources()[s]] >= 0 ); // child branch must precede its parent
+                branch[step._node] += branch[aggregation.getSources()[s]];
+            }
+        } else {
+            branch[step._node] = 0;
+            for (size_t s=step._begin; s < step._end; ++s)
+                branch[step._node] += own[aggregation.getSources()[s]];
+        }
+    }
+    return branch;
+}
+
+/** Test Suite for the BranchAggregation class. */
+BOOST_AUTO_TEST_SUITE( test_branch_aggregation_suite )
+
+BOOST_AUTO_TEST_CASE( test_tree_sums_children ) {
+    // 0 -> {1, 2}, 1 -> {3, 4}
+    ptr_vector<NodeStructure> nodes;
+    buildNodes(nodes, 5, {{1, 0}, {2, 0}, {3, 1}, {4, 1}});
+    BranchAggregation aggregation(nodes);
+    BOOST_CHECK_EQUAL( aggregation.getSteps().size(), 5 );
+    for (const auto& step: aggregation.getSteps())
+        BOOST_CHECK( step._from_children );
+    BOOST_CHECK_EQUAL( aggregation.getSteps().back()._node, 0 );
+    std::vector<int> branch = aggregate(aggregation, {1, 2, 4, 8, 16});
+    BOOST_CHECK_EQUAL( branch[0], 31 );
+    BOOST_CHECK_EQUAL( branch[1], 26 );
+    BOOST_CHECK_EQUAL( branch[2], 4 );
+    BOOST_CHECK_EQUAL( branch[3], 8 );
+}
+
+BOOST_AUTO_TEST_CASE( test_multiple_parents_counted_once ) {
+    // 0 -> {1, 2}, 1 -> {3}, 2 -> {3}, 3 -> {4}, 5 -> {3}
+    ptr_vector<NodeStructure> nodes;
+    buildNodes(nodes, 6, {{1, 0}, {2, 0}, {3, 1}, {3, 2}, {4, 3}, {3, 5}});
+    BranchAggregation aggregation(nodes);
+    BOOST_CHECK_EQUAL( aggregation.getSteps().size(), 6 );
+    for (const auto& step: aggregation.getSteps())
+        // only the root reaches node 3 along more than one path
+        BOOST_CHECK_EQUAL( step._from_children, step._node != 0 );
+    std::vector<int> branch = aggregate(aggregation, {1, 2, 4, 8, 16, 32});
+    BOOST_CHECK_EQUAL( branch[0], 31 );
+    BOOST_CHECK_EQUAL( branch[1], 26 );
+    BOOST_CHECK_EQUAL( branch[2], 28 );
+    BOOST_CHECK_EQUAL( branch[3], 24 );
+    BOOST_CHECK_EQUAL( branch[5], 56 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,67 @@
+// Boost unit test header
+#include <boost/test/unit_test.hpp>
+#include "contractor.h"
+
+/* Job source which records the order of registered results and can stop after a number of results. */
+class RecordingJobSource {
+public:
+    typedef unsigned int param_type;
+    typedef unsigned int result_type;
+    typedef unsigned long job_id_type;
+
+    unsigned int _job_count;
+    unsigned int _stop_after;
+    unsigned int _next_job;
+    std::vector<unsigned int> _registered;
+
+    RecordingJobSource(unsigned int job_count, unsigned int stop_after) : _job_count(job_count), _stop_after(stop_after), _next_job(1) {}
+
+    bool is_exhausted() const { return _next_job > _job_count || _registered.size() >= _stop_after; }
+    void acquire(job_id_type & job_id, param_type & param) {
+        if (is_exhausted()) throw std::runtime_error("can't acquire a job from an exhausted source.");
+        param = _next_job++;
+        job_id = param;
+    }
+    void register_result(job_id_type const & job_id, param_type const & param, result_type const & result) {
+        BOOST_CHECK_EQUAL( result, param * 2 );
+        _registered.push_back(param);
+    }
+};
+
+struct DoubleJob {
+    void operator()(unsigned int first, unsigned int last, std::vector<std::pair<unsigned int, unsigned int> >& results) {
+        for (unsigned int param=first; param < last; ++param)
+            results.push_back(std::make_pair(param, param * 2));
+    }
+};
+
+static void runJobs(RecordingJobSource& source, unsigned int num_threads) {
+    typedef chunked_contractor<RecordingJobSource> contractor_type;
+    contractor_type theContractor(source, source._job_count, num_threads);
+    boost::thread_group tg;
+    for (unsigned int t=0; t < num_threads; ++t)
+        tg.create_thread(chunked_subcontractor<contractor_type, DoubleJob>(theContractor, DoubleJob()));
+    tg.join_all();
+    theContractor.throw_unhandled_exception();
+}
+
+/** Test Suite for the chunked_contractor class. */
+BOOST_AUTO_TEST_SUITE( test_chunked_contractor_suite )
+
+BOOST_AUTO_TEST_CASE( test_results_registered_in_order ) {
+    RecordingJobSource source(1000, 1000);
+    runJobs(source, 8);
+    BOOST_REQUIRE_EQUAL( source._registered.size(), 1000 );
+    for (unsigned int i=0; i < source._registered.size(); ++i)
+        BOOST_CHECK_EQUAL( source._registered[i], i + 1 );
+}
+
+BOOST_AUTO_TEST_CASE( test_stops_when_source_exhausted ) {
+    RecordingJobSource source(1000, 37);
+    runJobs(source, 4);
+    BOOST_REQUIRE_EQUAL( source._registered.size(), 37 );
+    for (unsigned int i=0; i < source._registered.size(); ++i)
+        BOOST_CHECK_EQUAL( source._registered[i], i + 1 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,64 @@
+// Boost unit test header
+#include <boost/test/unit_test.hpp>
+#include "ScanRunner.h"
+
+/** Test Suite for the CutPlan class. */
+BOOST_AUTO_TEST_SUITE( test_cut_plan_suite )
+
+/* Creates a parent node with four children, child c having branch expected 1, 2, 4 and 8. */
+static void createTree(ptr_vector<NodeStructure>& nodes, const Parameters& parameters, Parameters::CutType cut_type) {
+    for (int n=0; n < 5; ++n) {
+        nodes.push_back(new NodeStructure(n ? "child" : "parent", parameters, 1));
+        nodes.back()->setID(n);
+        nodes.back()->refBrN_C().front() = n ? static_cast<double>(1 << (n - 1)) : 15.0;
+        if (n) nodes.back()->addAsParent(*nodes.front(), "");
+    }
+    nodes.front()->setCutType(cut_type);
+}
+
+/* Returns the children of each cut of the parent, as the scans report them. */
+static std::vector<std::vector<int> > getCutChildren(const CutPlan& plan) {
+    std::vector<std::vector<int> > cuts;
+    std::vector<int> children;
+    const CutPlan::Node& parent(plan.getNodes().front());
+    for (size_t c=parent._begin + 1; c < parent._end; ++c) {
+        if (!plan.getCuts()[c]._extends) children.clear();
+        plan.getCuts()[c].addChildren(children);
+        cuts.push_back(children);
+    }
+    return cuts;
+}
+
+BOOST_AUTO_TEST_CASE( test_ordinal_cuts ) {
+    Parameters parameters;
+    ptr_vector<NodeStructure> nodes;
+    createTree(nodes, parameters, Parameters::ORDINAL);
+    CutPlan plan(nodes, parameters);
+    // every node is evaluated, each child with only its branch
+    BOOST_REQUIRE_EQUAL( plan.getNodes().size(), 5U );
+    BOOST_CHECK_EQUAL( plan.getNodes()[1]._end - plan.getNodes()[1]._begin, 1U );
+    // Ordinal cuts: ABCD -> AB, ABC, ABCD, BC, BCD, CD
+    std::vector<std::vector<int> > expected = {{1,2}, {1,2,3}, {1,2,3,4}, {2,3}, {2,3,4}, {3,4}};
+    BOOST_CHECK( getCutChildren(plan) == expected );
+    const double BrN[] = {15.0, 3.0, 7.0, 15.0, 6.0, 14.0, 12.0};
+    for (size_t c=0; c < 7; ++c)
+        BOOST_CHECK_EQUAL( plan.getCuts()[c]._BrN, BrN[c] );
+}
+
+BOOST_AUTO_TEST_CASE( test_triplet_cuts ) {
+    Parameters parameters;
+    ptr_vector<NodeStructure> nodes;
+    createTree(nodes, parameters, Parameters::TRIPLETS);
+    nodes[3]->setIsEvaluated(false);
+    CutPlan plan(nodes, parameters);
+    // nodes not evaluated have no cuts, but remain in the cuts of their parents
+    BOOST_CHECK_EQUAL( plan.getNodes().size(), 4U );
+    // Triple cuts: ABCD -> AB, AC, ABC, AD, ABD, ACD, BC, BD, BCD, CD
+    std::vector<std::vector<int> > expected = {{1,2}, {1,3}, {1,2,3}, {1,4}, {1,2,4}, {1,3,4}, {2,3}, {2,4}, {2,3,4}, {3,4}};
+    BOOST_CHECK( getCutChildren(plan) == expected );
+    const CutPlan::Cut& triplet(plan.getCuts()[3]);
+    BOOST_CHECK_EQUAL( triplet._size, 3U );
+    BOOST_CHECK_EQUAL( triplet._BrN, 7.0 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,93 @@
+// Boost unit test header
+#include <boost/test/unit_test.hpp>
+#include "DataSource.h"
+#include "PrjException.h"
+#include "UtilityFunctions.h"
+#include <filesystem>
+#include <fstream>
+
+/* Creates a temporary filename, removing the file when the fixture is destroyed. */
+struct data_source_fixture {
+    std::string _filename;
+
+    data_source_fixture() { GetTemporaryFilename(_filename); }
+    ~data_source_fixture() {
+        std::error_code ec;
+        std::filesystem::remove(_filename, ec);
+    }
+    void write(const std::string& contents) {
+        std::ofstream stream(_filename.c_str(), std::ios_base::trunc | std::ios_base::binary);
+        stream << contents;
+    }
+};
+
+/* Checks that both data sources read the same records -- values, record indexes and blank record flags -- from the start and again after
+   returning to the first record. */
+static void checkSameRecords(DataSource& expected, DataSource& mapped) {
+    for (int pass=0; pass < 2; ++pass) {
+        bool more;
+        do {
+            more = expected.readRecord();
+            BOOST_REQUIRE_EQUAL( mapped.readRecord(), more );
+            BOOST_CHECK_EQUAL( mapped.getCurrentRecordIndex(), expected.getCurrentRecordIndex() );
+            BOOST_CHECK_EQUAL( mapped.detectBlankRecordFlag(), expected.detectBlankRecordFlag() );
+            BOOST_REQUIRE_EQUAL( mapped.getNumValues(), expected.getNumValues() );
+            for (long v=0; v < static_cast<long>(expected.getNumValues()) + 1; ++v)
+                BOOST_CHECK_EQUAL( mapped.getValueAt(v), expected.getValueAt(v) );
+        } while (more);
+        expected.gotoFirstRecord();
+        mapped.gotoFirstRecord();
+    }
+}
+
+/** Test Suite for the MappedCSVFileDataSource and ChunkedCSVFileDataSource classes. */
+BOOST_FIXTURE_TEST_SUITE( test_mapped_csv_data_source_suite, data_source_fixture )
+
+/* Records are read as CSVFileDataSource reads them, whether the file is parsed in place or in chunks -- grouped and escaped values, trailing
+   delimiters, whitespace, blank lines, each style of end of line, the escape sequence substituted while parsing and a last line without an
+   end of line -- for each delimiter and grouping. */
+BOOST_AUTO_TEST_CASE( test_same_records ) {
+    const std::string contents =
+        "header one,header two\r\n"
+        "node1,5, 2021/1/1 ,\"quoted, value\"\r\n"
+        "\r\n"
+        "  ,  \n"
+        "\"a \"\"quoted\"\" word\",\"\"\"\",\"open group,never closed\n"
+        "node2;7;\"x;y\"\r"
+        "node3\t 9 \t\t\"tab\tgrouped\"   with  spaces\r\n"
+        "'single ''grouped'' ','b'\n"
+        "node4,\xfe\xe6,\"\xfe\xe6\"\n"
+        "node5 a long line of more than sixteen characters,with several values,which,are,searched,a word at a time,\n"
+        "last,line";
+    write(contents);
+    const char * delimiters[] = {",", ";", " ", ""};
+    const char * groupers[] = {"\"", "'", "", "\"'"};
+    for (auto delimiter: delimiters) {
+        for (auto grouper: groupers) {
+            for (unsigned long skip=0; skip < 3; ++skip) {
+                CSVFileDataSource expected(_filename, delimiter, grouper, skip, skip == 1);
+                MappedCSVFileDataSource mapped(_filename, delimiter, grouper, skip, skip == 1);
+                checkSameRecords(expected, mapped);
+                // chunks of a few bytes divide DOS end of lines, blank lines and grouped values
+                for (size_t chunkSize=1; chunkSize < 40; chunkSize += 6) {
+                    ChunkedCSVFileDataSource chunked(_filename, 3, delimiter, grouper, skip, skip == 1, chunkSize);
+                    checkSameRecords(expected, chunked);
+                }
+            }
+        }
+    }
+}
+
+/* An empty file has no records, a missing file can not be opened and a file with a byte-order mark is not read. */
+BOOST_AUTO_TEST_CASE( test_empty_missing_and_unicode ) {
+    write("");
+    MappedCSVFileDataSource empty(_filename);
+    BOOST_CHECK( !empty.readRecord() );
+    BOOST_CHECK_EQUAL( empty.getNumValues(), 0U );
+    write("\xef\xbb\xbfnode,1\n");
+    BOOST_CHECK_THROW( MappedCSVFileDataSource source(_filename), resolvable_error );
+    std::filesystem::remove(_filename);
+    BOOST_CHECK_THROW( MappedCSVFileDataSource source(_filename), resolvable_error );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
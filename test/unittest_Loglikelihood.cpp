@@ -2,6 +2,7 @@
 #include <boost/test/unit_test.hpp>
 
 #include "Loglikelihood.h"
+#include <cmath>
 
 /** Test Suite for the AbstractLoglikelihood class. */
 BOOST_AUTO_TEST_SUITE( test_abstract_loglikelihood )
@@ -106,6 +107,44 @@ BOOST_AUTO_TEST_CASE( test_get_newloglikelihood_timeonly_scan ) {
     parameters.setConditionalType(Parameters::NODEANDTIME);
     BOOST_REQUIRE_THROW(AbstractLoglikelihood::getNewLoglikelihood(parameters, 100, 100.0), prg_error);*/
 }
+/* Tests that the batch log likelihoods match those calculated one count at a time, for each tree-only model and rate of interest. */
+BOOST_AUTO_TEST_CASE( test_batch_loglikelihoods ) {
+    const Parameters::ScanRateType rates[] = {Parameters::HIGHRATE, Parameters::LOWRATE, Parameters::HIGHORLOWRATE};
+    const Parameters::ModelType models[] = {Parameters::POISSON, Parameters::BERNOULLI_TREE};
+    const Parameters::ConditionalType conditionals[] = {Parameters::UNCONDITIONAL, Parameters::TOTALCASES};
+    const int cases[] = {0, 1, 3, 7, 12, 20, 35, 60, 100};
+    const double measures[] = {0.5, 2.0, 3.0, 9.5, 12.0, 15.0, 30.0, 90.0, 100.0};
+    const size_t count = sizeof(cases)/sizeof(cases[0]);
+    for (auto rate : rates) for (auto model : models) for (auto conditional : conditionals) {
+        Parameters parameters;
+        parameters.setScanType(Parameters::TREEONLY);
+        parameters.setModelType(model);
+        parameters.setConditionalType(conditional);
+        parameters.setScanRateType(rate);
+        std::shared_ptr<AbstractLoglikelihood> loglikelihood(AbstractLoglikelihood::getNewLoglikelihood(parameters, 100, 200.0, false));
+        double batch[count], same_measure[count];
+        loglikelihood->LogLikelihoods(cases, measures, 1, count, batch);
+        loglikelihood->LogLikelihoods(cases, &measures[4], 0, count, same_measure);
+        for (size_t i=0; i < count; ++i) {
+            // counts outside a model's domain give NaN either way
+            double single = loglikelihood->LogLikelihood(cases[i], measures[i]), single_same_measure = loglikelihood->LogLikelihood(cases[i], measures[4]);
+            BOOST_CHECK( batch[i] == single || (std::isnan(batch[i]) && std::isnan(single)) );
+            BOOST_CHECK( same_measure[i] == single_same_measure || (std::isnan(same_measure[i]) && std::isnan(single_same_measure)) );
+        }
+    }
+}
+
+/* Tests that tabulated and calculated values of c*log(c) agree, including for counts outside the table. */
+BOOST_AUTO_TEST_CASE( test_c_log_c_table ) {
+    CLogCTable table(50), shared(50), untabulated(CLogCTable::MAXIMUM_TABULATED + 1);
+    BOOST_CHECK_EQUAL( table(0), 0.0 );
+    for (int c=1; c <= 60; ++c) {
+        BOOST_CHECK_EQUAL( table(c), c * log(static_cast<double>(c)) );
+        BOOST_CHECK_EQUAL( shared(c), table(c) );
+        BOOST_CHECK_EQUAL( untabulated(c), table(c) );
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 /** Test Suite for the PoissonLoglikelihood class. */
@@ -303,3 +342,18 @@ BOOST_AUTO_TEST_CASE(test_loglikelihoodratio) {
 }
 
 BOOST_AUTO_TEST_SUITE_END()
+
+/** Test Suite for the SignedRankLoglikelihood class. */
+BOOST_AUTO_TEST_SUITE( test_signed_rank_loglikelihood )
+
+/** Tests that the signed rank statistic -- with zero and tied differences -- is the same through the proxy and the array entry points. */
+BOOST_AUTO_TEST_CASE( test_loglikelihoodratio ) {
+    Parameters parameters;
+    std::vector<double> differences = {0.5, -2.0, 0.0, 2.0, -0.25, 3.0};
+    SignedRankLoglikelihood l(parameters, static_cast<unsigned int>(differences.size()));
+    // ranks: 0.0 -> 1 (no rank), -0.25 -> 2, 0.5 -> 3, -2.0 and 2.0 -> 4.5, 3.0 -> 6
+    BOOST_CHECK_EQUAL(l.LogLikelihoodRatio(SampleSiteVectorDifferenceProxy(differences)), -2.0 + 3.0 - 4.5 + 4.5 + 6.0);
+    BOOST_CHECK_EQUAL(l.LogLikelihoodRatio(differences.data(), differences.size()), -2.0 + 3.0 - 4.5 + 4.5 + 6.0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
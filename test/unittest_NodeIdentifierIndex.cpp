@@ -0,0 +1,26 @@
+// Boost unit test header
+#include <boost/test/unit_test.hpp>
+#include "ScanRunner.h"
+
+/** Test Suite for the NodeIdentifierIndex class. */
+BOOST_AUTO_TEST_SUITE( test_node_identifier_index_suite )
+
+/* Each identifier is found at the position of its node -- with enough nodes that probe sequences collide -- and other identifiers are
+   not found, even before the index is built. */
+BOOST_AUTO_TEST_CASE( test_find_identifiers ) {
+    ptr_vector<NodeStructure> nodes;
+    NodeIdentifierIndex index;
+    BOOST_CHECK( !index.find(nodes, "A").first );
+    for (size_t i=0; i < 1000; ++i)
+        nodes.push_back(new NodeStructure("Node" + std::to_string(i * 7)));
+    index.build(nodes);
+    for (size_t i=0; i < nodes.size(); ++i) {
+        std::pair<bool,size_t> found = index.find(nodes, "Node" + std::to_string(i * 7));
+        BOOST_CHECK( found.first );
+        BOOST_CHECK_EQUAL( found.second, i );
+        BOOST_CHECK( !index.find(nodes, "Node" + std::to_string(i * 7 + 1)).first );
+    }
+    BOOST_CHECK( !index.find(nodes, "").first );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
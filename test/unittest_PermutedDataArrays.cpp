@@ -0,0 +1,64 @@
+// Boost unit test header
+#include <boost/test/unit_test.hpp>
+#include "PermutationDataRandomizer.h"
+
+/** Test Suite for the PermutedDataArrays class. */
+BOOST_AUTO_TEST_SUITE( test_permuted_data_arrays_suite )
+
+/* Adds groups of pairs to 'arrays' and 'collections' -- group g holding permuted attributes g * 1000 + i. */
+static void addGroups(PermutedDataArrays<int, int>& arrays, std::vector<std::vector<PermutedAttribute<int> > >& collections) {
+    const size_t sizes[] = {50, 0, 1, 213};
+    for (size_t g=0; g < 4; ++g) {
+        collections.push_back(std::vector<PermutedAttribute<int> >());
+        for (size_t i=0; i < sizes[g]; ++i) {
+            arrays.add(static_cast<int>(i), static_cast<int>(g * 1000 + i));
+            collections.back().push_back(PermutedAttribute<int>(static_cast<int>(g * 1000 + i)));
+        }
+        arrays.endGroup();
+    }
+}
+
+/* In seed compatible mode, the permutation is that of sorting the PermutedAttribute objects on random floats. */
+BOOST_AUTO_TEST_CASE( test_seed_compatible ) {
+    PermutedDataArrays<int, int> arrays(true);
+    std::vector<std::vector<PermutedAttribute<int> > > collections;
+    addGroups(arrays, collections);
+    RandomNumberGenerator rng, rng_sort;
+    for (unsigned int replica=0; replica < 3; ++replica) {
+        arrays.permute(rng);
+        std::vector<int> expected;
+        for (auto collection : collections) {
+            std::for_each(collection.begin(), collection.end(), AssignPermutedAttribute<PermutedAttribute<int> >(rng_sort));
+            std::sort(collection.begin(), collection.end(), ComparePermutedAttribute<PermutedAttribute<int> >());
+            for (const auto& attribute : collection) expected.push_back(attribute.GetPermutedVariable());
+        }
+        BOOST_REQUIRE_EQUAL( expected.size(), arrays.size() );
+        BOOST_CHECK( std::equal(expected.begin(), expected.end(), arrays.getPermuted()) );
+    }
+}
+
+/* The shuffle permutes attributes within each group, moving an attribute to each position of its group equally often. */
+BOOST_AUTO_TEST_CASE( test_shuffle ) {
+    PermutedDataArrays<int, int> arrays(false);
+    std::vector<std::vector<PermutedAttribute<int> > > collections;
+    addGroups(arrays, collections);
+    RandomNumberGenerator rng;
+    const unsigned int replicas = 5000;
+    std::vector<unsigned int> position(50, 0); // replicas in which attribute 0 is at each position of the first group
+    for (unsigned int replica=0; replica < replicas; ++replica) {
+        arrays.permute(rng);
+        std::vector<int> permuted(arrays.getPermuted(), arrays.getPermuted() + arrays.size());
+        ++position[std::find(permuted.begin(), permuted.end(), 0) - permuted.begin()];
+        size_t begin = 0;
+        for (const auto& collection : collections) {
+            std::sort(permuted.begin() + begin, permuted.begin() + begin + collection.size());
+            for (size_t i=0; i < collection.size(); ++i)
+                BOOST_REQUIRE_EQUAL( permuted[begin + i], collection[i].GetPermutedVariable() );
+            begin += collection.size();
+        }
+    }
+    for (size_t i=0; i < position.size(); ++i)
+        BOOST_CHECK_CLOSE( static_cast<double>(position[i]), replicas / 50.0, 40.0 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
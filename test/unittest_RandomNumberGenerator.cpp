@@ -0,0 +1,86 @@
+// Boost unit test header
+#include <boost/test/unit_test.hpp>
+#include "RandomNumberGenerator.h"
+#include "PrjException.h"
+
+/** Test Suite for the RandomNumberGenerator class. */
+BOOST_AUTO_TEST_SUITE( test_random_number_generator_suite )
+
+BOOST_AUTO_TEST_CASE( test_lehmer_implementation ) {
+    RandomNumberGenerator rng;
+    BOOST_CHECK_EQUAL( rng.Test(), 1 );
+}
+
+/* Known answers of the Philox4x32-10 reference implementation. */
+BOOST_AUTO_TEST_CASE( test_philox_known_answers ) {
+    uint32_t result[4];
+    const uint32_t zero_counter[4] = {0, 0, 0, 0}, zero_key[2] = {0, 0};
+    RandomNumberGenerator::Philox(zero_counter, zero_key, result);
+    BOOST_CHECK_EQUAL( result[0], 0x6627e8d5u );
+    BOOST_CHECK_EQUAL( result[1], 0xe169c58du );
+    BOOST_CHECK_EQUAL( result[2], 0xbc57ac4cu );
+    BOOST_CHECK_EQUAL( result[3], 0x9b00dbd8u );
+    const uint32_t max_counter[4] = {0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}, max_key[2] = {0xffffffff, 0xffffffff};
+    RandomNumberGenerator::Philox(max_counter, max_key, result);
+    BOOST_CHECK_EQUAL( result[0], 0x408f276du );
+    BOOST_CHECK_EQUAL( result[1], 0x41c83b0eu );
+    BOOST_CHECK_EQUAL( result[2], 0xa20bc7c6u );
+    BOOST_CHECK_EQUAL( result[3], 0x6d5451fdu );
+}
+
+BOOST_AUTO_TEST_CASE( test_bulk_generation_matches_single_calls ) {
+    RandomNumberGenerator::EngineType engines[] = {RandomNumberGenerator::LEHMER, RandomNumberGenerator::PHILOX};
+    for (auto engine : engines) {
+        RandomNumberGenerator single(RandomNumberGenerator::glDefaultSeed, engine), bulk(RandomNumberGenerator::glDefaultSeed, engine);
+        single.SetSeedOffset(3);
+        bulk.SetSeedOffset(3);
+        double values[37];
+        // start part way into a block, then request a run spanning several blocks
+        bulk.GetRandomDoubles(values, 3);
+        bulk.GetRandomDoubles(values + 3, 34);
+        for (size_t i=0; i < 37; ++i) {
+            BOOST_CHECK_EQUAL( single.GetRandomDouble(), values[i] );
+            BOOST_CHECK( 0.0 < values[i] && values[i] < 1.0 );
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_philox_replicas_and_streams_are_independent ) {
+    RandomNumberGenerator first(RandomNumberGenerator::glDefaultSeed, RandomNumberGenerator::PHILOX), second(RandomNumberGenerator::glDefaultSeed, RandomNumberGenerator::PHILOX);
+    // the numbers of replica 7, stream 2 do not depend on what was generated before
+    first.SetSeedOffset(6);
+    for (int i=0; i < 11; ++i) first.GetRandomDouble();
+    first.SetSeedOffset(7);
+    first.SetStream(2);
+    second.SetSeedOffset(7);
+    second.SetStream(1);
+    second.GetRandomDouble();
+    second.SetStream(2);
+    for (int i=0; i < 20; ++i)
+        BOOST_CHECK_EQUAL( first.GetRandomDouble(), second.GetRandomDouble() );
+    // different streams and replicas yield different numbers
+    first.SetStream(3);
+    second.SetSeedOffset(8);
+    second.SetStream(2);
+    RandomNumberGenerator third(RandomNumberGenerator::glDefaultSeed, RandomNumberGenerator::PHILOX);
+    third.SetSeedOffset(7);
+    third.SetStream(2);
+    double value = third.GetRandomDouble();
+    BOOST_CHECK( first.GetRandomDouble() != value );
+    BOOST_CHECK( second.GetRandomDouble() != value );
+}
+
+BOOST_AUTO_TEST_CASE( test_seed_offset_limits ) {
+    RandomNumberGenerator lehmer(RandomNumberGenerator::glM - 10), philox(RandomNumberGenerator::glM - 10, RandomNumberGenerator::PHILOX);
+    BOOST_CHECK_NO_THROW( lehmer.SetSeedOffset(5) );
+    BOOST_CHECK_THROW( lehmer.SetSeedOffset(20), prg_exception );
+    BOOST_CHECK_NO_THROW( philox.SetSeedOffset(20) );
+    // the Lehmer generator is unaffected by streams
+    lehmer.SetSeedOffset(5);
+    double value = lehmer.GetRandomDouble();
+    lehmer.SetSeedOffset(5);
+    lehmer.SetStream(4);
+    BOOST_CHECK_EQUAL( lehmer.GetRandomDouble(), value );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
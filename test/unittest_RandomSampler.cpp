@@ -0,0 +1,122 @@
+// Boost unit test header
+#include <boost/test/unit_test.hpp>
+#include "RandomSampler.h"
+#include <cmath>
+
+/* Checks that the sample mean and variance of variates are within a few standard errors of the expected moments. */
+static void checkMoments(const std::vector<long>& variates, double mean, double variance) {
+    double sum = 0.0, sum_squares = 0.0, count = static_cast<double>(variates.size());
+    for (long x : variates) {
+        sum += static_cast<double>(x);
+        sum_squares += static_cast<double>(x) * static_cast<double>(x);
+    }
+    double sample_mean = sum / count, sample_variance = (sum_squares - count * sample_mean * sample_mean) / (count - 1.0);
+    BOOST_CHECK_SMALL( sample_mean - mean, 5.0 * std::sqrt(variance / count) );
+    BOOST_CHECK_SMALL( sample_variance - variance, 0.05 * variance );
+}
+
+/** Test Suite for the PoissonSampler, BinomialSampler, HypergeometricSampler and MultinomialSampler classes. */
+BOOST_AUTO_TEST_SUITE( test_random_sampler_suite )
+
+BOOST_AUTO_TEST_CASE( test_poisson_moments ) {
+    const double lambdas[] = {0.2, 3.0, 9.99, 10.0, 50.0, 500.0};
+    RandomNumberGenerator rng(12345);
+    for (double lambda : lambdas) {
+        PoissonSampler sampler;
+        std::vector<long> variates;
+        for (int i=0; i < 100000; ++i) {
+            variates.push_back(sampler.sample(lambda, rng));
+            BOOST_REQUIRE( variates.back() >= 0 );
+        }
+        checkMoments(variates, lambda, lambda);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_binomial_moments ) {
+    const std::pair<long, double> distributions[] = {{1000, 0.3}, {30, 0.9}, {200, 0.02}, {50, 0.5}, {100000, 0.0001}, {400, 0.97}};
+    RandomNumberGenerator rng(12345);
+    for (auto const& distribution : distributions) {
+        BinomialSampler sampler;
+        std::vector<long> variates;
+        long n = distribution.first;
+        double p = distribution.second;
+        for (int i=0; i < 100000; ++i) {
+            variates.push_back(sampler.sample(n, p, rng));
+            BOOST_REQUIRE( variates.back() >= 0 && variates.back() <= n );
+        }
+        checkMoments(variates, static_cast<double>(n) * p, static_cast<double>(n) * p * (1.0 - p));
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_hypergeometric_moments ) {
+    // successes, failures, draws -- covering inversion and ratio of uniforms, and each symmetry
+    const long distributions[][3] = {{20, 80, 30}, {70, 30, 40}, {30, 70, 80}, {500, 2000, 1000}, {9000000, 1000000, 30000}, {5000, 9995000, 2000000}};
+    RandomNumberGenerator rng(12345);
+    HypergeometricSampler sampler;
+    for (auto const& distribution : distributions) {
+        long successes = distribution[0], failures = distribution[1], draws = distribution[2];
+        double population = static_cast<double>(successes + failures), p = static_cast<double>(successes) / population;
+        std::vector<long> variates;
+        for (int i=0; i < 100000; ++i) {
+            variates.push_back(sampler.sample(successes, failures, draws, rng));
+            BOOST_REQUIRE( variates.back() >= std::max(0L, draws - failures) && variates.back() <= std::min(draws, successes) );
+        }
+        checkMoments(variates, static_cast<double>(draws) * p, static_cast<double>(draws) * p * (1.0 - p) * (population - static_cast<double>(draws)) / (population - 1.0));
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_degenerate_parameters ) {
+    RandomNumberGenerator rng;
+    PoissonSampler poisson;
+    BinomialSampler binomial;
+    BOOST_CHECK_EQUAL( poisson.sample(0.0, rng), 0 );
+    BOOST_CHECK_EQUAL( binomial.sample(0, 0.5, rng), 0 );
+    BOOST_CHECK_EQUAL( binomial.sample(25, 0.0, rng), 0 );
+    BOOST_CHECK_EQUAL( binomial.sample(25, 1.0, rng), 25 );
+    HypergeometricSampler hypergeometric;
+    BOOST_CHECK_EQUAL( hypergeometric.sample(10, 20, 0, rng), 0 );
+    BOOST_CHECK_EQUAL( hypergeometric.sample(0, 20, 5, rng), 0 );
+    BOOST_CHECK_EQUAL( hypergeometric.sample(10, 0, 5, rng), 5 );
+    BOOST_CHECK_EQUAL( hypergeometric.sample(10, 20, 30, rng), 10 );
+}
+
+/* A sampler is set up again when its parameters change, so sharing one across distributions gives the same variates. */
+BOOST_AUTO_TEST_CASE( test_changing_parameters ) {
+    RandomNumberGenerator shared_rng, separate_rng;
+    BinomialSampler shared, first, second;
+    for (int i=0; i < 1000; ++i) {
+        BOOST_CHECK_EQUAL( shared.sample(500, 0.4, shared_rng), first.sample(500, 0.4, separate_rng) );
+        BOOST_CHECK_EQUAL( shared.sample(40, 0.1, shared_rng), second.sample(40, 0.1, separate_rng) );
+    }
+}
+
+/* Multinomial draws place all cases, each index drawing cases in proportion to its weight. */
+BOOST_AUTO_TEST_CASE( test_multinomial_counts ) {
+    const std::vector<double> cumulative = {0.0, 1.0, 1.0, 4.0, 4.5, 8.0, 8.0, 10.0}; // weights 1, 0, 3, 0.5, 3.5, 0, 2
+    const size_t size = cumulative.size() - 1;
+    RandomNumberGenerator rng(12345);
+    MultinomialSampler sampler;
+    std::vector<double> totals(size, 0.0), uniform_totals(size, 0.0);
+    const long n = 50;
+    const int draws = 20000;
+    for (int d=0; d < draws; ++d) {
+        long placed = 0;
+        sampler.sample(n, size, [&cumulative](size_t k) { return cumulative[k]; }, [&](size_t k, long cases) {
+            BOOST_REQUIRE( k < size && cases > 0 );
+            totals[k] += static_cast<double>(cases);
+            placed += cases;
+        }, rng);
+        BOOST_REQUIRE_EQUAL( placed, n );
+        placed = 0;
+        sampler.sampleUniform(n, size, [&](size_t k, long cases) { uniform_totals[k] += static_cast<double>(cases); placed += cases; }, rng);
+        BOOST_REQUIRE_EQUAL( placed, n );
+    }
+    for (size_t k=0; k < size; ++k) {
+        double p = (cumulative[k + 1] - cumulative[k]) / cumulative.back(), expected = static_cast<double>(n * draws) * p;
+        BOOST_CHECK_SMALL( totals[k] - expected, 5.0 * std::sqrt(expected * (1.0 - p)) + 1e-9 );
+        expected = static_cast<double>(n * draws) / static_cast<double>(size);
+        BOOST_CHECK_SMALL( uniform_totals[k] - expected, 5.0 * std::sqrt(expected) );
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
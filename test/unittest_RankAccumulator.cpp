@@ -0,0 +1,28 @@
+// Boost unit test header
+#include <boost/test/unit_test.hpp>
+#include "SimulationVariables.h"
+#include <limits>
+
+/** Test Suite for the RankAccumulator class. */
+BOOST_AUTO_TEST_SUITE( test_rank_accumulator_suite )
+
+/* The count for a log likelihood is that of the maxima at least the log likelihood, as when comparing each maximum in turn -- including
+   ties, maxima added after counting and maxima which are not a number. */
+BOOST_AUTO_TEST_CASE( test_count_at_least ) {
+    const double maxima[] = {2.5, 0.0, 7.25, 2.5, -1.0, std::numeric_limits<double>::quiet_NaN(), 3.0, 2.5, 11.0};
+    const double loglikelihoods[] = {-2.0, 0.0, 2.5, 2.75, 7.25, 12.0, std::numeric_limits<double>::quiet_NaN()};
+    RankAccumulator accumulator;
+    std::vector<double> added;
+    for (double maximum : maxima) {
+        accumulator.add(maximum);
+        added.push_back(maximum);
+        for (double loglikelihood : loglikelihoods) {
+            unsigned int expected = 0;
+            for (double m : added) if (m >= loglikelihood) ++expected;
+            BOOST_CHECK_EQUAL( accumulator.countAtLeast(loglikelihood), expected );
+        }
+    }
+    BOOST_CHECK_EQUAL( accumulator.size(), 8U );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,40 @@
+// Boost unit test header
+#include <boost/test/unit_test.hpp>
+#include "SignedRankCutScan.h"
+#include "Loglikelihood.h"
+#include "Parameters.h"
+
+/** Test Suite for the SignedRankCutScan class. */
+BOOST_AUTO_TEST_SUITE( test_signed_rank_cut_scan_suite )
+
+/* The statistic of each cut, for any sample site flips, is that of SignedRankLoglikelihood on the flipped differences -- including
+   zero and tied differences, and sample sites spanning several words. */
+BOOST_AUTO_TEST_CASE( test_flipped_statistics ) {
+    Parameters parameters;
+    const size_t sample_sites = 70;
+    std::vector<std::vector<double>> cuts(3, std::vector<double>(sample_sites));
+    for (size_t s=0; s < sample_sites; ++s) {
+        cuts[0][s] = (s % 3 ? 1.0 : -1.0) * (0.5 + static_cast<double>(s));
+        cuts[1][s] = (s % 4 == 0) ? 0.0 : (s % 2 ? 2.5 : -2.5);  // zeros and ties only
+        cuts[2][s] = (s % 5 == 0) ? -1.25 : 0.125 * static_cast<double>((s * 7) % 11);
+    }
+    SignedRankCutScan scan(sample_sites);
+    for (const auto& cut: cuts) scan.add(cut.data());
+    BOOST_REQUIRE_EQUAL( scan.size(), cuts.size() );
+
+    SignedRankLoglikelihood loglikelihood(parameters, sample_sites);
+    std::vector<SignedRankCutScan::word_t> words(scan.getNumWords());
+    boost::dynamic_bitset<> flips(sample_sites);
+    for (unsigned int replica=0; replica < 4; ++replica) {
+        for (size_t s=0; s < sample_sites; ++s)
+            flips.set(s, replica == 3 || (replica && (s * (replica + 3)) % 7 < 3));
+        scan.getFlips(flips, words.data());
+        for (size_t c=0; c < cuts.size(); ++c) {
+            std::vector<double> flipped(cuts[c]);
+            for (size_t s=0; s < sample_sites; ++s) if (flips.test(s)) flipped[s] *= -1;
+            BOOST_CHECK_EQUAL( scan.getLogLikelihoodRatio(c, words.data()), loglikelihood.LogLikelihoodRatio(SampleSiteVectorDifferenceProxy(flipped)) );
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
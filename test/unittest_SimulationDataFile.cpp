@@ -0,0 +1,81 @@
+// Boost unit test header
+#include <boost/test/unit_test.hpp>
+#include "SimulationDataFile.h"
+#include "PrjException.h"
+#include "UtilityFunctions.h"
+#include <filesystem>
+#include <fstream>
+
+/* Creates temporary filenames, removing the files when the fixture is destroyed. */
+struct simulation_data_file_fixture {
+    std::string _text, _binary;
+
+    simulation_data_file_fixture() {
+        GetTemporaryFilename(_text);
+        GetTemporaryFilename(_binary);
+    }
+    ~simulation_data_file_fixture() {
+        std::error_code ec;
+        std::filesystem::remove(_text, ec);
+        std::filesystem::remove(_binary, ec);
+    }
+};
+
+/** Test Suite for the SimulationDataFile, SimulationDataFileWriter and SimulationDataFileReader classes. */
+BOOST_FIXTURE_TEST_SUITE( test_simulation_data_file_suite, simulation_data_file_fixture )
+
+/* Records written are read back by simulation, in any order. */
+BOOST_AUTO_TEST_CASE( test_write_and_read ) {
+    SimulationDataFileWriter writer(_binary, 3, 2, SimulationDataFile::INTEGER);
+    for (std::int32_t s=0; s < 5; ++s) {
+        std::int32_t record[6] = {s, s + 1, s + 2, s + 3, s + 4, s + 5};
+        writer.write(record);
+    }
+    writer.close();
+
+    BOOST_CHECK( SimulationDataFile::isBinary(_binary) );
+    SimulationDataFileReader reader(_binary);
+    BOOST_CHECK_EQUAL( reader.getNumSimulations(), 5 );
+    for (unsigned int simulation=5; simulation > 0; --simulation) {
+        const std::int32_t * record = reader.getIntegers(simulation, 3, 2);
+        for (std::int32_t v=0; v < 6; ++v)
+            BOOST_CHECK_EQUAL( record[v], static_cast<std::int32_t>(simulation) - 1 + v );
+    }
+    BOOST_CHECK_THROW( reader.getIntegers(6, 3, 2), resolvable_error );
+    BOOST_CHECK_THROW( reader.getIntegers(1, 2, 3), resolvable_error );
+    BOOST_CHECK_THROW( reader.getReals(1, 3, 2), resolvable_error );
+}
+
+/* The converter reads the whitespace delimited text files of the randomizers, regardless of how values are split across lines. */
+BOOST_AUTO_TEST_CASE( test_convert_text ) {
+    std::ofstream text(_text.c_str());
+    text << "0.5 -1.25 " << std::endl << "2 3.75 " << std::endl << "-0.5 1.25 " << std::endl << "-2 -3.75 " << std::endl;
+    text.close();
+    BOOST_CHECK( !SimulationDataFile::isBinary(_text) );
+    BOOST_CHECK_EQUAL( SimulationDataFile::convert(_text, _binary, 2, 2, SimulationDataFile::REAL), 2 );
+
+    SimulationDataFileReader reader(_binary);
+    BOOST_REQUIRE_EQUAL( reader.getNumSimulations(), 2 );
+    const double expected[] = {0.5, -1.25, 2.0, 3.75, -0.5, 1.25, -2.0, -3.75};
+    for (unsigned int simulation=1; simulation <= 2; ++simulation) {
+        const double * record = reader.getReals(simulation, 2, 2);
+        for (size_t v=0; v < 4; ++v)
+            BOOST_CHECK_EQUAL( record[v], expected[(simulation - 1) * 4 + v] );
+    }
+}
+
+/* Incomplete or invalid text data is reported. */
+BOOST_AUTO_TEST_CASE( test_convert_invalid_text ) {
+    std::ofstream text(_text.c_str());
+    text << "1 2 3 " << std::endl << "4 5 " << std::endl;
+    text.close();
+    BOOST_CHECK_THROW( SimulationDataFile::convert(_text, _binary, 3, 1, SimulationDataFile::INTEGER), resolvable_error );
+
+    text.open(_text.c_str());
+    text << "1 2 x " << std::endl;
+    text.close();
+    BOOST_CHECK_THROW( SimulationDataFile::convert(_text, _binary, 3, 1, SimulationDataFile::INTEGER), resolvable_error );
+    BOOST_CHECK_THROW( SimulationDataFileReader reader(_text), resolvable_error );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
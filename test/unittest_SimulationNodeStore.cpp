@@ -0,0 +1,124 @@
+// Boost unit test header
+#include <boost/test/unit_test.hpp>
+#include "Randomization.h"
+
+/* Populates each node's interval counts with a value unique to the node and interval. */
+static void populate(SimulationNodeStore& store) {
+    for (size_t n=0; n < store.size(); ++n) {
+        SimulationNode::Counts_t counts = store[n].refIntC_C();
+        for (size_t t=0; t < counts.size(); ++t)
+            counts[t] = static_cast<int>(n * 100 + t);
+    }
+}
+
+/** Test Suite for the SimulationNodeStore class. */
+BOOST_AUTO_TEST_SUITE( test_simulation_node_store_suite )
+
+BOOST_AUTO_TEST_CASE( test_layouts_expose_same_node_data ) {
+    SimulationNodeStore node_major(SimulationNodeStore::NODE_MAJOR), time_major(SimulationNodeStore::TIME_MAJOR);
+    for (unsigned int n=0; n < 3; ++n) {
+        node_major.emplace_back(4, n + 1, 0);
+        time_major.emplace_back(4, n + 1, 0);
+        populate(node_major);
+        populate(time_major);
+    }
+    for (size_t n=0; n < 3; ++n) {
+        BOOST_CHECK_EQUAL( node_major[n].getLevel(), time_major[n].getLevel() );
+        for (size_t t=0; t < 4; ++t) {
+            BOOST_CHECK_EQUAL( node_major[n].getIntC_C()[t], static_cast<int>(n * 100 + t) );
+            BOOST_CHECK_EQUAL( time_major[n].getIntC_C()[t], static_cast<int>(n * 100 + t) );
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_set_cumulative ) {
+    SimulationNodeStore node_major(SimulationNodeStore::NODE_MAJOR), time_major(SimulationNodeStore::TIME_MAJOR);
+    for (unsigned int n=0; n < 2; ++n) {
+        node_major.emplace_back(3, 1, 0);
+        time_major.emplace_back(3, 1, 0);
+    }
+    populate(node_major);
+    populate(time_major);
+    node_major.setCumulative();
+    time_major.setCumulative();
+    // node 1 has counts 100, 101, 102
+    BOOST_CHECK_EQUAL( node_major[1].getIntC(), 303 );
+    BOOST_CHECK_EQUAL( node_major[1].getIntC_C()[1], 203 );
+    BOOST_CHECK_EQUAL( time_major[1].getIntC(), 303 );
+    BOOST_CHECK_EQUAL( time_major[1].getIntC_C()[1], 203 );
+    BOOST_CHECK_EQUAL( time_major[0].getIntC(), 3 );
+}
+
+BOOST_AUTO_TEST_CASE( test_reset_and_copy ) {
+    SimulationNodeStore store;
+    store.emplace_back(2, 1, 2);
+    store.emplace_back(2, 2, 2);
+    store[1].refBrC() = 5;
+    store[1].refSampleSiteDifferences() = { 1.5, -2.5 };
+
+    SimulationNodeStore copy(store);
+    store.reset();
+    BOOST_CHECK_EQUAL( store[1].getBrC(), 0 );
+    BOOST_CHECK_EQUAL( store[1].getSampleSiteDifferences()[1], 0.0 );
+    // the copy references its own data, not that of the store it was copied from
+    BOOST_CHECK_EQUAL( copy[1].getBrC(), 5 );
+    BOOST_CHECK_EQUAL( copy[1].getSampleSiteDifferences()[0], 1.5 );
+    BOOST_CHECK_EQUAL( copy[1].getSampleSiteDifferences()[1], -2.5 );
+    BOOST_CHECK_THROW( store.emplace_back(3, 1, 2), prg_exception );
+}
+
+/* Sparse nodes hold case times, yet report the same windows and totals as dense nodes given the same cases. */
+BOOST_AUTO_TEST_CASE( test_sparse_nodes_match_dense ) {
+    // 0 -> {1, 2}, 1 -> {3, 4}
+    Parameters parameters;
+    ptr_vector<NodeStructure> nodes;
+    const int intC[] = {10, 0, 1, 2, 1}, brC[] = {14, 3, 1, 2, 1};
+    for (size_t i=0; i < 5; ++i) {
+        nodes.push_back(new NodeStructure(std::to_string(i), parameters, 1));
+        nodes.back()->setID(static_cast<int>(i));
+        nodes.back()->refIntC_C()[0] = intC[i];
+        nodes.back()->refBrC_C()[0] = brC[i];
+    }
+    nodes[1]->addAsParent(*nodes[0], "");
+    nodes[2]->addAsParent(*nodes[0], "");
+    nodes[3]->addAsParent(*nodes[1], "");
+    nodes[4]->addAsParent(*nodes[1], "");
+    BranchAggregation aggregation(nodes);
+    SimulationNodeStore dense(nodes, 8, 0), sparse(nodes, 8, 0, SimulationNodeStore::NODE_MAJOR, 4);
+    BOOST_CHECK( !dense.hasSparseNodes() );
+    BOOST_CHECK( sparse.hasSparseNodes() );
+    BOOST_CHECK( !sparse[0].isSparse() );
+    for (size_t n=1; n < 5; ++n)
+        BOOST_CHECK( sparse[n].isSparse() );
+    const std::vector<std::pair<size_t, size_t> > cases = {{0, 0}, {0, 3}, {0, 3}, {0, 6}, {2, 5}, {3, 6}, {3, 1}, {4, 1}};
+    for (int replica=0; replica < 2; ++replica) { // second pass checks that reset clears the sparse series
+        dense.reset();
+        sparse.reset();
+        for (const auto& c : cases) {
+            dense[c.first].addIntC(c.second);
+            sparse[c.first].addIntC(c.second);
+        }
+        for (size_t t=0; t < 6; ++t) {
+            dense[0].addIntC(t);
+            sparse[0].addIntC(t);
+        }
+        dense.setCumulative();
+        sparse.setCumulative();
+        dense.aggregateSparse(aggregation);
+        sparse.aggregateSparse(aggregation);
+        for (size_t n=0; n < 5; ++n) {
+            BOOST_CHECK_EQUAL( sparse[n].getIntC(), dense[n].getIntC() );
+            BOOST_CHECK_EQUAL( sparse[n].getBrC(), brC[n] );
+            BOOST_CHECK_EQUAL( dense[n].getBrC(), brC[n] );
+            for (size_t start=0; start < 7; ++start)
+                for (size_t end=start; end < 7; ++end)
+                    BOOST_CHECK_EQUAL( sparse[n].getBrC_Window(start, end), dense[n].getBrC_Window(start, end) );
+        }
+    }
+    // a sparse node only has room for the cases of the node in the real data
+    sparse.reset();
+    sparse[4].addIntC(2);
+    BOOST_CHECK_THROW( sparse[4].addIntC(2), prg_exception );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,86 @@
+// Boost unit test header
+#include <boost/test/unit_test.hpp>
+#include "TemporalWindowScan.h"
+
+/* Log likelihood stub which favors windows with many cases over a short length. */
+class WindowTestLoglikelihood : public AbstractLoglikelihood {
+    public:
+        WindowTestLoglikelihood(const Parameters& parameters) : AbstractLoglikelihood(parameters) {}
+        virtual double LogLikelihood(int c, double n, size_t windowLength) const { return static_cast<double>(c) - static_cast<double>(windowLength) / n; }
+        virtual double LogLikelihoodRatio(double logLikelihood) const { return logLikelihood; }
+};
+
+/** Test Suite for the TemporalWindowScan class. */
+BOOST_AUTO_TEST_SUITE( test_temporal_window_scan_suite )
+
+/* The windows are enumerated in the order of the nested window end and window start loops of the temporal scans. */
+BOOST_AUTO_TEST_CASE( test_window_enumeration ) {
+    Parameters parameters;
+    WindowLength window(parameters, 2, 4);
+    DataTimeRange startWindow(1, 6), endWindow(3, 9);
+    TemporalWindowScan windows(startWindow, endWindow, window);
+
+    size_t w = 0;
+    int iWindowStart, iMinWindowStart, iMaxEndWindow = std::min(endWindow.getEnd(), startWindow.getEnd() + window.maximum());
+    for (int iWindowEnd=endWindow.getStart(); iWindowEnd <= iMaxEndWindow; ++iWindowEnd) {
+        window.windowstart(startWindow, iWindowEnd, iMinWindowStart, iWindowStart);
+        for (; iWindowStart >= iMinWindowStart; --iWindowStart, ++w) {
+            BOOST_REQUIRE( w < windows.size() );
+            BOOST_CHECK_EQUAL( windows.getStart(w), iWindowStart );
+            BOOST_CHECK_EQUAL( windows.getEnd(w), iWindowEnd );
+            BOOST_CHECK_EQUAL( windows.getLength(w), static_cast<size_t>(iWindowEnd - iWindowStart + 1) );
+        }
+    }
+    BOOST_CHECK_EQUAL( w, windows.size() );
+}
+
+/* Excluded time intervals are not counted in the window lengths. */
+BOOST_AUTO_TEST_CASE( test_window_lengths_with_exclusions ) {
+    Parameters parameters;
+    WindowLength window(parameters, 1, 8);
+    DataTimeRange range(0, 9);
+    boost::dynamic_bitset<> exclusions(10);
+    exclusions.set(2);
+    exclusions.set(5);
+    exclusions.set(6);
+    TemporalWindowScan windows(range, range, window, &exclusions);
+
+    BOOST_REQUIRE( windows.size() > 0 );
+    for (size_t w=0; w < windows.size(); ++w) {
+        size_t length = 0;
+        for (int t=windows.getStart(w); t <= windows.getEnd(w); ++t)
+            length += exclusions.test(t) ? 0 : 1;
+        BOOST_CHECK_EQUAL( windows.getLength(w), length );
+    }
+}
+
+/* The window counts and maximum log likelihood agree with summing and evaluating each window directly. */
+BOOST_AUTO_TEST_CASE( test_window_counts_and_maximum ) {
+    Parameters parameters;
+    WindowLength window(parameters, 1, 5);
+    DataTimeRange range(0, 11);
+    TemporalWindowScan windows(range, range, window);
+
+    const int cases[] = {0, 2, 1, 0, 5, 3, 0, 0, 1, 4, 0, 2};
+    std::vector<int> cumulative(13, 0);
+    for (int t=11; t >= 0; --t)
+        cumulative[t] = cumulative[t + 1] + cases[t];
+
+    std::vector<int> counts(windows.size());
+    windows.getCounts(cumulative.data(), counts.data());
+    WindowTestLoglikelihood calculator(parameters);
+    double n = static_cast<double>(cumulative[0]), expected = -std::numeric_limits<double>::max();
+    for (size_t w=0; w < windows.size(); ++w) {
+        int count = 0;
+        for (int t=windows.getStart(w); t <= windows.getEnd(w); ++t)
+            count += cases[t];
+        BOOST_CHECK_EQUAL( counts[w], count );
+        if (count >= 3)
+            expected = std::max(expected, calculator.LogLikelihood(count, n, windows.getLength(w)));
+    }
+    std::vector<double> loglikelihoods(windows.size());
+    BOOST_CHECK_EQUAL( windows.getMaximumLogLikelihood(counts.data(), n, 3, calculator, loglikelihoods.data()), expected );
+    BOOST_CHECK_EQUAL( windows.getMaximumLogLikelihood(counts.data(), n, 100, calculator, loglikelihoods.data()), -std::numeric_limits<double>::max() );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
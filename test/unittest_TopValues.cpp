@@ -0,0 +1,31 @@
+// Boost unit test header
+#include <boost/test/unit_test.hpp>
+#include "TopValues.h"
+#include <vector>
+#include <algorithm>
+#include <functional>
+
+/** Test Suite for the TopValues class. */
+BOOST_AUTO_TEST_SUITE( test_top_values_suite )
+
+/* The values kept are the best 'capacity' values added, as a sorted list replacing its last value keeps them -- including ties with
+   the worst value kept, which are not added. */
+BOOST_AUTO_TEST_CASE( test_best_values ) {
+    const double values[] = {3.0, 1.0, 4.0, 1.0, 5.0, 9.0, 2.0, 6.0, 5.0, 3.0, 5.0, 8.0, 9.0, 7.0, 9.0, 3.0, 2.0};
+    for (size_t capacity=1; capacity < 6; ++capacity) {
+        TopValues<double> top(capacity);
+        std::vector<double> sorted(capacity, 0.0);
+        while (!top.full()) top.add(0.0);
+        for (double value : values) {
+            std::vector<double>::iterator itr = std::upper_bound(sorted.begin(), sorted.end(), value, std::greater<double>());
+            bool added = itr != sorted.end();
+            if (added) { sorted.insert(itr, value); sorted.pop_back(); }
+            BOOST_CHECK_EQUAL( top.add(value), added );
+            BOOST_CHECK_EQUAL( top.worst(), sorted.back() );
+            BOOST_CHECK( top.getSorted() == sorted );
+        }
+        BOOST_CHECK_EQUAL( top.size(), capacity );
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()